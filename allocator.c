@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "allocator.h"
+
+static void* countingAllocate(size_t size, void* context);
+static void* countingReallocate(void* block, size_t old_size, size_t new_size, void* context);
+static void countingFree(void* block, size_t size, void* context);
+static bool reserveBytes(ChessCountingAllocator* counting, size_t size);
+static void releaseBytes(ChessCountingAllocator* counting, size_t size);
+
+
+void* allocatorAllocate(const ChessAllocator* allocator, size_t size)
+{
+    return allocator == NULL ? malloc(size) : allocator->allocate(size, allocator->context);
+}
+
+void* allocatorReallocate(const ChessAllocator* allocator, void* block, size_t old_size, size_t new_size)
+{
+    if (allocator == NULL) {
+        return realloc(block, new_size);
+    }
+    if (block == NULL) {
+        return allocator->allocate(new_size, allocator->context);
+    }
+    return allocator->reallocate(block, old_size, new_size, allocator->context);
+}
+
+void allocatorFree(const ChessAllocator* allocator, void* block, size_t size)
+{
+    if (block == NULL) {
+        return;
+    }
+    if (allocator == NULL) {
+        free(block);
+    }
+    else {
+        allocator->free(block, size, allocator->context);
+    }
+}
+
+void chessCountingAllocatorInit(ChessCountingAllocator* counting, size_t limit)
+{
+    assert(counting != NULL);
+    ChessAllocator allocator = {countingAllocate, countingReallocate, countingFree, counting};
+    counting->allocator = allocator;
+    counting->limit = limit;
+    counting->bytes = 0;
+    counting->blocks = 0;
+    counting->peak_bytes = 0;
+    counting->allocations = 0;
+}
+
+static void* countingAllocate(size_t size, void* context)
+{
+    ChessCountingAllocator *counting = context;
+    __atomic_fetch_add(&counting->allocations, 1, __ATOMIC_RELAXED);
+    if (!reserveBytes(counting, size)) {
+        return NULL;
+    }
+    void *block = malloc(size);
+    if (block == NULL) {
+        releaseBytes(counting, size);
+        return NULL;
+    }
+    __atomic_fetch_add(&counting->blocks, 1, __ATOMIC_RELAXED);
+    return block;
+}
+
+static void* countingReallocate(void* block, size_t old_size, size_t new_size, void* context)
+{
+    ChessCountingAllocator *counting = context;
+    __atomic_fetch_add(&counting->allocations, 1, __ATOMIC_RELAXED);
+    if (new_size > old_size && !reserveBytes(counting, new_size - old_size)) {
+        return NULL;
+    }
+    void *resized = realloc(block, new_size);
+    if (resized == NULL) {
+        if (new_size > old_size) {
+            releaseBytes(counting, new_size - old_size);
+        }
+        return NULL;
+    }
+    if (new_size < old_size) {
+        releaseBytes(counting, old_size - new_size);
+    }
+    return resized;
+}
+
+static void countingFree(void* block, size_t size, void* context)
+{
+    ChessCountingAllocator *counting = context;
+    free(block);
+    releaseBytes(counting, size);
+    __atomic_fetch_sub(&counting->blocks, 1, __ATOMIC_RELAXED);
+}
+
+//Takes the bytes before they are allocated, so threads that allocate at once can not pass the limit together
+static bool reserveBytes(ChessCountingAllocator* counting, size_t size)
+{
+    size_t bytes = __atomic_add_fetch(&counting->bytes, size, __ATOMIC_RELAXED);
+    if (counting->limit != 0 && (bytes > counting->limit || bytes < size)) {
+        __atomic_sub_fetch(&counting->bytes, size, __ATOMIC_RELAXED);
+        return false;
+    }
+    size_t peak = __atomic_load_n(&counting->peak_bytes, __ATOMIC_RELAXED);
+    while (bytes > peak && !__atomic_compare_exchange_n(&counting->peak_bytes, &peak, bytes, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return true;
+}
+
+static void releaseBytes(ChessCountingAllocator* counting, size_t size)
+{
+    __atomic_sub_fetch(&counting->bytes, size, __ATOMIC_RELAXED);
+}
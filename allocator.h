@@ -0,0 +1,23 @@
+#ifndef _ALLOCATOR_H
+#define _ALLOCATOR_H
+
+#include <stddef.h>
+#include "chessSystem.h"
+
+/**
+* Calls to the allocator of a chess system.
+*
+* Every function takes the allocator the chess system was created with, and uses malloc, realloc and free if it
+* is NULL.
+*
+* The following functions are available:
+*   allocatorAllocate		- Allocates a block
+*   allocatorReallocate	- Resizes a block, which may move
+*   allocatorFree		- Frees a block, given its size
+*/
+
+void* allocatorAllocate(const ChessAllocator* allocator, size_t size);
+void* allocatorReallocate(const ChessAllocator* allocator, void* block, size_t old_size, size_t new_size);
+void allocatorFree(const ChessAllocator* allocator, void* block, size_t size);
+
+#endif //_ALLOCATOR_H
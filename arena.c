@@ -0,0 +1,279 @@
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "arena.h"
+
+#define CHUNK_SIZE 4096
+#define MAX_SMALL_SIZE (CHUNK_SIZE / 4)
+#define ALIGNMENT 16
+#define ALIGN(size) (((size) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1))
+#define SIZE_CLASSES 7 //16 to MAX_SMALL_SIZE bytes, doubling
+
+//The memory of a chunk follows its header
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t used;
+} ArenaChunk;
+
+//The memory of a big block follows its header. The big blocks are kept in a list, so any of them can be freed.
+typedef struct BigBlock {
+    struct BigBlock *previous;
+    struct BigBlock *next;
+    size_t size;
+} BigBlock;
+
+//A freed small block, kept for reuse by the next block of its size class
+typedef struct FreeBlock {
+    struct FreeBlock *next;
+} FreeBlock;
+
+typedef struct Arena_t {
+    const ChessAllocator *allocator;
+    ArenaChunk *chunks; //The chunk that blocks are carved from first. The last one is allocated with the arena.
+    BigBlock *big_blocks;
+    FreeBlock *free_blocks[SIZE_CLASSES];
+    size_t bytes_in_use;
+    size_t blocks_in_use;
+    size_t footprint; //Bytes taken from the allocator, with the headers and the unused ends of the chunks
+    size_t allocations; //Blocks taken from the allocator: the arena with its first chunk, the chunks and big blocks
+    int references; //Changed atomically, since the holders of a shared arena drop it from any thread
+} Arena_t;
+
+#define ARENA_HEADER_SIZE ALIGN(sizeof(Arena_t))
+#define CHUNK_HEADER_SIZE ALIGN(sizeof(ArenaChunk))
+#define BIG_BLOCK_HEADER_SIZE ALIGN(sizeof(BigBlock))
+
+static int getSizeClass(size_t size);
+static void* allocateSmall(Arena arena, size_t size);
+static void* allocateBig(Arena arena, size_t size);
+static void* reallocateBig(Arena arena, void* block, size_t new_size);
+static void unlinkBigBlock(Arena arena, BigBlock* header);
+
+
+Arena arenaCreate(const ChessAllocator* allocator)
+{
+    Arena arena = allocatorAllocate(allocator, ARENA_HEADER_SIZE + CHUNK_HEADER_SIZE + CHUNK_SIZE);
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->allocator = allocator;
+    arena->chunks = (ArenaChunk*)((char*)arena + ARENA_HEADER_SIZE);
+    arena->chunks->next = NULL;
+    arena->chunks->used = 0;
+    arena->big_blocks = NULL;
+    memset(arena->free_blocks, 0, sizeof(arena->free_blocks));
+    arena->bytes_in_use = 0;
+    arena->blocks_in_use = 0;
+    arena->footprint = ARENA_HEADER_SIZE + CHUNK_HEADER_SIZE + CHUNK_SIZE;
+    arena->allocations = 1;
+    arena->references = 1;
+    return arena;
+}
+
+void arenaDestroy(Arena arena)
+{
+    if (arena == NULL || __atomic_sub_fetch(&arena->references, 1, __ATOMIC_ACQ_REL) > 0) {
+        return;
+    }
+    while (arena->chunks->next != NULL) {
+        ArenaChunk *next = arena->chunks->next;
+        allocatorFree(arena->allocator, arena->chunks, CHUNK_HEADER_SIZE + CHUNK_SIZE);
+        arena->chunks = next;
+    }
+    while (arena->big_blocks != NULL) {
+        BigBlock *next = arena->big_blocks->next;
+        allocatorFree(arena->allocator, arena->big_blocks, BIG_BLOCK_HEADER_SIZE + arena->big_blocks->size);
+        arena->big_blocks = next;
+    }
+    allocatorFree(arena->allocator, arena, ARENA_HEADER_SIZE + CHUNK_HEADER_SIZE + CHUNK_SIZE);
+}
+
+void arenaRetain(Arena arena)
+{
+    assert(arena != NULL);
+    __atomic_fetch_add(&arena->references, 1, __ATOMIC_RELAXED);
+}
+
+void* arenaAllocate(Arena arena, size_t size)
+{
+    if (arena == NULL) {
+        return allocatorAllocate(NULL, size);
+    }
+    void *block = size > MAX_SMALL_SIZE ? allocateBig(arena, size) : allocateSmall(arena, size);
+    if (block != NULL) {
+        arena->bytes_in_use += size;
+        arena->blocks_in_use++;
+    }
+    return block;
+}
+
+void* arenaReallocate(Arena arena, void* block, size_t old_size, size_t new_size)
+{
+    if (arena == NULL) {
+        return allocatorReallocate(NULL, block, old_size, new_size);
+    }
+    if (block == NULL) {
+        return arenaAllocate(arena, new_size);
+    }
+    if (old_size > MAX_SMALL_SIZE && new_size > MAX_SMALL_SIZE) {
+        void *resized = reallocateBig(arena, block, new_size);
+        if (resized != NULL) {
+            arena->bytes_in_use += new_size - old_size;
+        }
+        return resized;
+    }
+    //A small block already has room for any size of its class
+    if (old_size <= MAX_SMALL_SIZE && new_size <= MAX_SMALL_SIZE && getSizeClass(old_size) == getSizeClass(new_size)) {
+        arena->bytes_in_use += new_size - old_size;
+        return block;
+    }
+    void *moved = arenaAllocate(arena, new_size);
+    if (moved == NULL) {
+        return NULL;
+    }
+    memcpy(moved, block, old_size < new_size ? old_size : new_size);
+    arenaFree(arena, block, old_size);
+    return moved;
+}
+
+void arenaFree(Arena arena, void* block, size_t size)
+{
+    if (arena == NULL) {
+        allocatorFree(NULL, block, size);
+        return;
+    }
+    if (block == NULL) {
+        return;
+    }
+    assert(arena->bytes_in_use >= size && arena->blocks_in_use > 0);
+    arena->bytes_in_use -= size;
+    arena->blocks_in_use--;
+    if (size > MAX_SMALL_SIZE) {
+        BigBlock *header = (BigBlock*)((char*)block - BIG_BLOCK_HEADER_SIZE);
+        assert(header->size == size);
+        unlinkBigBlock(arena, header);
+        arena->footprint -= BIG_BLOCK_HEADER_SIZE + size;
+        arena->allocations--;
+        allocatorFree(arena->allocator, header, BIG_BLOCK_HEADER_SIZE + size);
+    }
+    else {
+        FreeBlock *freed = block;
+        int size_class = getSizeClass(size);
+        freed->next = arena->free_blocks[size_class];
+        arena->free_blocks[size_class] = freed;
+    }
+}
+
+size_t arenaGetBytesInUse(Arena arena)
+{
+    return arena == NULL ? 0 : arena->bytes_in_use;
+}
+
+size_t arenaGetBlocksInUse(Arena arena)
+{
+    return arena == NULL ? 0 : arena->blocks_in_use;
+}
+
+size_t arenaGetFootprint(Arena arena)
+{
+    return arena == NULL ? 0 : arena->footprint;
+}
+
+size_t arenaGetAllocations(Arena arena)
+{
+    return arena == NULL ? 0 : arena->allocations;
+}
+
+//Class i holds the blocks of up to ALIGNMENT << i bytes
+static int getSizeClass(size_t size)
+{
+    int size_class = 0;
+    while (((size_t)ALIGNMENT << size_class) < size) {
+        size_class++;
+    }
+    assert(size_class < SIZE_CLASSES);
+    return size_class;
+}
+
+/*
+ * A small block takes the whole size of its class, so that it can be reused by any block of the class once it
+ * is freed. The rest of a full chunk is left unused, a small block is at most a quarter of a chunk.
+ */
+static void* allocateSmall(Arena arena, size_t size)
+{
+    int size_class = getSizeClass(size);
+    if (arena->free_blocks[size_class] != NULL) {
+        FreeBlock *block = arena->free_blocks[size_class];
+        arena->free_blocks[size_class] = block->next;
+        return block;
+    }
+    size_t aligned_size = (size_t)ALIGNMENT << size_class;
+    if (arena->chunks->used + aligned_size > CHUNK_SIZE) {
+        ArenaChunk *chunk = allocatorAllocate(arena->allocator, CHUNK_HEADER_SIZE + CHUNK_SIZE);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        chunk->used = 0;
+        arena->chunks = chunk;
+        arena->footprint += CHUNK_HEADER_SIZE + CHUNK_SIZE;
+        arena->allocations++;
+    }
+    void *block = (char*)arena->chunks + CHUNK_HEADER_SIZE + arena->chunks->used;
+    arena->chunks->used += aligned_size;
+    return block;
+}
+
+static void* allocateBig(Arena arena, size_t size)
+{
+    BigBlock *header = allocatorAllocate(arena->allocator, BIG_BLOCK_HEADER_SIZE + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    arena->footprint += BIG_BLOCK_HEADER_SIZE + size;
+    arena->allocations++;
+    header->size = size;
+    header->previous = NULL;
+    header->next = arena->big_blocks;
+    if (arena->big_blocks != NULL) {
+        arena->big_blocks->previous = header;
+    }
+    arena->big_blocks = header;
+    return (char*)header + BIG_BLOCK_HEADER_SIZE;
+}
+
+//The block may move, so the blocks next to it in the list are pointed at its new place
+static void* reallocateBig(Arena arena, void* block, size_t new_size)
+{
+    BigBlock *header = (BigBlock*)((char*)block - BIG_BLOCK_HEADER_SIZE);
+    BigBlock *resized = allocatorReallocate(arena->allocator, header, BIG_BLOCK_HEADER_SIZE + header->size,
+                                            BIG_BLOCK_HEADER_SIZE + new_size);
+    if (resized == NULL) {
+        return NULL;
+    }
+    arena->footprint += new_size - resized->size;
+    resized->size = new_size;
+    if (resized->previous != NULL) {
+        resized->previous->next = resized;
+    }
+    else {
+        arena->big_blocks = resized;
+    }
+    if (resized->next != NULL) {
+        resized->next->previous = resized;
+    }
+    return (char*)resized + BIG_BLOCK_HEADER_SIZE;
+}
+
+static void unlinkBigBlock(Arena arena, BigBlock* header)
+{
+    if (header->previous != NULL) {
+        header->previous->next = header->next;
+    }
+    else {
+        arena->big_blocks = header->next;
+    }
+    if (header->next != NULL) {
+        header->next->previous = header->previous;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+#include "allocator.h"
+
+/**
+* Region of memory owned by a single tournament.
+*
+* Small blocks are carved one after the other out of fixed size chunks, so the small parts of a tournament
+* sit next to each other and need no allocation of their own. Their sizes are rounded up to a power of 2
+* size class, and a freed small block goes to a free list of its class, from which the next block of the
+* class is taken. Blocks bigger than a quarter of a chunk, such as the growing arrays of games and stats,
+* get a block of their own that is resized in place when possible. Destroying the arena frees all its
+* chunks and big blocks at once, without going over what is in them. The arena is not thread safe.
+* The chunks and big blocks come from the allocator the arena is created with.
+* Every function also takes a NULL arena, and then allocates every block from the heap on its own.
+* An arena can be shared by reference: arenaRetain adds a reference, and arenaDestroy only frees the memory once
+* every reference was dropped. Only the references are thread safe, so a shared arena must not change anymore.
+*
+* The following functions are available:
+*   arenaCreate		- Creates a new arena, with its first chunk
+*   arenaDestroy		- Drops a reference to an arena, and frees all its memory if it was the last one
+*   arenaRetain		- Adds a reference to an arena
+*   arenaAllocate		- Allocates a block
+*   arenaReallocate	- Resizes a block, moving it if needed
+*   arenaFree		- Frees a block
+*   arenaGetBytesInUse	- Returns the total size of the blocks that were allocated and not freed
+*   arenaGetBlocksInUse	- Returns the number of blocks that were allocated and not freed
+*   arenaGetFootprint	- Returns the bytes the arena holds from its allocator, with its chunks and headers
+*   arenaGetAllocations	- Returns the number of blocks the arena holds from its allocator
+*/
+
+/** Type for defining the arena */
+typedef struct Arena_t *Arena;
+
+Arena arenaCreate(const ChessAllocator* allocator);
+void arenaDestroy(Arena arena);
+void arenaRetain(Arena arena);
+void* arenaAllocate(Arena arena, size_t size);
+void* arenaReallocate(Arena arena, void* block, size_t old_size, size_t new_size);
+void arenaFree(Arena arena, void* block, size_t size);
+size_t arenaGetBytesInUse(Arena arena);
+size_t arenaGetBlocksInUse(Arena arena);
+size_t arenaGetFootprint(Arena arena);
+size_t arenaGetAllocations(Arena arena);
+
+#endif //_ARENA_H
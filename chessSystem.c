@@ -2,55 +2,478 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <limits.h>
+#include <pthread.h>
 #include "map.h"
 #include "chessSystem.h"
 #include "game.h"
 #include "tournament.h"
+#include "locationTable.h"
+#include "playerDirectory.h"
+#include "outputBuffer.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "reclaimer.h"
+#include "allocator.h"
+#include "spillFile.h"
 
 #define NO_AVERAGE -1
+#define NO_LEADER -1
+#define REPLAY_BATCH_SIZE 4096
+#define MAX_EXPORT_THREADS 64
+#define MIN_PLAYERS_PER_THREAD 4096 //Fewer players are not worth starting a thread for
+#define MIN_TOURNAMENTS_PER_THREAD 1024
+#define TOURNAMENT_SNAPSHOT_MIN_SIZE (6 * SNAPSHOT_INT_SIZE + 1) //Six ints and the end of the location name
+#define VIEW_INIT_SIZE 16
+#define VIEW_EXPAND_FACTOR 2
 
-typedef struct chess_system_t {
+typedef struct PlayerLevel {
+    int player_id;
+    double level;
+} PlayerLevel;
+
+//The totals of a player with games, as they were when a read view was built
+typedef struct PlayerTotals {
+    int player_id;
+    int wins;
+    int losses;
+    int draws;
+    int time_played;
+} PlayerTotals;
+
+//The statistics of an ended tournament, as they were when its shard was copied
+typedef struct TournamentSummary {
+    int tournament_id;
+    int winner;
+    int longest_game;
+    double average_game_time;
+    int games_count;
+    int players_count;
+    size_t location_offset; //Of the location's name in the names of the shard view
+} TournamentSummary;
+
+/*
+ * The copy of a shard that read views are built from: the totals of its players, and the summaries of its ended
+ * tournaments by id. It is copied at a version of the shard, and is shared by every view built while the shard
+ * stays at that version, so building a view only copies the shards that changed since the latest one.
+ */
+typedef struct ShardView {
+    int references;
+    long long version;
+    TotalsRow* rows;
+    int rows_count;
+    TournamentSummary* tournaments;
+    int tournaments_count;
+    int tournaments_max_count; //Allocated, the sizes are kept for freeing through the allocator
+    char* names;
+    size_t names_length; //Used by the names copied so far
+    size_t names_size;
+} ShardView;
+
+//An ended tournament of a read view, in the shard view it was copied into
+typedef struct ViewTournament {
+    const TournamentSummary* summary;
+    const char* location;
+} ViewTournament;
+
+/*
+ * What the exports read: the totals of the players with games and the ended tournaments of all the shards, by
+ * id. The shards are copied one at a time, and the epoch of a view is the sum of the versions they were copied
+ * at. The totals are summed and the tournaments are ordered after the shard locks are released. A view never
+ * changes once built. It is shared by the snapshots taken at its epoch and by the system while it is the latest
+ * view, and the last of them to let go of it frees it.
+ */
+typedef struct ReadView {
+    const ChessAllocator* allocator;
+    long long epoch;
+    int references;
+    ShardView** shards;
+    int shards_count;
+    PlayerTotals* players;
+    int players_count;
+    int players_max_count;
+    ViewTournament* tournaments;
+    int tournaments_count;
+} ReadView;
+
+//The id of a player of the tournament an iterator is over, kept by its slot
+typedef struct IteratorPlayer {
+    int player_slot;
+    int player_id;
+} IteratorPlayer;
+
+//Iterates over the archive of a tournament's games, shared with the tournament if it is frozen
+typedef struct ChessGameIterator_t {
+    const ChessAllocator* allocator;
+    Arena shared; //The arena of the frozen tournament that holds the archive, NULL if the iterator owns the archive
+    const unsigned char* archive;
+    size_t archive_size;
+    int games_count;
+    int tournament_id;
+    IteratorPlayer* players; //Sorted by slot, so the games are read without the player directory
+    int players_count;
+    GameArchiveIterator games;
+} ChessGameIterator_t;
+
+typedef struct ChessReadSnapshot_t {
+    const ChessAllocator* allocator;
+    ReadView* view;
+    int export_threads;
+} ChessReadSnapshot_t;
+
+//The levels of the players first to end - 1 of a view, computed and sorted by one thread
+typedef struct LevelsRun {
+    const PlayerTotals* players;
+    int first;
+    int end;
+    PlayerLevel* levels;
+} LevelsRun;
+
+//A game of a batch, sorted by tournament and then by its position in the batch
+typedef struct BatchEntry {
+    int tournament_id;
+    size_t index;
+} BatchEntry;
+
+/*
+ * The key of a tournament in the map of its shard. libmap gives the key callbacks no context, so each key carries
+ * the allocator it is copied and freed with. The id comes first, so the map can be searched with a plain id.
+ */
+typedef struct TournamentKey {
+    int tournament_id;
+    const ChessAllocator* allocator;
+    struct TournamentKey* reserved; //Only in a key given to mapPut, the block its copy is put in
+} TournamentKey;
+
+//A tournament of any of the shards
+typedef struct TournamentEntry {
+    int tournament_id;
+    Tournament* tournament;
+} TournamentEntry;
+
+//The statistics of the tournaments first to end - 1 of a view, printed by one thread
+typedef struct StatisticsRun {
+    const ReadView* view;
+    int first;
+    int end;
+    bool written;
+    OutputBuffer output;
+} StatisticsRun;
+
+typedef struct Shard {
     Map tournaments;
+    pthread_mutex_t lock;
+    long long version; //Counts the changes to the shard's tournaments, read atomically without the lock
+    TotalsTable totals; //Of the players over the shard's tournaments
+    Tournament *lru_first; //The frozen tournaments of the shard that are in memory, most recently used first
+    Tournament *lru_last;
+    size_t resident_bytes; //The footprints of the arenas of the tournaments in lru, with their chunks and headers
+    ChessSpillStats spill_stats; //resident_bytes is not kept in it
+} Shard;
+
+/*
+ * The tournaments are split between the shards by id. In a thread safe system each shard, the locations, the
+ * journal and the latest view have their own lock. An operation on a single tournament holds the lock of its
+ * shard, and operations that cross tournaments hold all the shard locks. Locks are always taken in the order:
+ * the latest view, shards by index, locations, the player directory (which locks itself) and the journal.
+ * The epoch of the system is the sum of the versions of its shards, so it grows with every change.
+ */
+typedef struct chess_system_t {
+    const ChessAllocator* allocator; //NULL for the heap
+    Shard *shards;
+    int shards_count;
+    int shards_max_count; //Allocated, the first shards_count are initialized
+    bool thread_safe;
+    LocationTable locations;
+    pthread_mutex_t locations_lock;
+    PlayerDirectory players;
+    Journal journal; //NULL if changes are not journaled
+    pthread_mutex_t journal_lock;
+    int export_threads; //Read and written atomically
+    ReadView* latest_view; //NULL until the first snapshot, changed under view_lock
+    pthread_mutex_t view_lock;
+    Reclaimer reclaimer; //NULL if removed tournaments are destroyed by the caller, changed under all the shard locks
+    bool freeze_ended; //Changed under all the shard locks
+    SpillFile spill_file; //NULL if there is no memory budget, changed under all the shard locks
+    size_t shard_budget; //The most bytes of frozen tournaments each shard keeps in memory
 } chess_system_t;
 
-static ChessResult updateWinnerStats(Tournament* tournament, int first_player,
-                         int second_player, Winner winner, int play_time);
-static void printToFile(Map players_ranked, FILE* file, ChessResult* result);
-static double FindMaxData(Map players_ranked, int *id);
-static Map computePlayersRank(ChessSystem chess, ChessResult* chess_result);
-static int computeGamesStats(Map games, double* avg_game_time);
-static ChessResult printTournamnentStats(Tournament* tournament, FILE* file);
-MapKeyElement copyKeyInt(MapKeyElement n);
-void freeInt(MapKeyElement n);
-MapKeyElement copyDouble(MapKeyElement n);
+static ChessSystem createSystem(int shards_count, bool thread_safe, const ChessAllocator* allocator);
+static bool initLocks(ChessSystem chess);
+static bool initShard(ChessSystem chess, Shard* shard);
+static Shard* getShard(ChessSystem chess, int tournament_id);
+static void lock(ChessSystem chess, pthread_mutex_t* mutex);
+static void unlock(ChessSystem chess, pthread_mutex_t* mutex);
+static void lockAllShards(ChessSystem chess);
+static void unlockAllShards(ChessSystem chess);
+static TournamentEntry* collectTournaments(ChessSystem chess, int* count);
+static int compareTournamentEntries(const void* first, const void* second);
+static ChessResult addTournament(ChessSystem chess, Shard* shard, int tournament_id, int max_games_per_player,
+                                 const char* tournament_location);
+static bool putTournament(ChessSystem chess, Shard* shard, int tournament_id, Tournament* tournament);
+static ChessResult addGame(ChessSystem chess, Tournament* tournament, const ChessGameRecord* game);
+static int compareBatchEntries(const void* first, const void* second);
+static ChessResult printToFile(const PlayerLevel* levels, int count, FILE* file);
+static int comparePlayerLevels(const void* first, const void* second);
+static ChessResult removePlayer(ChessSystem chess, int player_id);
+static ChessResult endTournament(ChessSystem chess, Shard* shard, int tournament_id);
+static void commitChange(ChessSystem chess, Shard* shard, const JournalRecord* record);
+static ReadView* buildView(ChessSystem chess);
+static bool addShardView(ChessSystem chess, int shard, const ReadView* previous, ReadView* view);
+static ShardView* copyShard(ChessSystem chess, Shard* shard);
+static bool appendSummary(ChessSystem chess, ShardView* shard_view, int tournament_id, const Tournament* tournament);
+static bool mergeShardViews(ChessSystem chess, ReadView* view);
+static void compactViewPlayers(ChessSystem chess, ReadView* view);
+static int compareViewTournaments(const void* first, const void* second);
+static void releaseView(ReadView* view);
+static void releaseShardView(const ChessAllocator* allocator, ShardView* shard_view);
+static bool openArchive(ChessSystem chess, const Tournament* tournament, ChessGameIterator iterator);
+static int findIteratorPlayer(const IteratorPlayer* players, int players_count, int player_slot);
+static int compareIteratorPlayers(const void* first, const void* second);
+static void destroyArena(void* arena);
+static void dropArena(ChessSystem chess, Arena arena);
+static bool pageIn(ChessSystem chess, Shard* shard, Tournament* tournament);
+static void useFrozen(ChessSystem chess, Shard* shard, Tournament* tournament);
+static void linkFrozen(Shard* shard, Tournament* tournament);
+static void unlinkFrozen(Shard* shard, Tournament* tournament);
+static bool spillTournament(ChessSystem chess, Shard* shard, Tournament* tournament);
+static bool reloadAll(ChessSystem chess);
+static void computePlayerLevel(const PlayerTotals* totals, PlayerLevel* level);
+static void computeSortedLevels(const ReadView* view, int export_threads, PlayerLevel* levels);
+static void* computeLevelsRun(void* argument);
+static void mergeLevelsRuns(LevelsRun* runs, int runs_count, PlayerLevel* levels);
+static void runInParallel(void* (*work)(void*), void* arguments, int count, size_t argument_size);
+static void siftLevelDown(PlayerLevel* heap, int size, int index);
+static void siftLevelUp(PlayerLevel* heap, int index);
+static ChessResult saveSnapshot(ChessSystem chess, const char* path, const char* journal_path, int sync_batch);
+static bool loadSnapshot(ChessSystem chess, SnapshotReader* reader);
+static bool loadTournaments(ChessSystem chess, SnapshotReader* reader, int tournaments_count);
+static bool loadTournament(ChessSystem chess, SnapshotReader* reader, int tournament_id, int max_games_per_player,
+                           const char* tournament_location);
+static bool closeJournal(ChessSystem chess);
+static Journal swapJournal(ChessSystem chess, Journal journal);
+static bool isEmpty(ChessSystem chess);
+static void appendToJournal(ChessSystem chess, const JournalRecord* record);
+static ChessResult replayRecords(ChessSystem chess, JournalReader* reader, ChessGameRecord* games,
+                                 ChessResult* results);
+static bool printStatistics(const ReadView* view, int export_threads, FILE* file);
+static void* printStatisticsRun(void* argument);
+static void printTournamnentStats(const ViewTournament* tournament, OutputBuffer* buffer);
+static MapDataElement takeTournament(MapDataElement tournament);
+static MapKeyElement copyTournamentKey(MapKeyElement key);
+static void freeTournamentKey(MapKeyElement key);
 int compareInts(MapKeyElement n1, MapKeyElement n2);
-void freeDouble(MapKeyElement n);
 
 
 ChessSystem chessCreate()
 {
-    ChessSystem chess = malloc(sizeof(*chess));
+    return createSystem(1, false, NULL);
+}
+
+ChessSystem chessCreateThreadSafe(int shards_count)
+{
+    if (shards_count <= 0) {
+        return NULL;
+    }
+    return createSystem(shards_count, true, NULL);
+}
+
+ChessSystem chessCreateWithAllocator(const ChessAllocator* allocator)
+{
+    if (allocator == NULL || allocator->allocate == NULL || allocator->reallocate == NULL ||
+        allocator->free == NULL) {
+        return NULL;
+    }
+    return createSystem(1, false, allocator);
+}
+
+static ChessSystem createSystem(int shards_count, bool thread_safe, const ChessAllocator* allocator)
+{
+    ChessSystem chess = allocatorAllocate(allocator, sizeof(*chess));
     if (chess == NULL) {
         return NULL;
     }
-    chess->tournaments = mapCreate(tournamentCopy,
-              copyKeyInt,
-              tournamentDestroy,
-              freeInt,
-              compareInts);
-    if (chess->tournaments == NULL) {
-        free(chess);
+    chess->allocator = allocator;
+    chess->shards = allocatorAllocate(allocator, sizeof(Shard) * shards_count);
+    if (chess->shards == NULL) {
+        allocatorFree(allocator, chess, sizeof(*chess));
         return NULL;
     }
+    chess->shards_max_count = shards_count;
+    chess->thread_safe = thread_safe;
+    if (thread_safe && !initLocks(chess)) {
+        allocatorFree(allocator, chess->shards, sizeof(Shard) * shards_count);
+        allocatorFree(allocator, chess, sizeof(*chess));
+        return NULL;
+    }
+    //From here chessDestroy can clean up whatever was created
+    chess->shards_count = 0;
+    chess->locations = locationTableCreate();
+    chess->players = playerDirectoryCreate(thread_safe, allocator);
+    chess->journal = NULL;
+    chess->export_threads = 1;
+    chess->latest_view = NULL;
+    chess->reclaimer = NULL;
+    chess->freeze_ended = false;
+    chess->spill_file = NULL;
+    chess->shard_budget = 0;
+    if (chess->locations == NULL || chess->players == NULL) {
+        chessDestroy(chess);
+        return NULL;
+    }
+    for (; chess->shards_count < shards_count; chess->shards_count++) {
+        if (!initShard(chess, &chess->shards[chess->shards_count])) {
+            chessDestroy(chess);
+            return NULL;
+        }
+    }
     return chess;
 }
 
+static bool initLocks(ChessSystem chess)
+{
+    if (pthread_mutex_init(&chess->locations_lock, NULL) != 0) {
+        return false;
+    }
+    if (pthread_mutex_init(&chess->journal_lock, NULL) != 0) {
+        pthread_mutex_destroy(&chess->locations_lock);
+        return false;
+    }
+    if (pthread_mutex_init(&chess->view_lock, NULL) != 0) {
+        pthread_mutex_destroy(&chess->locations_lock);
+        pthread_mutex_destroy(&chess->journal_lock);
+        return false;
+    }
+    return true;
+}
+
+static bool initShard(ChessSystem chess, Shard* shard)
+{
+    shard->tournaments = mapCreate(takeTournament,
+              copyTournamentKey,
+              tournamentDestroy,
+              freeTournamentKey,
+              compareInts);
+    if (shard->tournaments == NULL) {
+        return false;
+    }
+    shard->totals = totalsTableCreate(chess->allocator);
+    if (shard->totals == NULL) {
+        mapDestroy(shard->tournaments);
+        return false;
+    }
+    if (chess->thread_safe && pthread_mutex_init(&shard->lock, NULL) != 0) {
+        totalsTableDestroy(shard->totals);
+        mapDestroy(shard->tournaments);
+        return false;
+    }
+    shard->version = 0;
+    shard->lru_first = NULL;
+    shard->lru_last = NULL;
+    shard->resident_bytes = 0;
+    memset(&shard->spill_stats, 0, sizeof(shard->spill_stats));
+    return true;
+}
+
 void chessDestroy(ChessSystem chess)
 {
     if (chess != NULL) {
-        mapDestroy(chess->tournaments);
-        free(chess);
+        reclaimerDestroy(chess->reclaimer);
+        for (int i = 0; i < chess->shards_count; i++) {
+            mapDestroy(chess->shards[i].tournaments);
+            totalsTableDestroy(chess->shards[i].totals);
+            if (chess->thread_safe) {
+                pthread_mutex_destroy(&chess->shards[i].lock);
+            }
+        }
+        allocatorFree(chess->allocator, chess->shards, sizeof(Shard) * chess->shards_max_count);
+        locationTableDestroy(chess->locations);
+        playerDirectoryDestroy(chess->players);
+        journalClose(chess->journal);
+        releaseView(chess->latest_view);
+        spillFileClose(chess->spill_file);
+        if (chess->thread_safe) {
+            pthread_mutex_destroy(&chess->locations_lock);
+            pthread_mutex_destroy(&chess->journal_lock);
+            pthread_mutex_destroy(&chess->view_lock);
+        }
+        allocatorFree(chess->allocator, chess, sizeof(*chess));
+    }
+}
+
+//Negative ids are never found, but still have a shard to look in
+static Shard* getShard(ChessSystem chess, int tournament_id)
+{
+    return &chess->shards[(unsigned)tournament_id % chess->shards_count];
+}
+
+static void lock(ChessSystem chess, pthread_mutex_t* mutex)
+{
+    if (chess->thread_safe) {
+        pthread_mutex_lock(mutex);
+    }
+}
+
+static void unlock(ChessSystem chess, pthread_mutex_t* mutex)
+{
+    if (chess->thread_safe) {
+        pthread_mutex_unlock(mutex);
+    }
+}
+
+static void lockAllShards(ChessSystem chess)
+{
+    for (int i = 0; i < chess->shards_count; i++) {
+        lock(chess, &chess->shards[i].lock);
+    }
+}
+
+static void unlockAllShards(ChessSystem chess)
+{
+    for (int i = chess->shards_count - 1; i >= 0; i--) {
+        unlock(chess, &chess->shards[i].lock);
+    }
+}
+
+/*
+ * The caller has to hold all the shard locks. Returns NULL if an allocation failed, also if copying the key of a
+ * tournament failed, which stops iterating over its shard.
+ */
+static TournamentEntry* collectTournaments(ChessSystem chess, int* count)
+{
+    int total = 0;
+    for (int i = 0; i < chess->shards_count; i++) {
+        total += mapGetSize(chess->shards[i].tournaments);
+    }
+    TournamentEntry *entries = allocatorAllocate(chess->allocator, sizeof(TournamentEntry) * (total + 1));
+    if (entries == NULL) {
+        return NULL;
     }
+    *count = 0;
+    for (int i = 0; i < chess->shards_count; i++) {
+        Map tournaments = chess->shards[i].tournaments;
+        MAP_FOREACH(int*, iter, tournaments) {
+            entries[*count].tournament_id = *iter;
+            entries[*count].tournament = mapGet(tournaments, iter);
+            (*count)++;
+            freeTournamentKey(iter);
+        }
+    }
+    if (*count < total) {
+        allocatorFree(chess->allocator, entries, sizeof(TournamentEntry) * (total + 1));
+        return NULL;
+    }
+    //Every shard is already sorted by id
+    if (chess->shards_count > 1) {
+        qsort(entries, *count, sizeof(TournamentEntry), compareTournamentEntries);
+    }
+    return entries;
+}
+
+static int compareTournamentEntries(const void* first, const void* second)
+{
+    const TournamentEntry *first_entry = first, *second_entry = second;
+    return compareInts((MapKeyElement)&first_entry->tournament_id, (MapKeyElement)&second_entry->tournament_id);
 }
 
 ChessResult chessAddTournament (ChessSystem chess, int tournament_id,
@@ -62,98 +485,188 @@ ChessResult chessAddTournament (ChessSystem chess, int tournament_id,
     if (tournament_id <= 0) {
         return CHESS_INVALID_ID;
     }
-    if(mapContains(chess->tournaments, &tournament_id)){
+    Shard *shard = getShard(chess, tournament_id);
+    lock(chess, &shard->lock);
+    lock(chess, &chess->locations_lock);
+    ChessResult result = addTournament(chess, shard, tournament_id, max_games_per_player, tournament_location);
+    unlock(chess, &chess->locations_lock);
+    if (result == CHESS_SUCCESS) {
+        JournalRecord record = {JOURNAL_ADD_TOURNAMENT, {tournament_id, max_games_per_player},
+                                tournament_location};
+        commitChange(chess, shard, &record);
+    }
+    unlock(chess, &shard->lock);
+    return result;
+}
+
+//The caller holds the locks of the tournament's shard and of the locations.
+static ChessResult addTournament(ChessSystem chess, Shard* shard, int tournament_id, int max_games_per_player,
+                                 const char* tournament_location)
+{
+    if(mapContains(shard->tournaments, &tournament_id)){
         return CHESS_TOURNAMENT_ALREADY_EXISTS;
     }
-    if(!checkLocation(tournament_location)) {
+    //Only valid names are interned, so a known name does not have to be checked again.
+    Location location = locationTableAcquire(chess->locations, tournament_location);
+    if(location == NULL && !checkLocation(tournament_location)) {
         return CHESS_INVALID_LOCATION;
     }
     if (max_games_per_player <= 0) {
+        locationRelease(location);
         return CHESS_INVALID_MAX_GAMES;
     }
-    Tournament *new_tournament=tournamentCreate(copyKeyInt,
-                                               freeInt,
-                                               compareInts,
-                                               tournament_location,
-                                               max_games_per_player);
-    if(new_tournament==NULL){
-        return CHESS_OUT_OF_MEMORY;
+    if (location == NULL) {
+        location = locationTableAdd(chess->locations, tournament_location);
+        if (location == NULL) {
+            return CHESS_OUT_OF_MEMORY;
+        }
     }
-    if(mapPut(chess->tournaments, &tournament_id, new_tournament)!= MAP_SUCCESS){
+    Tournament *new_tournament=tournamentCreate(location, max_games_per_player, chess->players, shard->totals,
+                                                chess->allocator);
+    locationRelease(location);
+    if(new_tournament==NULL || !putTournament(chess, shard, tournament_id, new_tournament)){
         return CHESS_OUT_OF_MEMORY;//Already checked NULL arguments, so its has to be memory failure.
     }
-    tournamentDestroy(new_tournament);
     return CHESS_SUCCESS;
 }
 
+/*
+ * Puts a new tournament in its shard, or destroys it if putting failed. libmap frees the copies it made with free
+ * if putting fails, so neither copy may fail or come from the allocator: the map takes over the tournament, and
+ * the key is copied into a block allocated beforehand.
+ */
+static bool putTournament(ChessSystem chess, Shard* shard, int tournament_id, Tournament* tournament)
+{
+    TournamentKey key = {tournament_id, chess->allocator, allocatorAllocate(chess->allocator, sizeof(key))};
+    if(key.reserved == NULL || mapPut(shard->tournaments, &key, tournament)!= MAP_SUCCESS){
+        allocatorFree(chess->allocator, key.reserved, sizeof(key));
+        tournamentDestroy(tournament);
+        return false;
+    }
+    return true;
+}
+
 ChessResult chessAddGame(ChessSystem chess, int tournament_id, int first_player,
                          int second_player, Winner winner, int play_time)
 {
     if (chess == NULL) {
         return CHESS_NULL_ARGUMENT;
     }
-    if (tournament_id < 0 || first_player < 0 || second_player < 0 || first_player == second_player) {
+    ChessGameRecord game = {tournament_id, first_player, second_player, winner, play_time};
+    Shard *shard = getShard(chess, tournament_id);
+    lock(chess, &shard->lock);
+    ChessResult result = addGame(chess, mapGet(shard->tournaments, &tournament_id), &game);
+    unlock(chess, &shard->lock);
+    return result;
+}
+
+ChessResult chessAddGames(ChessSystem chess, const ChessGameRecord* games, size_t n, ChessResult* results)
+{
+    if (chess == NULL || ((games == NULL || results == NULL) && n > 0)) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    if (n == 0) {
+        return CHESS_SUCCESS;
+    }
+    BatchEntry *order = allocatorAllocate(chess->allocator, sizeof(BatchEntry) * n);
+    if (order == NULL) {
+        return CHESS_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; i < n; i++) {
+        order[i].tournament_id = games[i].tournament_id;
+        order[i].index = i;
+    }
+    qsort(order, n, sizeof(BatchEntry), compareBatchEntries);
+    size_t end;
+    for (size_t start = 0; start < n; start = end) {
+        int tournament_id = order[start].tournament_id;
+        for (end = start + 1; end < n && order[end].tournament_id == tournament_id; end++);
+        Shard *shard = getShard(chess, tournament_id);
+        lock(chess, &shard->lock);
+        Tournament* tournament = mapGet(shard->tournaments, &tournament_id);
+        //A failed reserve is not an error here, adding each game still grows the games as needed
+        if (tournament != NULL && tournament->winner == TOURNAMENT_NOT_ENDED && end - start < INT_MAX) {
+            tournamentReserveGames(tournament, (int)(end - start));
+        }
+        for (size_t i = start; i < end; i++) {
+            results[order[i].index] = addGame(chess, tournament, &games[order[i].index]);
+        }
+        unlock(chess, &shard->lock);
+    }
+    allocatorFree(chess->allocator, order, sizeof(BatchEntry) * n);
+    return CHESS_SUCCESS;
+}
+
+//The tournament of the game is looked up by the caller, who holds the lock of its shard. It is NULL if it does
+//not exist.
+static ChessResult addGame(ChessSystem chess, Tournament* tournament, const ChessGameRecord* game)
+{
+    if (game->tournament_id < 0 || game->first_player < 0 || game->second_player < 0 ||
+        game->first_player == game->second_player) {
         return CHESS_INVALID_ID;
     }
-    if (!mapContains(chess->tournaments, &tournament_id)) {
+    if (tournament == NULL) {
         return CHESS_TOURNAMENT_NOT_EXIST;
     }
-    Tournament* tournament = mapGet(chess->tournaments, &tournament_id);
-    assert(tournament != NULL);
-    if (tournament-> winner != -1) {
+    if (tournament->winner != TOURNAMENT_NOT_ENDED) {
         return CHESS_TOURNAMENT_ENDED;
     }
-    if(checkAlreadyPlayed(tournament,first_player,second_player)){
+    //Players that were never seen have no slot yet, so they have not played any game.
+    int first_slot = playerDirectoryFind(chess->players, game->first_player);
+    int second_slot = playerDirectoryFind(chess->players, game->second_player);
+    if(first_slot != PLAYER_DIRECTORY_NOT_FOUND && second_slot != PLAYER_DIRECTORY_NOT_FOUND &&
+       checkAlreadyPlayed(tournament,first_slot,second_slot)){
         return CHESS_GAME_ALREADY_EXISTS;
     }
-    if (play_time < 0) {
+    if (game->play_time < 0) {
         return CHESS_INVALID_PLAY_TIME;
     }
-    if (checkExceededGames(tournament, first_player) || checkExceededGames(tournament, second_player)){
+    if ((first_slot != PLAYER_DIRECTORY_NOT_FOUND && checkExceededGames(tournament, first_slot)) ||
+        (second_slot != PLAYER_DIRECTORY_NOT_FOUND && checkExceededGames(tournament, second_slot))){
         return CHESS_EXCEEDED_GAMES;
     }
-    Game *new_game = gameCreate(first_player, second_player, winner, play_time);
-    if (new_game == NULL) {
+    if (first_slot == PLAYER_DIRECTORY_NOT_FOUND) {
+        first_slot = playerDirectoryAdd(chess->players, game->first_player);
+    }
+    if (second_slot == PLAYER_DIRECTORY_NOT_FOUND) {
+        second_slot = playerDirectoryAdd(chess->players, game->second_player);
+    }
+    if (first_slot == PLAYER_DIRECTORY_NOT_FOUND || second_slot == PLAYER_DIRECTORY_NOT_FOUND) {
         return CHESS_OUT_OF_MEMORY;
     }
-    if (mapPut(tournament->games, &(tournament->next_game_id), new_game) != MAP_SUCCESS) {
-        return CHESS_OUT_OF_MEMORY; //Already checked NULL arguments, so its has to be memory failure.
+    //The players are recorded in the tournament only once the game is in it, so a failure leaves no trace of it.
+    //Reserving first means recording them can not fail.
+    bool first_new = tournamentGetPlayerStats(tournament, first_slot) == NULL;
+    bool second_new = tournamentGetPlayerStats(tournament, second_slot) == NULL;
+    if (!playerDirectoryReserveTournaments(chess->players, first_slot, first_new) ||
+        !playerDirectoryReserveTournaments(chess->players, second_slot, second_new)) {
+        return CHESS_OUT_OF_MEMORY;
     }
-    tournament->next_game_id++;
-    gameDestroy(new_game);
-    return updateWinnerStats(tournament, first_player, second_player, winner, play_time);
-}
-
-static ChessResult updateWinnerStats(Tournament* tournament, int first_player,
-                         int second_player, Winner winner, int play_time)
-{
-    if (winner == FIRST_PLAYER) {
-        if (updateStats(tournament->players_stats, first_player, 1, 0, 0, play_time) != MAP_SUCCESS) {
-            return CHESS_OUT_OF_MEMORY;
-        }
-        if (updateStats(tournament->players_stats, second_player, 0, 1, 0, play_time) != MAP_SUCCESS) {
-            return CHESS_OUT_OF_MEMORY;
-        } 
+    if (tournamentAddGame(tournament, first_slot, second_slot, game->winner, game->play_time) != MAP_SUCCESS) {
+        return CHESS_OUT_OF_MEMORY;
     }
-    else if (winner == SECOND_PLAYER) {
-        if (updateStats(tournament->players_stats, first_player, 0, 1, 0, play_time) != MAP_SUCCESS) {
-            return CHESS_OUT_OF_MEMORY;
-        }
-        if (updateStats(tournament->players_stats, second_player, 1, 0, 0, play_time) != MAP_SUCCESS) {
-             return CHESS_OUT_OF_MEMORY;
-        }
+    if (first_new) {
+        playerDirectoryAddTournament(chess->players, first_slot, tournament);
     }
-    else {
-        if (updateStats(tournament->players_stats, first_player, 0, 0, 1, play_time) != MAP_SUCCESS) {
-             return CHESS_OUT_OF_MEMORY;
-        }
-        if (updateStats(tournament->players_stats, second_player, 0, 0, 1, play_time) != MAP_SUCCESS) {
-            return CHESS_OUT_OF_MEMORY;
-        }
+    if (second_new) {
+        playerDirectoryAddTournament(chess->players, second_slot, tournament);
     }
+    JournalRecord record = {JOURNAL_ADD_GAME, {game->tournament_id, game->first_player, game->second_player,
+                                               game->winner, game->play_time}, NULL};
+    commitChange(chess, getShard(chess, game->tournament_id), &record);
     return CHESS_SUCCESS;
 }
 
+//Games of the same tournament keep their order in the batch, so they are added in that order.
+static int compareBatchEntries(const void* first, const void* second)
+{
+    const BatchEntry *first_entry = first, *second_entry = second;
+    if (first_entry->tournament_id != second_entry->tournament_id) {
+        return first_entry->tournament_id < second_entry->tournament_id ? -1 : 1;
+    }
+    return first_entry->index < second_entry->index ? -1 : (first_entry->index > second_entry->index);
+}
+
 ChessResult chessRemoveTournament (ChessSystem chess, int tournament_id)
 {
     if (chess == NULL) {
@@ -162,10 +675,49 @@ ChessResult chessRemoveTournament (ChessSystem chess, int tournament_id)
     if (tournament_id < 0) {
         return CHESS_INVALID_ID;
     }
-    if (!mapContains(chess->tournaments, &tournament_id)) {
+    Shard *shard = getShard(chess, tournament_id);
+    lock(chess, &shard->lock);
+    Tournament* tournament = mapGet(shard->tournaments, &tournament_id);
+    if (tournament == NULL) {
+        unlock(chess, &shard->lock);
         return CHESS_TOURNAMENT_NOT_EXIST;
     }
-    mapRemove(chess->tournaments, &tournament_id);
+    //The stats of a spilled tournament are read straight from the spill file, it is not mapped back to be dropped
+    SpillMapping mapping;
+    if (tournament->spilled && !spillFileMap(chess->spill_file, tournament->spill_offset,
+                                             tournamentGetSpillSize(tournament), &mapping)) {
+        unlock(chess, &shard->lock);
+        return CHESS_OUT_OF_MEMORY;
+    }
+    unlinkFrozen(shard, tournament);
+    for (int i = 0; i < tournament->players_count; i++) {
+        PlayerStats stats;
+        if (tournament->spilled) {
+            tournamentReadSpilledStats(tournament, mapping.data, i, &stats);
+        }
+        else {
+            stats = tournament->players_stats[i];
+        }
+        playerDirectoryRemoveTournament(chess->players, stats.player_slot, tournament);
+        playerDirectoryUpdateStats(chess->players, stats.player_slot, -stats.wins, -stats.losses,
+                                   -stats.draws, -stats.time_played);
+        totalsTableUpdate(shard->totals, stats.player_slot, -stats.wins, -stats.losses, -stats.draws,
+                          -stats.time_played);
+    }
+    if (tournament->spilled) {
+        spillFileUnmap(&mapping);
+    }
+    //Only the location is released here, the arena of the tournament is destroyed by the reclaimer if there is one
+    Arena detached = chess->reclaimer != NULL ? tournamentDetach(tournament) : NULL;
+    lock(chess, &chess->locations_lock);
+    mapRemove(shard->tournaments, &tournament_id);
+    unlock(chess, &chess->locations_lock);
+    if (detached != NULL) {
+        dropArena(chess, detached);
+    }
+    JournalRecord record = {JOURNAL_REMOVE_TOURNAMENT, {tournament_id}, NULL};
+    commitChange(chess, shard, &record);
+    unlock(chess, &shard->lock);
     return CHESS_SUCCESS;
 }
 ChessResult chessRemovePlayer(ChessSystem chess, int player_id)
@@ -176,59 +728,71 @@ ChessResult chessRemovePlayer(ChessSystem chess, int player_id)
     if(player_id <= 0){
         return CHESS_INVALID_ID;
     }
-    int count=0;
-    MAP_FOREACH(int *,iter,chess->tournaments){
-        Tournament* curr_tournament=(Tournament*)mapGet(chess->tournaments,iter);
-        if (mapContains(curr_tournament->players_stats, &player_id)) {
-            count += ((int*)mapGet(curr_tournament->players_stats,&player_id))[TIME_PLAYED] > 0;
-        }
+    lockAllShards(chess);
+    ChessResult result = removePlayer(chess, player_id);
+    unlockAllShards(chess);
+    return result;
+}
+
+//The caller holds all the shard locks, since the player's games are in any of them.
+static ChessResult removePlayer(ChessSystem chess, int player_id)
+{
+    int player = playerDirectoryFind(chess->players, player_id);
+    if (player == PLAYER_DIRECTORY_NOT_FOUND) {
+        return CHESS_PLAYER_NOT_EXIST;
+    }
+    PlayerRecord* record = playerDirectoryGet(chess->players, player);
+    int games, time_played;
+    playerDirectoryGetPlayed(chess->players, player, &games, &time_played);
+    bool exists = time_played > 0; //Checked before the removal resets the player's stats
+    for (int i = 0; i < record->tournaments_count; i++) {
+        Tournament* curr_tournament = record->tournaments[i];
         if(curr_tournament->winner == TOURNAMENT_NOT_ENDED){
-            tournamentRemovePlayer(curr_tournament,player_id);
+            tournamentRemovePlayer(curr_tournament,player);
         }
-        free(iter);
     }
-    if(!count){
+    //Journaled even if the player does not exist, since its games were still changed
+    JournalRecord journal_record = {JOURNAL_REMOVE_PLAYER, {player_id}, NULL};
+    commitChange(chess, &chess->shards[0], &journal_record); //Any of the locked shards will do
+    if(!exists){
         return CHESS_PLAYER_NOT_EXIST;
     }
     return CHESS_SUCCESS;
 }
 
 
-MapKeyElement copyKeyInt(MapKeyElement n) {
-    if (!n) {
-        return NULL;
-    }
-    int *copy = malloc(sizeof(*copy));
-    if (!copy) {
-        return NULL;
-    }
-    *copy = *(int *) n;
-    return copy;
+//The map owns the tournaments in it, and destroys them with tournamentDestroy
+static MapDataElement takeTournament(MapDataElement tournament) {
+    return tournament;
 }
 
-void freeInt(MapKeyElement n) {
-    free(n);
-}
-MapKeyElement copyDouble(MapKeyElement n) {
-    if (!n) {
+//Only TournamentKeys are put in the maps, so every key that is copied is one.
+static MapKeyElement copyTournamentKey(MapKeyElement key) {
+    if (!key) {
         return NULL;
     }
-    double *copy = malloc(sizeof(*copy));
+    const TournamentKey *tournament_key = key;
+    TournamentKey *copy = tournament_key->reserved;
+    if (copy == NULL) {
+        copy = allocatorAllocate(tournament_key->allocator, sizeof(*copy));
+    }
     if (!copy) {
         return NULL;
     }
-    *copy = *(double *) n;
+    *copy = *tournament_key;
+    copy->reserved = NULL;
     return copy;
 }
 
+static void freeTournamentKey(MapKeyElement key) {
+    if (key != NULL) {
+        allocatorFree(((TournamentKey *) key)->allocator, key, sizeof(TournamentKey));
+    }
+}
 int compareInts(MapKeyElement n1, MapKeyElement n2) {
     return (*(int *) n1 - *(int *) n2);
 }
 
-void freeDouble(MapKeyElement n) {
-    free(n);
-}
-
 ChessResult chessEndTournament (ChessSystem chess, int tournament_id)
 {
     if(chess == NULL){
@@ -237,19 +801,61 @@ ChessResult chessEndTournament (ChessSystem chess, int tournament_id)
     if(tournament_id < 0){
         return CHESS_INVALID_ID;
     }
-    if(!mapContains(chess->tournaments, &tournament_id)){
+    Shard *shard = getShard(chess, tournament_id);
+    lock(chess, &shard->lock);
+    ChessResult result = endTournament(chess, shard, tournament_id);
+    unlock(chess, &shard->lock);
+    return result;
+}
+
+static ChessResult endTournament(ChessSystem chess, Shard* shard, int tournament_id)
+{
+    if(!mapContains(shard->tournaments, &tournament_id)){
         return CHESS_TOURNAMENT_NOT_EXIST;
     }
-    Tournament* curr_tournament = mapGet(chess->tournaments, &tournament_id);
+    Tournament* curr_tournament = mapGet(shard->tournaments, &tournament_id);
     if(curr_tournament->winner != TOURNAMENT_NOT_ENDED){
         return CHESS_TOURNAMENT_ENDED;
     }
-    if(mapGetSize(curr_tournament->games) == 0){
+    if(curr_tournament->games_count == 0){
         return CHESS_NO_GAMES;
     }
     tournamentEnd(curr_tournament);
+    if (chess->freeze_ended && tournamentFreeze(curr_tournament)) { //Still correct if it stays unfrozen
+        useFrozen(chess, shard, curr_tournament);
+    }
+    JournalRecord record = {JOURNAL_END_TOURNAMENT, {tournament_id}, NULL};
+    commitChange(chess, shard, &record);
+    return CHESS_SUCCESS;
+}
+ChessResult chessGetTournamentLeaders(ChessSystem chess, int tournament_id, int k, int* leaders)
+{
+    if (chess == NULL || leaders == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    if (tournament_id <= 0) {
+        return CHESS_INVALID_ID;
+    }
+    Shard *shard = getShard(chess, tournament_id);
+    lock(chess, &shard->lock);
+    Tournament* tournament = mapGet(shard->tournaments, &tournament_id);
+    if (tournament == NULL) {
+        unlock(chess, &shard->lock);
+        return CHESS_TOURNAMENT_NOT_EXIST;
+    }
+    if (!pageIn(chess, shard, tournament)) {
+        unlock(chess, &shard->lock);
+        return CHESS_OUT_OF_MEMORY;
+    }
+    int count = tournamentGetLeaders(tournament, k, leaders);
+    useFrozen(chess, shard, tournament);
+    unlock(chess, &shard->lock);
+    for (int i = count; i < k; i++) {
+        leaders[i] = NO_LEADER;
+    }
     return CHESS_SUCCESS;
 }
+
 double chessCalculateAveragePlayTime (ChessSystem chess, int player_id, ChessResult* chess_result)
 {
     if(chess == NULL){
@@ -260,202 +866,1408 @@ double chessCalculateAveragePlayTime (ChessSystem chess, int player_id, ChessRes
         *chess_result =  CHESS_INVALID_ID;
         return NO_AVERAGE;
     }
-    int sum =0;
-    int count=0;
-    MAP_FOREACH(int *,iter,chess->tournaments){
-        Tournament* curr_tournament=(Tournament*)mapGet(chess->tournaments,iter);
-        if(mapContains(curr_tournament->players_stats, &player_id)){
-            int *data=mapGet(curr_tournament->players_stats, &player_id);
-            sum += data[TIME_PLAYED];
-            count += data[WINS] + data[LOSSES] + data[DRAWS];
-        }
-        free(iter);
+    int player = playerDirectoryFind(chess->players, player_id);
+    if (player == PLAYER_DIRECTORY_NOT_FOUND) {
+        *chess_result = CHESS_PLAYER_NOT_EXIST;
+        return NO_AVERAGE;
     }
+    //The games and their time are read together in one word, which every game changes at once
+    int count, time_played;
+    playerDirectoryGetPlayed(chess->players, player, &count, &time_played);
     if(!count){
         *chess_result = CHESS_PLAYER_NOT_EXIST;
         return NO_AVERAGE;
     }
     *chess_result = CHESS_SUCCESS;
-    return ((double)sum)/count;
+    return ((double)time_played)/count;
 }
 ChessResult chessSavePlayersLevels (ChessSystem chess, FILE* file)
 {
     if(chess == NULL || file == NULL){
         return CHESS_NULL_ARGUMENT;
     }
-    ChessResult chess_result;
-    Map players_ranked=computePlayersRank(chess, &chess_result);
-    if(chess_result == CHESS_OUT_OF_MEMORY){
-    return CHESS_OUT_OF_MEMORY;
-    }
-    printToFile(players_ranked, file, &chess_result);
-    if(chess_result == CHESS_SAVE_FAILURE){
-        return CHESS_SAVE_FAILURE;
+    ChessReadSnapshot snapshot = chessAcquireSnapshot(chess);
+    if (snapshot == NULL) {
+        return CHESS_OUT_OF_MEMORY;
     }
-    mapDestroy(players_ranked);
-    return CHESS_SUCCESS;
+    ChessResult result = chessSnapshotSavePlayersLevels(snapshot, file);
+    chessReleaseSnapshot(snapshot);
+    return result;
 }
-static void printToFile(Map players_ranked, FILE* file, ChessResult* result)
+
+ChessResult chessSavePlayersLevelsTopK (ChessSystem chess, FILE* file, int k)
 {
-    int id=-1;
-    while(mapGetSize(players_ranked) > 0)
-    {
-        double curr_max = FindMaxData(players_ranked, &id);
-        assert(id != -1);
-        if (fprintf(file, "%d %0.2f\n",id, curr_max) < 0) {
-            *result = CHESS_SAVE_FAILURE;
-            return;
-        }
+    if(chess == NULL || file == NULL){
+        return CHESS_NULL_ARGUMENT;
+    }
+    ChessReadSnapshot snapshot = chessAcquireSnapshot(chess);
+    if (snapshot == NULL) {
+        return CHESS_OUT_OF_MEMORY;
     }
+    ChessResult result = chessSnapshotSavePlayersLevelsTopK(snapshot, file, k);
+    chessReleaseSnapshot(snapshot);
+    return result;
 }
-static double FindMaxData(Map players_ranked, int *id)
+
+ChessResult chessSnapshotSavePlayersLevels(ChessReadSnapshot snapshot, FILE* file)
 {
-    assert(players_ranked != NULL);
-    int *first_id = (int*)mapGetFirst(players_ranked); //Initiallize first max to the first player
-    double max = *(double*)mapGet(players_ranked, first_id); 
-    int maxid = *first_id;
-    free(first_id);
-    MAP_FOREACH(int *,iter,players_ranked){
-        double* level = (double*)mapGet(players_ranked, iter);
-        if(*level > max){
-            max = *level;
-            maxid = *iter;
-        }
-        free(iter);
+    if (snapshot == NULL || file == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    const ReadView *view = snapshot->view;
+    size_t levels_size = sizeof(PlayerLevel) * (view->players_count + 1);
+    PlayerLevel *levels = allocatorAllocate(view->allocator, levels_size);
+    if (levels == NULL) {
+        return CHESS_OUT_OF_MEMORY;
     }
-    mapRemove(players_ranked, &maxid);
-    *id = maxid;
-    return max;
+    computeSortedLevels(view, snapshot->export_threads, levels);
+    ChessResult result = printToFile(levels, view->players_count, file);
+    allocatorFree(view->allocator, levels, levels_size);
+    return result;
 }
-static Map computePlayersRank(ChessSystem chess, ChessResult* chess_result)
+
+ChessResult chessSnapshotSavePlayersLevelsTopK(ChessReadSnapshot snapshot, FILE* file, int k)
 {
-    Map players_ranked=mapCreate(copyDouble, copyKeyInt, freeDouble, freeInt ,compareInts);
-    if(players_ranked == NULL){
-        *chess_result = CHESS_OUT_OF_MEMORY;
-        return NULL;
+    if (snapshot == NULL || file == NULL) {
+        return CHESS_NULL_ARGUMENT;
     }
-    Map players_games_count=mapCreate(copyKeyInt, copyKeyInt, freeInt, freeInt ,compareInts);
-    if(players_games_count == NULL){
-        *chess_result = CHESS_OUT_OF_MEMORY;
-        mapDestroy(players_ranked);
-        return NULL;
+    const ReadView *view = snapshot->view;
+    int max_count = k < view->players_count ? k : view->players_count;
+    if (max_count <= 0) {
+        return CHESS_SUCCESS;
     }
-    MAP_FOREACH(int *,iter_tournaments,chess->tournaments){
-        Tournament* curr_tournament=(Tournament*)mapGet(chess->tournaments,iter_tournaments);
-        MAP_FOREACH(int *,iter_players,curr_tournament->players_stats){
-            int *data=mapGet(curr_tournament->players_stats, iter_players);
-            int num_games = data[WINS] + data[LOSSES] + data[DRAWS];
-            if (num_games == 0) {
-                free(iter_players);
-                continue; //Deleted player - no games played
-            }
-            double rank = (double)(6 * data[WINS] - 10 * data[LOSSES] + 2 * data[DRAWS]);
-            if(mapContains(players_ranked,iter_players)){
-                double* curr_rank=mapGet(players_ranked,iter_players);
-                int* curr_games=mapGet(players_games_count,iter_players);
-                *curr_rank += rank;
-                *curr_games += num_games;
-            }
-            else{
-                if(mapPut(players_ranked,iter_players,&rank) != MAP_SUCCESS){
-                    mapDestroy(players_ranked);
-                    mapDestroy(players_games_count);
-                    *chess_result = CHESS_OUT_OF_MEMORY;//It has to be memory error because iter_players and rank aren't NULL
-                    free(iter_players);
-                    free(iter_tournaments);
-                    return NULL;
-                }
-                if(mapPut(players_games_count,iter_players,&num_games) != MAP_SUCCESS){
-                    mapDestroy(players_ranked);
-                    mapDestroy(players_games_count);
-                    *chess_result = CHESS_OUT_OF_MEMORY;//It has to be memory error because iter_players and rank aren't NULL
-                    free(iter_players);
-                    free(iter_tournaments);
-                    return NULL;
-                }
-            }
-            free(iter_players);
-        }
-        free(iter_tournaments);
+    PlayerLevel *heap = allocatorAllocate(view->allocator, sizeof(PlayerLevel) * max_count);
+    if(heap == NULL){
+        return CHESS_OUT_OF_MEMORY;
     }
-    *chess_result = CHESS_SUCCESS;
-    MAP_FOREACH(int *,iter_players,players_ranked){
-        double *rank=mapGet(players_ranked, iter_players);
-        int *num_of_games=mapGet(players_games_count, iter_players);
-        *rank = *rank / *num_of_games;
-        free(iter_players);
+    //The root of the heap is the lowest ranked of the k best players found so far
+    int count = 0;
+    PlayerLevel level;
+    for (int player = 0; player < view->players_count; player++) {
+        computePlayerLevel(&view->players[player], &level);
+        if (count < max_count) {
+            heap[count] = level;
+            siftLevelUp(heap, count++);
+        }
+        else if (comparePlayerLevels(&level, &heap[0]) < 0) {
+            heap[0] = level;
+            siftLevelDown(heap, count, 0);
+        }
     }
-    mapDestroy(players_games_count);
-    return players_ranked;
+    qsort(heap, count, sizeof(PlayerLevel), comparePlayerLevels);
+    ChessResult result = printToFile(heap, count, file);
+    allocatorFree(view->allocator, heap, sizeof(PlayerLevel) * max_count);
+    return result;
 }
 
-ChessResult chessSaveTournamentStatistics (ChessSystem chess, char* path_file)
+ChessResult chessSetExportThreads(ChessSystem chess, int threads)
 {
-    if (chess == NULL || path_file == NULL) {
+    if (chess == NULL) {
         return CHESS_NULL_ARGUMENT;
     }
-    FILE *file = fopen(path_file, "w");
-    if (file == NULL) {
-        return CHESS_SAVE_FAILURE;
+    threads = threads < 1 ? 1 : threads > MAX_EXPORT_THREADS ? MAX_EXPORT_THREADS : threads;
+    __atomic_store_n(&chess->export_threads, threads, __ATOMIC_RELAXED);
+    return CHESS_SUCCESS;
+}
+
+/*
+ * Each thread computes and sorts the levels of a range of the view's players, and the sorted runs are merged.
+ * The levels are computed the same way and the order is total, so the result is the same for any number of
+ * threads. All the players of a view have games, so every one of them gets a level.
+ */
+static void computeSortedLevels(const ReadView* view, int export_threads, PlayerLevel* levels)
+{
+    int players_count = view->players_count;
+    int threads = players_count / MIN_PLAYERS_PER_THREAD;
+    threads = threads < export_threads ? threads : export_threads;
+    LevelsRun *runs = NULL;
+    PlayerLevel *runs_levels = NULL;
+    if (threads > 1) {
+        runs = allocatorAllocate(view->allocator, sizeof(LevelsRun) * threads);
+        runs_levels = allocatorAllocate(view->allocator, sizeof(PlayerLevel) * players_count);
     }
-    int count_ended_tournaments = 0;
-    ChessResult result;
-    MAP_FOREACH(int*, iter, chess->tournaments) {
-        Tournament* tournament=mapGet(chess->tournaments, iter);
-        if (tournament->winner == TOURNAMENT_NOT_ENDED) {
-            free(iter);
-            continue;
-        }
-        count_ended_tournaments++;
-        result = printTournamnentStats(tournament, file);
-        if (result == CHESS_SAVE_FAILURE) {
-            fclose(file);
-            free(iter);
-            return result;
-        }
-        free(iter);
-    }
-    fclose(file);
-    if (count_ended_tournaments == 0) {
-        return CHESS_NO_TOURNAMENTS_ENDED;
+    if (runs == NULL || runs_levels == NULL) {
+        allocatorFree(view->allocator, runs, sizeof(LevelsRun) * threads);
+        allocatorFree(view->allocator, runs_levels, sizeof(PlayerLevel) * players_count);
+        LevelsRun run = {view->players, 0, players_count, levels};
+        computeLevelsRun(&run);
+        return;
     }
-    return CHESS_SUCCESS;
+    for (int i = 0; i < threads; i++) {
+        LevelsRun run = {view->players, (int)((long long)players_count * i / threads),
+                         (int)((long long)players_count * (i + 1) / threads), NULL};
+        run.levels = runs_levels + run.first;
+        runs[i] = run;
+    }
+    runInParallel(computeLevelsRun, runs, threads, sizeof(LevelsRun));
+    mergeLevelsRuns(runs, threads, levels);
+    allocatorFree(view->allocator, runs, sizeof(LevelsRun) * threads);
+    allocatorFree(view->allocator, runs_levels, sizeof(PlayerLevel) * players_count);
 }
 
-static ChessResult printTournamnentStats(Tournament* tournament, FILE* file)
+static void* computeLevelsRun(void* argument)
 {
-    assert(tournament != NULL);
-    assert(file != NULL);
-    if (fprintf(file, "%d\n",tournament->winner) < 0) {
-        return CHESS_SAVE_FAILURE;
-    } 
-    double avg_game_time;
-    int longest_game = computeGamesStats(tournament->games, &avg_game_time);
-    if (fprintf(file, "%d\n%0.2f\n",longest_game, avg_game_time) < 0) {
-        return CHESS_SAVE_FAILURE;
+    LevelsRun *run = argument;
+    for (int player = run->first; player < run->end; player++) {
+        computePlayerLevel(&run->players[player], &run->levels[player - run->first]);
+    }
+    qsort(run->levels, run->end - run->first, sizeof(PlayerLevel), comparePlayerLevels);
+    return NULL;
+}
+
+//There are only a few runs, so the next level is the best of their heads. The runs are consumed.
+static void mergeLevelsRuns(LevelsRun* runs, int runs_count, PlayerLevel* levels)
+{
+    int count = 0;
+    while (true) {
+        LevelsRun *best = NULL;
+        for (int i = 0; i < runs_count; i++) {
+            if (runs[i].first < runs[i].end &&
+                (best == NULL || comparePlayerLevels(runs[i].levels, best->levels) < 0)) {
+                best = &runs[i];
+            }
+        }
+        if (best == NULL) {
+            return;
+        }
+        levels[count++] = *best->levels++;
+        best->first++;
     }
-    if (fprintf(file, "%s\n",tournament->location) < 0) {
-        return CHESS_SAVE_FAILURE;
-    } 
-    if (fprintf(file, "%d\n",mapGetSize(tournament->games)) < 0) {
-        return CHESS_SAVE_FAILURE;
-    } 
-    if (fprintf(file, "%d\n",mapGetSize(tournament->players_stats)) < 0) {
-        return CHESS_SAVE_FAILURE;
-    } 
-    return CHESS_SUCCESS;
 }
 
-static int computeGamesStats(Map games, double* avg_game_time) {
-    int max = 0, sum_duartion = 0;
-    MAP_FOREACH(int*, iter, games) {
-        Game* game=mapGet(games, iter);
-        sum_duartion += game->duration;
-        if (game->duration > max) {
-            max = game->duration;
+/*
+ * Calls work on each of the count arguments, which are argument_size bytes apart. The first is worked on by the
+ * calling thread, and so is any argument that a thread could not be started for.
+ */
+static void runInParallel(void* (*work)(void*), void* arguments, int count, size_t argument_size)
+{
+    assert(count <= MAX_EXPORT_THREADS);
+    pthread_t threads[MAX_EXPORT_THREADS];
+    bool started[MAX_EXPORT_THREADS];
+    char *argument = arguments;
+    for (int i = 1; i < count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, work, argument + i * argument_size) == 0;
+    }
+    work(arguments);
+    for (int i = 1; i < count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        else {
+            work(argument + i * argument_size);
         }
-        free(iter);
     }
-    *avg_game_time = ((double)sum_duartion) / mapGetSize(games);
-    return max;
+}
+
+static ChessResult printToFile(const PlayerLevel* levels, int count, FILE* file)
+{
+    OutputBuffer buffer;
+    outputBufferInit(&buffer, file);
+    for (int i = 0; i < count; i++) {
+        outputBufferWriteInt(&buffer, levels[i].player_id);
+        outputBufferWriteChar(&buffer, ' ');
+        outputBufferWriteFixed2(&buffer, levels[i].level);
+        outputBufferWriteChar(&buffer, '\n');
+    }
+    return outputBufferFlush(&buffer) ? CHESS_SUCCESS : CHESS_SAVE_FAILURE;
+}
+
+//Higher levels come first, players with the same level are ordered by id.
+static int comparePlayerLevels(const void* first, const void* second)
+{
+    const PlayerLevel *first_level = first, *second_level = second;
+    if (first_level->level != second_level->level) {
+        return first_level->level > second_level->level ? -1 : 1;
+    }
+    return first_level->player_id - second_level->player_id;
+}
+
+static void computePlayerLevel(const PlayerTotals* totals, PlayerLevel* level)
+{
+    int num_games = totals->wins + totals->losses + totals->draws;
+    assert(num_games > 0);
+    level->player_id = totals->player_id;
+    level->level = (6.0 * totals->wins - 10.0 * totals->losses + 2.0 * totals->draws) / num_games;
+}
+
+static void siftLevelUp(PlayerLevel* heap, int index)
+{
+    while (index > 0 && comparePlayerLevels(&heap[(index - 1) / 2], &heap[index]) < 0) {
+        PlayerLevel parent = heap[(index - 1) / 2];
+        heap[(index - 1) / 2] = heap[index];
+        heap[index] = parent;
+        index = (index - 1) / 2;
+    }
+}
+
+static void siftLevelDown(PlayerLevel* heap, int size, int index)
+{
+    while (2 * index + 1 < size) {
+        int child = 2 * index + 1;
+        if (child + 1 < size && comparePlayerLevels(&heap[child + 1], &heap[child]) > 0) {
+            child++;
+        }
+        if (comparePlayerLevels(&heap[index], &heap[child]) >= 0) {
+            return;
+        }
+        PlayerLevel parent = heap[index];
+        heap[index] = heap[child];
+        heap[child] = parent;
+        index = child;
+    }
+}
+
+ChessResult chessSaveTournamentStatistics (ChessSystem chess, char* path_file)
+{
+    if (chess == NULL || path_file == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    ChessReadSnapshot snapshot = chessAcquireSnapshot(chess);
+    if (snapshot == NULL) {
+        return CHESS_OUT_OF_MEMORY;
+    }
+    ChessResult result = chessSnapshotSaveTournamentStatistics(snapshot, path_file);
+    chessReleaseSnapshot(snapshot);
+    return result;
+}
+
+ChessResult chessSnapshotSaveTournamentStatistics(ChessReadSnapshot snapshot, const char* path_file)
+{
+    if (snapshot == NULL || path_file == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    FILE *file = fopen(path_file, "w");
+    if (file == NULL) {
+        return CHESS_SAVE_FAILURE;
+    }
+    bool written = printStatistics(snapshot->view, snapshot->export_threads, file);
+    if (fclose(file) != 0 || !written) {
+        return CHESS_SAVE_FAILURE;
+    }
+    if (snapshot->view->tournaments_count == 0) {
+        return CHESS_NO_TOURNAMENTS_ENDED;
+    }
+    return CHESS_SUCCESS;
+}
+
+ChessReadSnapshot chessAcquireSnapshot(ChessSystem chess)
+{
+    if (chess == NULL) {
+        return NULL;
+    }
+    ChessReadSnapshot snapshot = allocatorAllocate(chess->allocator, sizeof(*snapshot));
+    if (snapshot == NULL) {
+        return NULL;
+    }
+    snapshot->allocator = chess->allocator;
+    snapshot->export_threads = __atomic_load_n(&chess->export_threads, __ATOMIC_RELAXED);
+    lock(chess, &chess->view_lock);
+    //The versions only grow, so the epoch of the latest view is only reached again if no shard has changed
+    long long epoch = 0;
+    for (int i = 0; i < chess->shards_count; i++) {
+        epoch += __atomic_load_n(&chess->shards[i].version, __ATOMIC_RELAXED);
+    }
+    if (chess->latest_view == NULL || chess->latest_view->epoch != epoch) {
+        ReadView *view = buildView(chess);
+        if (view == NULL) {
+            unlock(chess, &chess->view_lock);
+            allocatorFree(chess->allocator, snapshot, sizeof(*snapshot));
+            return NULL;
+        }
+        releaseView(chess->latest_view);
+        chess->latest_view = view;
+    }
+    //The system holds the latest view until it is replaced under this lock, so it is still referenced
+    __atomic_fetch_add(&chess->latest_view->references, 1, __ATOMIC_RELAXED);
+    snapshot->view = chess->latest_view;
+    unlock(chess, &chess->view_lock);
+    return snapshot;
+}
+
+void chessReleaseSnapshot(ChessReadSnapshot snapshot)
+{
+    if (snapshot != NULL) {
+        releaseView(snapshot->view);
+        allocatorFree(snapshot->allocator, snapshot, sizeof(*snapshot));
+    }
+}
+
+/*
+ * The caller holds the view lock. The shards are copied one at a time, each under its own lock. The lock of the
+ * next shard is taken before the lock of the previous one is released, so an operation that holds all the shard
+ * locks falls wholly before or after the view. Returns NULL if an allocation failed.
+ */
+static ReadView* buildView(ChessSystem chess)
+{
+    ReadView *view = allocatorAllocate(chess->allocator, sizeof(*view));
+    if (view == NULL) {
+        return NULL;
+    }
+    view->allocator = chess->allocator;
+    view->epoch = 0;
+    view->references = 1;
+    view->shards_count = 0;
+    view->players = NULL;
+    view->players_count = 0;
+    view->players_max_count = 0;
+    view->tournaments = NULL;
+    view->tournaments_count = 0;
+    view->shards = allocatorAllocate(chess->allocator, sizeof(ShardView*) * chess->shards_count);
+    if (view->shards == NULL) {
+        releaseView(view);
+        return NULL;
+    }
+    view->shards_count = chess->shards_count;
+    memset(view->shards, 0, sizeof(ShardView*) * view->shards_count);
+    int shard = 0;
+    lock(chess, &chess->shards[shard].lock);
+    bool built = addShardView(chess, shard, chess->latest_view, view);
+    while (built && shard + 1 < chess->shards_count) {
+        lock(chess, &chess->shards[shard + 1].lock);
+        unlock(chess, &chess->shards[shard].lock);
+        shard++;
+        built = addShardView(chess, shard, chess->latest_view, view);
+    }
+    unlock(chess, &chess->shards[shard].lock);
+    if (!built || !mergeShardViews(chess, view)) {
+        releaseView(view);
+        return NULL;
+    }
+    return view;
+}
+
+//The caller holds the lock of the shard. A shard that did not change since the previous view is shared with it.
+static bool addShardView(ChessSystem chess, int shard, const ReadView* previous, ReadView* view)
+{
+    ShardView *shard_view;
+    if (previous != NULL && previous->shards[shard]->version == chess->shards[shard].version) {
+        shard_view = previous->shards[shard];
+        __atomic_fetch_add(&shard_view->references, 1, __ATOMIC_RELAXED);
+    }
+    else {
+        shard_view = copyShard(chess, &chess->shards[shard]);
+        if (shard_view == NULL) {
+            return false;
+        }
+    }
+    view->shards[shard] = shard_view;
+    view->epoch += shard_view->version;
+    return true;
+}
+
+//The caller holds the lock of the shard. Returns NULL if an allocation failed.
+static ShardView* copyShard(ChessSystem chess, Shard* shard)
+{
+    ShardView *shard_view = allocatorAllocate(chess->allocator, sizeof(*shard_view));
+    if (shard_view == NULL) {
+        return NULL;
+    }
+    shard_view->references = 1;
+    shard_view->version = shard->version;
+    shard_view->rows_count = totalsTableGetSize(shard->totals);
+    shard_view->tournaments = NULL;
+    shard_view->tournaments_count = 0;
+    shard_view->tournaments_max_count = 0;
+    shard_view->names = NULL;
+    shard_view->names_length = 0;
+    shard_view->names_size = 0;
+    shard_view->rows = allocatorAllocate(chess->allocator, sizeof(TotalsRow) * (shard_view->rows_count + 1));
+    if (shard_view->rows == NULL) {
+        releaseShardView(chess->allocator, shard_view);
+        return NULL;
+    }
+    memcpy(shard_view->rows, totalsTableGetRows(shard->totals), sizeof(TotalsRow) * shard_view->rows_count);
+    int visited = 0;
+    MAP_FOREACH(int*, iter, shard->tournaments) {
+        const Tournament *tournament = mapGet(shard->tournaments, iter);
+        bool copied = tournament->winner == TOURNAMENT_NOT_ENDED ||
+                      appendSummary(chess, shard_view, *iter, tournament);
+        freeTournamentKey(iter);
+        if (!copied) {
+            releaseShardView(chess->allocator, shard_view);
+            return NULL;
+        }
+        visited++;
+    }
+    if (visited < mapGetSize(shard->tournaments)) {
+        releaseShardView(chess->allocator, shard_view);
+        return NULL; //Copying a key failed
+    }
+    return shard_view;
+}
+
+//The name of the location is copied too, so the view does not depend on the system.
+static bool appendSummary(ChessSystem chess, ShardView* shard_view, int tournament_id, const Tournament* tournament)
+{
+    if (shard_view->tournaments_count == shard_view->tournaments_max_count) {
+        int new_size = shard_view->tournaments_max_count == 0 ? VIEW_INIT_SIZE :
+                       VIEW_EXPAND_FACTOR * shard_view->tournaments_max_count;
+        TournamentSummary *tournaments = allocatorReallocate(chess->allocator, shard_view->tournaments,
+                                                             sizeof(TournamentSummary) *
+                                                             shard_view->tournaments_max_count,
+                                                             sizeof(TournamentSummary) * new_size);
+        if (tournaments == NULL) {
+            return false;
+        }
+        shard_view->tournaments = tournaments;
+        shard_view->tournaments_max_count = new_size;
+    }
+    const char *location = locationGetName(tournament->location);
+    size_t length = strlen(location) + 1;
+    if (shard_view->names_length + length > shard_view->names_size) {
+        size_t new_size = VIEW_EXPAND_FACTOR * shard_view->names_size + length;
+        char *names = allocatorReallocate(chess->allocator, shard_view->names, shard_view->names_size, new_size);
+        if (names == NULL) {
+            return false;
+        }
+        shard_view->names = names;
+        shard_view->names_size = new_size;
+    }
+    TournamentSummary summary = {tournament_id, tournament->winner, tournament->longest_game,
+                                 ((double)tournament->total_game_time) / tournament->games_count,
+                                 tournament->games_count, tournament->players_count, shard_view->names_length};
+    shard_view->tournaments[shard_view->tournaments_count++] = summary;
+    memcpy(shard_view->names + shard_view->names_length, location, length);
+    shard_view->names_length += length;
+    return true;
+}
+
+/*
+ * Sums the totals of the shard views into the players of the view, indexed by slot, and orders the tournaments
+ * of all of them by id. No shard lock is held, the shard views do not change.
+ */
+static bool mergeShardViews(ChessSystem chess, ReadView* view)
+{
+    //The players of the shards were added to the directory before their rows, so their slots are in range
+    view->players_count = playerDirectoryGetSize(chess->players);
+    view->players_max_count = view->players_count + 1;
+    view->players = allocatorAllocate(chess->allocator, sizeof(PlayerTotals) * view->players_max_count);
+    for (int i = 0; i < view->shards_count; i++) {
+        view->tournaments_count += view->shards[i]->tournaments_count;
+    }
+    view->tournaments = allocatorAllocate(chess->allocator, sizeof(ViewTournament) * (view->tournaments_count + 1));
+    if (view->players == NULL || view->tournaments == NULL) {
+        return false;
+    }
+    memset(view->players, 0, sizeof(PlayerTotals) * view->players_count);
+    int tournaments_count = 0;
+    for (int i = 0; i < view->shards_count; i++) {
+        const ShardView *shard_view = view->shards[i];
+        for (int row = 0; row < shard_view->rows_count; row++) {
+            const TotalsRow *totals_row = &shard_view->rows[row];
+            PlayerTotals *totals = &view->players[totals_row->player_slot];
+            totals->wins += totals_row->wins;
+            totals->losses += totals_row->losses;
+            totals->draws += totals_row->draws;
+            totals->time_played += totals_row->time_played;
+        }
+        for (int tournament = 0; tournament < shard_view->tournaments_count; tournament++) {
+            const TournamentSummary *summary = &shard_view->tournaments[tournament];
+            ViewTournament view_tournament = {summary, shard_view->names + summary->location_offset};
+            view->tournaments[tournaments_count++] = view_tournament;
+        }
+    }
+    //Every shard is already sorted by id
+    if (view->shards_count > 1) {
+        qsort(view->tournaments, view->tournaments_count, sizeof(ViewTournament), compareViewTournaments);
+    }
+    compactViewPlayers(chess, view);
+    return true;
+}
+
+//Only players with games are kept, the others have no level. Their order by slot is kept.
+static void compactViewPlayers(ChessSystem chess, ReadView* view)
+{
+    int count = 0;
+    for (int player = 0; player < view->players_count; player++) {
+        PlayerTotals totals = view->players[player];
+        if (totals.wins + totals.losses + totals.draws > 0) {
+            totals.player_id = playerDirectoryGet(chess->players, player)->player_id;
+            view->players[count++] = totals;
+        }
+    }
+    view->players_count = count;
+}
+
+static int compareViewTournaments(const void* first, const void* second)
+{
+    const ViewTournament *first_tournament = first, *second_tournament = second;
+    return compareInts((MapKeyElement)&first_tournament->summary->tournament_id,
+                       (MapKeyElement)&second_tournament->summary->tournament_id);
+}
+
+//Drops a reference to a view, and frees it if that was the last one. A NULL view is ignored.
+static void releaseView(ReadView* view)
+{
+    if (view != NULL && __atomic_sub_fetch(&view->references, 1, __ATOMIC_ACQ_REL) == 0) {
+        const ChessAllocator *allocator = view->allocator;
+        for (int i = 0; i < view->shards_count; i++) {
+            releaseShardView(allocator, view->shards[i]);
+        }
+        allocatorFree(allocator, view->shards, sizeof(ShardView*) * view->shards_count);
+        allocatorFree(allocator, view->players, sizeof(PlayerTotals) * view->players_max_count);
+        allocatorFree(allocator, view->tournaments, sizeof(ViewTournament) * (view->tournaments_count + 1));
+        allocatorFree(allocator, view, sizeof(*view));
+    }
+}
+
+//The views that share a shard view release it from any thread, so its references are atomic. NULL is ignored.
+static void releaseShardView(const ChessAllocator* allocator, ShardView* shard_view)
+{
+    if (shard_view != NULL && __atomic_sub_fetch(&shard_view->references, 1, __ATOMIC_ACQ_REL) == 0) {
+        allocatorFree(allocator, shard_view->rows, sizeof(TotalsRow) * (shard_view->rows_count + 1));
+        allocatorFree(allocator, shard_view->tournaments,
+                      sizeof(TournamentSummary) * shard_view->tournaments_max_count);
+        allocatorFree(allocator, shard_view->names, shard_view->names_size);
+        allocatorFree(allocator, shard_view, sizeof(*shard_view));
+    }
+}
+
+ChessResult chessSetBackgroundReclaim(ChessSystem chess, bool enabled)
+{
+    if (chess == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    ChessResult result = CHESS_SUCCESS;
+    Reclaimer stopped = NULL;
+    lockAllShards(chess);
+    if (enabled && chess->reclaimer == NULL) {
+        chess->reclaimer = reclaimerCreate(destroyArena);
+        result = chess->reclaimer == NULL ? CHESS_OUT_OF_MEMORY : CHESS_SUCCESS;
+    }
+    else if (!enabled) {
+        stopped = chess->reclaimer;
+        chess->reclaimer = NULL;
+    }
+    unlockAllShards(chess);
+    reclaimerDestroy(stopped); //Waits for the tournaments that were handed to it
+    return result;
+}
+
+ChessResult chessSetFreezeEndedTournaments(ChessSystem chess, bool enabled)
+{
+    if (chess == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    ChessResult result = CHESS_SUCCESS;
+    lockAllShards(chess);
+    chess->freeze_ended = enabled;
+    for (int i = 0; enabled && i < chess->shards_count; i++) {
+        Map tournaments = chess->shards[i].tournaments;
+        int visited = 0;
+        MAP_FOREACH(int*, iter, tournaments) {
+            Tournament *tournament = mapGet(tournaments, iter);
+            if (tournament->winner != TOURNAMENT_NOT_ENDED && !tournament->frozen) {
+                if (tournamentFreeze(tournament)) {
+                    useFrozen(chess, &chess->shards[i], tournament);
+                }
+                else {
+                    result = CHESS_OUT_OF_MEMORY;
+                }
+            }
+            freeTournamentKey(iter);
+            visited++;
+        }
+        if (visited < mapGetSize(tournaments)) {
+            result = CHESS_OUT_OF_MEMORY; //Copying a key failed
+        }
+    }
+    unlockAllShards(chess);
+    return result;
+}
+
+ChessResult chessSetMemoryBudget(ChessSystem chess, size_t budget, const char* spill_path)
+{
+    if (chess == NULL || (budget > 0 && spill_path == NULL)) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    lockAllShards(chess);
+    if (!reloadAll(chess)) {
+        unlockAllShards(chess);
+        return CHESS_OUT_OF_MEMORY;
+    }
+    spillFileClose(chess->spill_file);
+    chess->spill_file = budget > 0 ? spillFileOpen(spill_path) : NULL;
+    if (chess->spill_file == NULL) {
+        unlockAllShards(chess);
+        return budget > 0 ? CHESS_SAVE_FAILURE : CHESS_SUCCESS;
+    }
+    chess->shard_budget = budget / chess->shards_count;
+    chess->freeze_ended = true;
+    //Freezes the ended tournaments, and spills the ones that are over the budget
+    ChessResult result = CHESS_SUCCESS;
+    for (int i = 0; i < chess->shards_count; i++) {
+        Map tournaments = chess->shards[i].tournaments;
+        int visited = 0;
+        MAP_FOREACH(int*, iter, tournaments) {
+            Tournament *tournament = mapGet(tournaments, iter);
+            if (tournament->winner != TOURNAMENT_NOT_ENDED && !tournamentFreeze(tournament)) {
+                result = CHESS_OUT_OF_MEMORY;
+            }
+            useFrozen(chess, &chess->shards[i], tournament);
+            freeTournamentKey(iter);
+            visited++;
+        }
+        if (visited < mapGetSize(tournaments)) {
+            result = CHESS_OUT_OF_MEMORY; //Copying a key failed
+        }
+    }
+    unlockAllShards(chess);
+    return result;
+}
+
+ChessResult chessGetSpillStats(ChessSystem chess, ChessSpillStats* stats)
+{
+    if (chess == NULL || stats == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    memset(stats, 0, sizeof(*stats));
+    lockAllShards(chess);
+    for (int i = 0; i < chess->shards_count; i++) {
+        const Shard *shard = &chess->shards[i];
+        stats->spills += shard->spill_stats.spills;
+        stats->reloads += shard->spill_stats.reloads;
+        stats->spilled_bytes += shard->spill_stats.spilled_bytes;
+        stats->reloaded_bytes += shard->spill_stats.reloaded_bytes;
+        stats->resident_bytes += shard->resident_bytes;
+    }
+    unlockAllShards(chess);
+    return CHESS_SUCCESS;
+}
+
+ChessGameIterator chessGameIteratorCreate(ChessSystem chess, int tournament_id, ChessResult* chess_result)
+{
+    if (chess == NULL) {
+        *chess_result = CHESS_NULL_ARGUMENT;
+        return NULL;
+    }
+    if (tournament_id <= 0) {
+        *chess_result = CHESS_INVALID_ID;
+        return NULL;
+    }
+    ChessGameIterator iterator = allocatorAllocate(chess->allocator, sizeof(*iterator));
+    if (iterator == NULL) {
+        *chess_result = CHESS_OUT_OF_MEMORY;
+        return NULL;
+    }
+    iterator->allocator = chess->allocator;
+    iterator->tournament_id = tournament_id;
+    Shard *shard = getShard(chess, tournament_id);
+    lock(chess, &shard->lock);
+    Tournament* tournament = mapGet(shard->tournaments, &tournament_id);
+    *chess_result = tournament == NULL ? CHESS_TOURNAMENT_NOT_EXIST : CHESS_SUCCESS;
+    if (tournament != NULL && !pageIn(chess, shard, tournament)) {
+        *chess_result = CHESS_OUT_OF_MEMORY;
+    }
+    else if (tournament != NULL) {
+        if (!openArchive(chess, tournament, iterator)) {
+            *chess_result = CHESS_OUT_OF_MEMORY;
+        }
+        useFrozen(chess, shard, tournament);
+    }
+    unlock(chess, &shard->lock);
+    if (*chess_result != CHESS_SUCCESS) {
+        allocatorFree(chess->allocator, iterator, sizeof(*iterator));
+        return NULL;
+    }
+    gameArchiveIteratorInit(&iterator->games, iterator->archive, iterator->games_count, 0);
+    return iterator;
+}
+
+/*
+ * Sets the archive of an iterator and the ids of the tournament's players by their slots. The archive of a frozen
+ * tournament never changes, so the iterator keeps a reference to its arena instead of a copy. The games of any
+ * other tournament are encoded for the iterator. Returns false, leaving nothing to free, if an allocation failed.
+ * The caller holds the lock of the tournament's shard.
+ */
+static bool openArchive(ChessSystem chess, const Tournament* tournament, ChessGameIterator iterator)
+{
+    iterator->players_count = tournament->players_count;
+    iterator->players = allocatorAllocate(chess->allocator, sizeof(IteratorPlayer) * iterator->players_count);
+    if (iterator->players == NULL && iterator->players_count > 0) {
+        return false;
+    }
+    iterator->games_count = tournament->games_count;
+    iterator->archive_size = tournamentGetArchiveSize(tournament);
+    if (tournament->frozen) {
+        arenaRetain(tournament->arena);
+        iterator->shared = tournament->arena;
+        iterator->archive = tournament->archive;
+    }
+    else {
+        unsigned char *archive = allocatorAllocate(chess->allocator, iterator->archive_size);
+        if (archive == NULL) {
+            allocatorFree(chess->allocator, iterator->players, sizeof(IteratorPlayer) * iterator->players_count);
+            return false;
+        }
+        tournamentWriteArchive(tournament, archive);
+        iterator->shared = NULL;
+        iterator->archive = archive;
+    }
+    //Every player in a game has stats, also one that was removed from the tournament after playing
+    for (int i = 0; i < iterator->players_count; i++) {
+        iterator->players[i].player_slot = tournament->players_stats[i].player_slot;
+        iterator->players[i].player_id = tournament->players_stats[i].player_id;
+    }
+    if (iterator->players_count > 1) {
+        qsort(iterator->players, iterator->players_count, sizeof(IteratorPlayer), compareIteratorPlayers);
+    }
+    return true;
+}
+
+//Returns the id of a player, who must be in the players, by the player's slot
+static int findIteratorPlayer(const IteratorPlayer* players, int players_count, int player_slot)
+{
+    int low = 0, high = players_count - 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (players[middle].player_slot < player_slot) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    assert(players_count > 0 && players[low].player_slot == player_slot);
+    return players[low].player_id;
+}
+
+static int compareIteratorPlayers(const void* first, const void* second)
+{
+    int first_slot = ((const IteratorPlayer*)first)->player_slot;
+    int second_slot = ((const IteratorPlayer*)second)->player_slot;
+    return (first_slot > second_slot) - (first_slot < second_slot);
+}
+
+bool chessGameIteratorNext(ChessGameIterator iterator, ChessGameRecord* game)
+{
+    return chessGameIteratorRead(iterator, game, 1) == 1;
+}
+
+size_t chessGameIteratorRead(ChessGameIterator iterator, ChessGameRecord* games, size_t count)
+{
+    if (iterator == NULL || games == NULL) {
+        return 0;
+    }
+    Game archived[GAME_ARCHIVE_BLOCK_GAMES];
+    size_t read = 0;
+    while (read < count) {
+        int batch = count - read < GAME_ARCHIVE_BLOCK_GAMES ? (int)(count - read) : GAME_ARCHIVE_BLOCK_GAMES;
+        batch = gameArchiveIteratorRead(&iterator->games, archived, batch);
+        if (batch == 0) {
+            break;
+        }
+        for (int i = 0; i < batch; i++, read++) {
+            ChessGameRecord *game = &games[read];
+            int first = archived[i].players_slot[0], second = archived[i].players_slot[1];
+            game->tournament_id = iterator->tournament_id;
+            game->first_player = first == TOURNAMENT_DELETED_PLAYER ? TOURNAMENT_DELETED_PLAYER :
+                                 findIteratorPlayer(iterator->players, iterator->players_count, first);
+            game->second_player = second == TOURNAMENT_DELETED_PLAYER ? TOURNAMENT_DELETED_PLAYER :
+                                  findIteratorPlayer(iterator->players, iterator->players_count, second);
+            game->winner = archived[i].result;
+            game->play_time = archived[i].duration;
+        }
+    }
+    return read;
+}
+
+void chessGameIteratorSeek(ChessGameIterator iterator, int index)
+{
+    if (iterator != NULL) {
+        gameArchiveIteratorInit(&iterator->games, iterator->archive, iterator->games_count, index);
+    }
+}
+
+//The shared arena may be the last reference to a tournament that was spilled or removed since
+void chessGameIteratorDestroy(ChessGameIterator iterator)
+{
+    if (iterator != NULL) {
+        if (iterator->shared != NULL) {
+            arenaDestroy(iterator->shared);
+        }
+        else {
+            allocatorFree(iterator->allocator, (unsigned char*)iterator->archive, iterator->archive_size);
+        }
+        allocatorFree(iterator->allocator, iterator->players, sizeof(IteratorPlayer) * iterator->players_count);
+        allocatorFree(iterator->allocator, iterator, sizeof(*iterator));
+    }
+}
+
+static void destroyArena(void* arena)
+{
+    arenaDestroy(arena);
+}
+
+//The arena of a removed or spilled tournament is destroyed by the reclaimer if there is one
+static void dropArena(ChessSystem chess, Arena arena)
+{
+    if (chess->reclaimer == NULL || !reclaimerAdd(chess->reclaimer, arena)) {
+        arenaDestroy(arena);
+    }
+}
+
+/*
+ * Maps the data of a spilled tournament back from the spill file, and puts it first in the frozen tournaments of
+ * its shard. Any other tournament is left as it is. Returns false if the tournament is still spilled.
+ * The caller holds the lock of the shard, and calls useFrozen once done with the tournament.
+ */
+static bool pageIn(ChessSystem chess, Shard* shard, Tournament* tournament)
+{
+    if (!tournament->spilled) {
+        return true;
+    }
+    size_t size = tournamentGetSpillSize(tournament);
+    SpillMapping mapping;
+    if (!spillFileMap(chess->spill_file, tournament->spill_offset, size, &mapping)) {
+        return false;
+    }
+    bool reloaded = tournamentReload(tournament, mapping.data);
+    spillFileUnmap(&mapping);
+    if (!reloaded) {
+        return false;
+    }
+    shard->spill_stats.reloads++;
+    shard->spill_stats.reloaded_bytes += size;
+    linkFrozen(shard, tournament);
+    return true;
+}
+
+//Marks a frozen tournament that is in memory as the most recently used of its shard, and spills the least recently
+//used ones until the shard is within its budget. Does nothing if there is no budget.
+static void useFrozen(ChessSystem chess, Shard* shard, Tournament* tournament)
+{
+    if (chess->spill_file == NULL || !tournament->frozen || tournament->spilled) {
+        return;
+    }
+    linkFrozen(shard, tournament);
+    while (shard->resident_bytes > chess->shard_budget && shard->lru_last != NULL) {
+        if (!spillTournament(chess, shard, shard->lru_last)) {
+            break; //Stays in memory until a later spill succeeds
+        }
+    }
+}
+
+//Puts a frozen tournament that is in memory first in the frozen tournaments of its shard
+static void linkFrozen(Shard* shard, Tournament* tournament)
+{
+    unlinkFrozen(shard, tournament);
+    tournament->lru_next = shard->lru_first;
+    if (shard->lru_first != NULL) {
+        shard->lru_first->lru_previous = tournament;
+    }
+    else {
+        shard->lru_last = tournament;
+    }
+    shard->lru_first = tournament;
+    tournament->lru_bytes = arenaGetFootprint(tournament->arena);
+    shard->resident_bytes += tournament->lru_bytes;
+}
+
+//Takes a tournament out of the frozen tournaments in memory of its shard, if it is in them
+static void unlinkFrozen(Shard* shard, Tournament* tournament)
+{
+    if (tournament->lru_previous == NULL && shard->lru_first != tournament) {
+        return;
+    }
+    if (tournament->lru_previous != NULL) {
+        tournament->lru_previous->lru_next = tournament->lru_next;
+    }
+    else {
+        shard->lru_first = tournament->lru_next;
+    }
+    if (tournament->lru_next != NULL) {
+        tournament->lru_next->lru_previous = tournament->lru_previous;
+    }
+    else {
+        shard->lru_last = tournament->lru_previous;
+    }
+    tournament->lru_previous = NULL;
+    tournament->lru_next = NULL;
+    shard->resident_bytes -= tournament->lru_bytes;
+    tournament->lru_bytes = 0;
+}
+
+/*
+ * Writes the data of a frozen tournament to the spill file and drops its arena. A frozen tournament never changes,
+ * so one that was spilled before is not written again. Returns false, leaving the tournament in memory, if the
+ * data could not be written.
+ */
+static bool spillTournament(ChessSystem chess, Shard* shard, Tournament* tournament)
+{
+    long long offset = tournament->spill_offset;
+    if (offset < 0) {
+        size_t size = tournamentGetSpillSize(tournament);
+        unsigned char *data = allocatorAllocate(chess->allocator, size);
+        if (data == NULL) {
+            return false;
+        }
+        tournamentWriteSpill(tournament, data);
+        bool written = spillFileWrite(chess->spill_file, data, size, &offset);
+        allocatorFree(chess->allocator, data, size);
+        if (!written) {
+            return false;
+        }
+        shard->spill_stats.spilled_bytes += size;
+    }
+    unlinkFrozen(shard, tournament);
+    dropArena(chess, tournamentSpill(tournament, offset));
+    shard->spill_stats.spills++;
+    return true;
+}
+
+//Maps back every spilled tournament, and then forgets the frozen tournaments in memory and where in the spill file
+//they were. The caller holds all the shard locks. Returns false, leaving the rest as it was, if a tournament could
+//not be mapped back.
+static bool reloadAll(ChessSystem chess)
+{
+    bool reloaded = true;
+    for (int i = 0; i < chess->shards_count; i++) {
+        Shard *shard = &chess->shards[i];
+        int visited = 0;
+        MAP_FOREACH(int*, iter, shard->tournaments) {
+            reloaded = pageIn(chess, shard, mapGet(shard->tournaments, iter)) && reloaded;
+            freeTournamentKey(iter);
+            visited++;
+        }
+        reloaded = reloaded && visited == mapGetSize(shard->tournaments); //Unless copying a key failed
+    }
+    //Every tournament that was spilled is in memory now, so it is in the lru of its shard. Walking the lru does
+    //not copy keys, so it can not fail halfway.
+    for (int i = 0; reloaded && i < chess->shards_count; i++) {
+        Shard *shard = &chess->shards[i];
+        while (shard->lru_first != NULL) {
+            Tournament *tournament = shard->lru_first;
+            unlinkFrozen(shard, tournament);
+            tournament->spill_offset = -1;
+        }
+    }
+    return reloaded;
+}
+
+ChessResult chessGetTournamentBytesInUse(ChessSystem chess, int tournament_id, size_t* bytes_in_use)
+{
+    if (bytes_in_use == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    ChessMemoryUsage usage;
+    ChessResult result = chessGetMemoryUsage(chess, tournament_id, &usage);
+    if (result == CHESS_SUCCESS) {
+        *bytes_in_use = usage.bytes;
+    }
+    return result;
+}
+
+ChessResult chessGetMemoryUsage(ChessSystem chess, int tournament_id, ChessMemoryUsage* usage)
+{
+    if (chess == NULL || usage == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    if (tournament_id <= 0) {
+        return CHESS_INVALID_ID;
+    }
+    Shard *shard = getShard(chess, tournament_id);
+    lock(chess, &shard->lock);
+    Tournament* tournament = mapGet(shard->tournaments, &tournament_id);
+    if (tournament != NULL) {
+        tournamentGetMemoryUsage(tournament, &usage->bytes, &usage->objects);
+    }
+    unlock(chess, &shard->lock);
+    return tournament == NULL ? CHESS_TOURNAMENT_NOT_EXIST : CHESS_SUCCESS;
+}
+
+ChessResult chessOpenJournal(ChessSystem chess, const char* path, int sync_batch)
+{
+    if (chess == NULL || path == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    //No change can be journaled while the journal is replaced
+    lockAllShards(chess);
+    bool closed = closeJournal(chess);
+    if (closed) {
+        chess->journal = journalOpen(path, sync_batch > 0 ? sync_batch : 0);
+    }
+    unlockAllShards(chess);
+    return closed && chess->journal != NULL ? CHESS_SUCCESS : CHESS_SAVE_FAILURE;
+}
+
+ChessResult chessCloseJournal(ChessSystem chess)
+{
+    if (chess == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    lockAllShards(chess);
+    bool closed = closeJournal(chess);
+    unlockAllShards(chess);
+    return closed ? CHESS_SUCCESS : CHESS_SAVE_FAILURE;
+}
+
+static bool closeJournal(ChessSystem chess)
+{
+    bool closed = journalClose(chess->journal);
+    chess->journal = NULL;
+    return closed;
+}
+
+//Returns the journal that was open
+static Journal swapJournal(ChessSystem chess, Journal journal)
+{
+    lockAllShards(chess);
+    Journal previous = chess->journal;
+    chess->journal = journal;
+    unlockAllShards(chess);
+    return previous;
+}
+
+ChessResult chessReplayJournal(ChessSystem chess, const char* path)
+{
+    if (chess == NULL || path == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    size_t size;
+    unsigned char *data = snapshotReadFile(path, &size);
+    if (data == NULL) {
+        return CHESS_LOAD_FAILURE;
+    }
+    ChessGameRecord *games = allocatorAllocate(chess->allocator, sizeof(ChessGameRecord) * REPLAY_BATCH_SIZE);
+    ChessResult *results = allocatorAllocate(chess->allocator, sizeof(ChessResult) * REPLAY_BATCH_SIZE);
+    ChessResult result = CHESS_OUT_OF_MEMORY;
+    if (games != NULL && results != NULL) {
+        //The replayed changes are already journaled
+        Journal journal = swapJournal(chess, NULL);
+        JournalReader reader;
+        journalReaderInit(&reader, data, size);
+        result = replayRecords(chess, &reader, games, results);
+        swapJournal(chess, journal);
+    }
+    allocatorFree(chess->allocator, games, sizeof(ChessGameRecord) * REPLAY_BATCH_SIZE);
+    allocatorFree(chess->allocator, results, sizeof(ChessResult) * REPLAY_BATCH_SIZE);
+    free(data);
+    return result;
+}
+
+//Runs of games are added in batches. The results of the replayed changes are ignored.
+static ChessResult replayRecords(ChessSystem chess, JournalReader* reader, ChessGameRecord* games,
+                                 ChessResult* results)
+{
+    JournalRecord record;
+    size_t count = 0;
+    bool has_record;
+    do {
+        has_record = journalReadRecord(reader, &record);
+        if (has_record && record.type == JOURNAL_ADD_GAME) {
+            ChessGameRecord game = {record.ints[0], record.ints[1], record.ints[2], (Winner)record.ints[3],
+                                    record.ints[4]};
+            games[count++] = game;
+        }
+        if (count == REPLAY_BATCH_SIZE || (count > 0 && (!has_record || record.type != JOURNAL_ADD_GAME))) {
+            if (chessAddGames(chess, games, count, results) != CHESS_SUCCESS) {
+                return CHESS_OUT_OF_MEMORY;
+            }
+            count = 0;
+        }
+        if (!has_record) {
+            break;
+        }
+        switch (record.type) {
+            case JOURNAL_ADD_TOURNAMENT:
+                chessAddTournament(chess, record.ints[0], record.ints[1], record.string);
+                break;
+            case JOURNAL_END_TOURNAMENT:
+                chessEndTournament(chess, record.ints[0]);
+                break;
+            case JOURNAL_REMOVE_TOURNAMENT:
+                chessRemoveTournament(chess, record.ints[0]);
+                break;
+            case JOURNAL_REMOVE_PLAYER:
+                chessRemovePlayer(chess, record.ints[0]);
+                break;
+            default:
+                break;
+        }
+    } while (has_record);
+    return CHESS_SUCCESS;
+}
+
+//Every successful change moves its shard to a new version. The caller holds the lock of the shard.
+static void commitChange(ChessSystem chess, Shard* shard, const JournalRecord* record)
+{
+    __atomic_add_fetch(&shard->version, 1, __ATOMIC_RELAXED);
+    appendToJournal(chess, record);
+}
+
+//The caller holds the lock of a shard, so the journal can not be replaced meanwhile.
+static void appendToJournal(ChessSystem chess, const JournalRecord* record)
+{
+    if (chess->journal != NULL) {
+        lock(chess, &chess->journal_lock);
+        journalAppend(chess->journal, record);
+        unlock(chess, &chess->journal_lock);
+    }
+}
+
+/*
+ * A snapshot has the ids of the players in the order of their slots, with the number of tournaments each player
+ * has stats in, followed by the tournaments. Each tournament
+ * starts with its id, max games per player and location, the rest is written by tournamentSave.
+ */
+ChessResult chessSaveSnapshot(ChessSystem chess, const char* path)
+{
+    if (chess == NULL || path == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    return saveSnapshot(chess, path, NULL, 0);
+}
+
+ChessResult chessSaveCheckpoint(ChessSystem chess, const char* path, const char* journal_path, int sync_batch)
+{
+    if (chess == NULL || path == NULL || journal_path == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    return saveSnapshot(chess, path, journal_path, sync_batch > 0 ? sync_batch : 0);
+}
+
+//With a journal path, the shards stay locked until the new journal is started, so no change falls between the two
+static ChessResult saveSnapshot(ChessSystem chess, const char* path, const char* journal_path, int sync_batch)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return CHESS_SAVE_FAILURE;
+    }
+    lockAllShards(chess);
+    int tournaments_count;
+    TournamentEntry *tournaments = collectTournaments(chess, &tournaments_count);
+    if (tournaments == NULL) {
+        unlockAllShards(chess);
+        fclose(file);
+        return CHESS_OUT_OF_MEMORY;
+    }
+    SnapshotWriter writer;
+    snapshotWriterInit(&writer, file);
+    int players_count = playerDirectoryGetSize(chess->players);
+    snapshotWriteInt(&writer, players_count);
+    for (int player = 0; player < players_count; player++) {
+        PlayerRecord *record = playerDirectoryGet(chess->players, player);
+        snapshotWriteInt(&writer, record->player_id);
+        snapshotWriteInt(&writer, record->tournaments_count);
+    }
+    snapshotWriteInt(&writer, tournaments_count);
+    ChessResult result = CHESS_SUCCESS;
+    for (int i = 0; i < tournaments_count; i++) {
+        Tournament* tournament = tournaments[i].tournament;
+        Shard *shard = getShard(chess, tournaments[i].tournament_id);
+        //A spilled tournament is only mapped back while it is written, so the budget holds for the whole snapshot
+        bool spilled = tournament->spilled;
+        if (!pageIn(chess, shard, tournament)) {
+            result = CHESS_OUT_OF_MEMORY;
+            break;
+        }
+        const char* location = locationGetName(tournament->location);
+        snapshotWriteInt(&writer, tournaments[i].tournament_id);
+        snapshotWriteInt(&writer, tournament->max_games_per_player);
+        snapshotWriteInt(&writer, strlen(location) + 1);
+        snapshotWriteBytes(&writer, location, strlen(location) + 1);
+        tournamentSave(tournament, &writer);
+        if (spilled) {
+            spillTournament(chess, shard, tournament); //Its data is already in the spill file
+        }
+    }
+    if (journal_path == NULL) {
+        unlockAllShards(chess);
+    }
+    allocatorFree(chess->allocator, tournaments, sizeof(TournamentEntry) * (tournaments_count + 1));
+    bool written = snapshotWriterFinish(&writer) && (journal_path == NULL || snapshotWriterSync(&writer));
+    written = fclose(file) == 0 && written;
+    if (journal_path != NULL) {
+        //The old journal is only dropped once the snapshot that replaces it is on the disk
+        if (result == CHESS_SUCCESS && written) {
+            bool closed = closeJournal(chess);
+            chess->journal = journalCreate(journal_path, sync_batch);
+            written = closed && chess->journal != NULL;
+        }
+        unlockAllShards(chess);
+    }
+    return result == CHESS_SUCCESS && !written ? CHESS_SAVE_FAILURE : result;
+}
+
+ChessSystem chessLoadSnapshot(const char* path)
+{
+    if (path == NULL) {
+        return NULL;
+    }
+    ChessSystem chess = chessCreate();
+    if (chess != NULL && chessLoadSnapshotInto(chess, path) != CHESS_SUCCESS) {
+        chessDestroy(chess);
+        return NULL;
+    }
+    return chess;
+}
+
+ChessResult chessLoadSnapshotInto(ChessSystem chess, const char* path)
+{
+    if (chess == NULL || path == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    if (!isEmpty(chess)) {
+        return CHESS_LOAD_FAILURE;
+    }
+    size_t size;
+    unsigned char *data = snapshotReadFile(path, &size);
+    if (data == NULL) {
+        return CHESS_LOAD_FAILURE;
+    }
+    SnapshotReader reader;
+    ChessResult result = CHESS_LOAD_FAILURE;
+    if (snapshotReaderInit(&reader, data, size)) {
+        //The loaded state is not a change to journal
+        Journal journal = swapJournal(chess, NULL);
+        result = loadSnapshot(chess, &reader) ? CHESS_SUCCESS : CHESS_LOAD_FAILURE;
+        swapJournal(chess, journal);
+    }
+    free(data);
+    if (result == CHESS_SUCCESS && chess->freeze_ended) {
+        chessSetFreezeEndedTournaments(chess, true); //A tournament that could not be frozen is still correct
+    }
+    return result;
+}
+
+static bool isEmpty(ChessSystem chess)
+{
+    for (int i = 0; i < chess->shards_count; i++) {
+        if (mapGetSize(chess->shards[i].tournaments) > 0) {
+            return false;
+        }
+    }
+    return playerDirectoryGetSize(chess->players) == 0;
+}
+
+static bool loadSnapshot(ChessSystem chess, SnapshotReader* reader)
+{
+    int players_count = snapshotReadCount(reader, 2 * SNAPSHOT_INT_SIZE);
+    for (int player = 0; player < players_count; player++) {
+        int player_id = snapshotReadInt(reader);
+        int tournaments_count = snapshotReadInt(reader);
+        if (player_id < 0 || tournaments_count < 0 || playerDirectoryAdd(chess->players, player_id) != player ||
+            !playerDirectoryReserveTournaments(chess->players, player, tournaments_count)) {
+            return false;
+        }
+    }
+    int tournaments_count = snapshotReadCount(reader, TOURNAMENT_SNAPSHOT_MIN_SIZE);
+    lockAllShards(chess);
+    lock(chess, &chess->locations_lock);
+    bool loaded = loadTournaments(chess, reader, tournaments_count);
+    unlock(chess, &chess->locations_lock);
+    for (int i = 0; i < chess->shards_count; i++) {
+        __atomic_add_fetch(&chess->shards[i].version, 1, __ATOMIC_RELAXED); //A view of the empty system is stale
+    }
+    unlockAllShards(chess);
+    return loaded && snapshotReaderFinish(reader);
+}
+
+/*
+ * The tournaments were saved by increasing id, so they are put in their shards in one pass that only checks that
+ * the ids keep increasing, in place of adding them one by one with chessAddTournament: the locks are taken once
+ * for all of them by the caller, and no tournament is looked up, validated again or journaled.
+ */
+static bool loadTournaments(ChessSystem chess, SnapshotReader* reader, int tournaments_count)
+{
+    int previous_id = 0;
+    for (int i = 0; i < tournaments_count; i++) {
+        int tournament_id = snapshotReadInt(reader);
+        int max_games_per_player = snapshotReadInt(reader);
+        int location_length = snapshotReadInt(reader);
+        const char *location = snapshotReadBytes(reader, location_length);
+        if (tournament_id <= previous_id || max_games_per_player <= 0 || location == NULL || location_length == 0 ||
+            location[location_length - 1] != '\0' ||
+            !loadTournament(chess, reader, tournament_id, max_games_per_player, location)) {
+            return false;
+        }
+        previous_id = tournament_id;
+    }
+    return true;
+}
+
+/*
+ * Each tournament is put in its shard empty, and is then filled in place inside the map. Only a location that is
+ * not interned yet is checked, since the interned ones are all valid.
+ */
+static bool loadTournament(ChessSystem chess, SnapshotReader* reader, int tournament_id, int max_games_per_player,
+                           const char* tournament_location)
+{
+    Location location = locationTableAcquire(chess->locations, tournament_location);
+    if (location == NULL && checkLocation(tournament_location)) {
+        location = locationTableAdd(chess->locations, tournament_location);
+    }
+    if (location == NULL) {
+        return false;
+    }
+    Shard *shard = getShard(chess, tournament_id);
+    Tournament *tournament = tournamentCreate(location, max_games_per_player, chess->players, shard->totals,
+                                              chess->allocator);
+    locationRelease(location);
+    return tournament != NULL && putTournament(chess, shard, tournament_id, tournament) &&
+           tournamentLoad(tournament, reader);
+}
+
+/*
+ * Prints the statistics of the ended tournaments of a view in order. On several threads, each thread prints a
+ * run of the tournaments into memory, and the runs are then written in order.
+ */
+static bool printStatistics(const ReadView* view, int export_threads, FILE* file)
+{
+    int count = view->tournaments_count;
+    int threads = count / MIN_TOURNAMENTS_PER_THREAD;
+    threads = threads < export_threads ? threads : export_threads;
+    StatisticsRun *runs = threads > 1 ? allocatorAllocate(view->allocator, sizeof(StatisticsRun) * threads) : NULL;
+    if (runs == NULL) {
+        StatisticsRun run = {view, 0, count, false};
+        outputBufferInit(&run.output, file);
+        printStatisticsRun(&run);
+        return run.written;
+    }
+    for (int i = 0; i < threads; i++) {
+        runs[i].view = view;
+        runs[i].first = (int)((long long)count * i / threads);
+        runs[i].end = (int)((long long)count * (i + 1) / threads);
+        outputBufferInitMemory(&runs[i].output, view->allocator);
+    }
+    runInParallel(printStatisticsRun, runs, threads, sizeof(StatisticsRun));
+    bool written = true;
+    for (int i = 0; i < threads; i++) {
+        size_t size;
+        const char *memory = outputBufferGetMemory(&runs[i].output, &size);
+        written = written && runs[i].written && (size == 0 || fwrite(memory, 1, size, file) == size);
+        outputBufferFreeMemory(&runs[i].output);
+    }
+    allocatorFree(view->allocator, runs, sizeof(StatisticsRun) * threads);
+    return written;
+}
+
+static void* printStatisticsRun(void* argument)
+{
+    StatisticsRun *run = argument;
+    for (int i = run->first; i < run->end; i++) {
+        printTournamnentStats(&run->view->tournaments[i], &run->output);
+    }
+    run->written = outputBufferFlush(&run->output);
+    return NULL;
+}
+
+static void printTournamnentStats(const ViewTournament* tournament, OutputBuffer* buffer)
+{
+    assert(tournament != NULL);
+    assert(buffer != NULL);
+    const TournamentSummary *summary = tournament->summary;
+    outputBufferWriteInt(buffer, summary->winner);
+    outputBufferWriteChar(buffer, '\n');
+    outputBufferWriteInt(buffer, summary->longest_game);
+    outputBufferWriteChar(buffer, '\n');
+    outputBufferWriteFixed2(buffer, summary->average_game_time);
+    outputBufferWriteChar(buffer, '\n');
+    outputBufferWriteString(buffer, tournament->location);
+    outputBufferWriteChar(buffer, '\n');
+    outputBufferWriteInt(buffer, summary->games_count);
+    outputBufferWriteChar(buffer, '\n');
+    outputBufferWriteInt(buffer, summary->players_count);
+    outputBufferWriteChar(buffer, '\n');
 }
@@ -2,6 +2,7 @@
 #define _CHESSSYSTEM_H
 
 #include <stdio.h>
+#include <stdbool.h>
 
 
 
@@ -21,9 +22,14 @@ typedef enum {
     CHESS_NO_TOURNAMENTS_ENDED,
     CHESS_NO_GAMES,
     CHESS_SAVE_FAILURE,
-    CHESS_SUCCESS
+    CHESS_SUCCESS,
+    CHESS_LOAD_FAILURE,
+    CHESS_QUEUE_FULL
 } ChessResult ;
 
+/** The number of ChessResult values, which are 0 to CHESS_RESULT_COUNT - 1 */
+#define CHESS_RESULT_COUNT (CHESS_QUEUE_FULL + 1)
+
 /*
     Type for specifying who is the winner in a certain match
 */
@@ -33,9 +39,94 @@ typedef enum {
     DRAW
 } Winner;
 
+/** A single game, as passed to chessAddGames. The fields are the arguments of chessAddGame. */
+typedef struct ChessGameRecord {
+    int tournament_id;
+    int first_player;
+    int second_player;
+    Winner winner;
+    int play_time;
+} ChessGameRecord;
+
+/** The formats of the game files read by chessImportGames */
+typedef enum {
+    CHESS_IMPORT_CSV,   /* One game per line: tournament_id,first_player,second_player,winner,play_time */
+    CHESS_IMPORT_BINARY /* 20 byte records of the same five fields, each a little endian 32 bit integer */
+} ChessImportFormat;
+
+/** The outcome of chessImportGames */
+typedef struct ChessImportReport {
+    size_t results[CHESS_RESULT_COUNT]; /* The number of games that got each result, results[CHESS_SUCCESS] were added */
+    size_t malformed; /* The number of records that could not be parsed, or have a winner that is not a Winner */
+} ChessImportReport;
+
 /** Type for representing a chess system that organizes chess tournaments */
 typedef struct chess_system_t *ChessSystem;
 
+/** Type for a consistent read only view of a chess system, taken by chessAcquireSnapshot */
+typedef struct ChessReadSnapshot_t *ChessReadSnapshot;
+
+/** Type for an iterator over the games of a tournament, as they were when chessGameIteratorCreate created it */
+typedef struct ChessGameIterator_t *ChessGameIterator;
+
+/** Type for an ingestion queue, that adds the games submitted to it on its own thread */
+typedef struct ChessIngestQueue_t *ChessIngestQueue;
+
+/** What chessIngestQueueSubmit does when the queue is full */
+typedef enum {
+    CHESS_INGEST_BLOCK, /* Wait until the apply thread makes room */
+    CHESS_INGEST_FAIL   /* Return CHESS_QUEUE_FULL at once */
+} ChessIngestPolicy;
+
+/** Called on the apply thread with the result of adding a submitted game, and the context it was submitted with */
+typedef void (*ChessGameCallback)(const ChessGameRecord* game, ChessResult result, void* context);
+
+/** The result of a submitted game, owned by the submitter until the game is done */
+typedef struct ChessGameFuture {
+    bool done;
+    ChessResult result;
+    ChessIngestQueue queue; /* Wakes the threads that wait for the future */
+} ChessGameFuture;
+
+/**
+ * Where a chess system gets its memory. Every function is given the context of the allocator, and free and
+ * reallocate are also given the size the block was allocated with. allocate and reallocate return NULL if there is
+ * no memory, and a failed reallocate leaves the block as it was. Blocks are freed on the threads that use the
+ * system, and on the background thread of chessSetBackgroundReclaim, and the statistics are printed into blocks
+ * on the export threads of chessSetExportThreads, so the functions have to be thread safe if those are used.
+ */
+typedef struct ChessAllocator {
+    void* (*allocate)(size_t size, void* context);
+    void* (*reallocate)(void* block, size_t old_size, size_t new_size, void* context);
+    void (*free)(void* block, size_t size, void* context);
+    void* context;
+} ChessAllocator;
+
+/** An allocator that counts the memory it hands out, and fails once a limit would be passed */
+typedef struct ChessCountingAllocator {
+    ChessAllocator allocator; /* The allocator to create the system with, its context is this struct */
+    size_t limit; /* The most bytes that can be in use at once, 0 for no limit */
+    size_t bytes; /* In use */
+    size_t blocks; /* In use */
+    size_t peak_bytes;
+    size_t allocations; /* Calls to allocate and reallocate, also the ones that failed */
+} ChessCountingAllocator;
+
+/** The memory a tournament takes up */
+typedef struct ChessMemoryUsage {
+    size_t bytes; /* What the allocator was asked for, with the headers and the unused ends of the chunks */
+    size_t objects; /* The number of blocks taken from the allocator */
+} ChessMemoryUsage;
+
+/** The tournaments moved out of memory by chessSetMemoryBudget, and mapped back, since the system was created */
+typedef struct ChessSpillStats {
+    size_t spills; /* The number of times a tournament was moved out of memory */
+    size_t reloads; /* The number of times a tournament was mapped back */
+    size_t spilled_bytes; /* Written to the spill file. A tournament is written once, however often it is spilled */
+    size_t reloaded_bytes; /* Read back from the spill file */
+    size_t resident_bytes; /* The footprints of the frozen tournaments that are in memory now, counted by the budget */
+} ChessSpillStats;
+
 /**
  * chessCreate: create an empty chess system.
  *
@@ -44,6 +135,54 @@ typedef struct chess_system_t *ChessSystem;
  */
 ChessSystem chessCreate();
 
+/**
+ * chessCreateThreadSafe: create an empty chess system that can be used by several threads at once.
+ *
+ * The tournaments are split into shards by id, and each shard has its own lock, so changes to tournaments
+ * of different shards run in parallel. Functions that cross tournaments (removing a player, the averages,
+ * saving a snapshot, opening and closing the journal) lock all the shards, and wait for the changes that are
+ * running. Read snapshots, and the exports that take one, lock one shard at a time. chessDestroy,
+ * chessLoadSnapshotInto and chessReplayJournal must not run while other threads use the system. chessCreate
+ * creates a system with a single shard and no locking.
+ *
+ * @param shards_count - the number of shards. Must be positive. About the number of threads that add
+ *                       games, or more so tournaments rarely share a shard.
+ * @return A new chess system in case of success, and NULL otherwise (e.g.
+ *     in case of an allocation error, or if shards_count is not positive)
+ */
+ChessSystem chessCreateThreadSafe(int shards_count);
+
+/**
+ * chessCreateWithAllocator: create an empty chess system that takes its memory from an allocator.
+ *
+ * The system itself, its tournaments, its players, its snapshots, the keys of its tournaments and the temporary
+ * memory of its functions come from the allocator. These still use malloc:
+ *   - what libmap allocates itself for the maps from tournament ids to tournaments
+ *   - the locations of the tournaments and their names
+ *   - the journals of chessOpenJournal and chessSaveCheckpoint, and the copy of the journal file that
+ *     chessOpenJournal and chessReplayJournal read
+ *   - the reader of chessImportGames and the queues of chessIngestQueueCreate
+ *   - the background reclaimer of chessSetBackgroundReclaim
+ *   - the spill file of chessSetMemoryBudget
+ * Besides those, the C library allocates for the files and threads the system uses.
+ * The allocator must stay valid until the system and all its snapshots are gone.
+ * The system is not thread safe, like one created with chessCreate.
+ *
+ * @param allocator - the allocator. Must be non-NULL, with all of its functions set.
+ * @return A new chess system in case of success, and NULL otherwise (e.g.
+ *     in case of an allocation error, or if the allocator is NULL or incomplete)
+ */
+ChessSystem chessCreateWithAllocator(const ChessAllocator* allocator);
+
+/**
+ * chessCountingAllocatorInit: sets up a counting allocator, with nothing in use. Its functions use malloc,
+ *                             realloc and free, and update the counts atomically.
+ *
+ * @param counting - the allocator to set up. Must be non-NULL.
+ * @param limit - the most bytes that can be in use at once, 0 for no limit.
+ */
+void chessCountingAllocatorInit(ChessCountingAllocator* counting, size_t limit);
+
 /**
  * chessDestroy: free a chess system, and all its contents, from
  * memory.
@@ -100,6 +239,44 @@ ChessResult chessAddTournament (ChessSystem chess, int tournament_id,
 ChessResult chessAddGame(ChessSystem chess, int tournament_id, int first_player,
                          int second_player, Winner winner, int play_time);
 
+/**
+ * chessAddGames: add a batch of matches to the chess system.
+ *                The result of every game is the same as if it was added with chessAddGame, one after the other
+ *                in the order of the batch. The games of each tournament are added together, so the tournament
+ *                is looked up and its games are allocated once for the whole batch.
+ *
+ * @param chess - chess system that contains the tournaments. Must be non-NULL.
+ * @param games - the games to add. May be NULL only if n is 0.
+ * @param n - the number of games.
+ * @param results - an array of n entries, to which the result of adding each game is written.
+ *                  The results are the same as those of chessAddGame. May be NULL only if n is 0.
+ *
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess is NULL, or games/results are NULL and n is positive.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed before any game was added.
+ *     CHESS_SUCCESS - if every game was handled, and its result was written.
+ */
+ChessResult chessAddGames(ChessSystem chess, const ChessGameRecord* games, size_t n, ChessResult* results);
+
+/**
+ * chessImportGames: adds all the games in a file, as if they were added with chessAddGames in the order of
+ *                   the file. Empty lines of a CSV file are skipped.
+ *
+ * @param chess - chess system that contains the tournaments. Must be non-NULL.
+ * @param path - the path of the file to read. Must be non-NULL.
+ * @param format - the format of the file.
+ * @param report - to which the number of games with each result is written. Must be non-NULL.
+ *
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/path/report are NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed.
+ *     CHESS_LOAD_FAILURE - if the format is unknown, or the file could not be opened or read.
+ *     CHESS_SUCCESS - if the whole file was read. The games added before a failure are not removed,
+ *                     and are counted in the report.
+ */
+ChessResult chessImportGames(ChessSystem chess, const char* path, ChessImportFormat format,
+                             ChessImportReport* report);
+
 /**
  * chessRemoveTournament: removes the tournament and all the games played in it from the chess system
  *                        updates all players statistics (wins, losses, draws, average play time).
@@ -111,6 +288,7 @@ ChessResult chessAddGame(ChessSystem chess, int tournament_id, int first_player,
  *     CHESS_NULL_ARGUMENT - if chess is NULL.
  *     CHESS_INVALID_ID - if the tournament ID number is invalid.
  *     CHESS_TOURNAMENT_NOT_EXIST - if the tournament does not exist in the system.
+ *     CHESS_OUT_OF_MEMORY - if the tournament was spilled by chessSetMemoryBudget and could not be mapped back.
  *     CHESS_SUCCESS - if tournament was removed successfully.
  */
 ChessResult chessRemoveTournament (ChessSystem chess, int tournament_id);
@@ -156,6 +334,25 @@ ChessResult chessRemovePlayer(ChessSystem chess, int player_id);
  */
 ChessResult chessEndTournament (ChessSystem chess, int tournament_id);
 
+/**
+ * chessGetTournamentLeaders: writes the ids of the k highest ranked players of a tournament, in the same
+ *                            order that chessEndTournament uses to choose the winner.
+ *                            If the tournament has less than k players, the remaining entries are set to -1.
+ *
+ * @param chess - chess system that contains the tournament. Must be non-NULL.
+ * @param tournament_id - the tournament id. Must be positive.
+ * @param k - the number of leaders to write.
+ * @param leaders - an array of at least k entries to which the leaders are written. Must be non-NULL.
+ *
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/leaders are NULL.
+ *     CHESS_INVALID_ID - if the tournament ID number is invalid.
+ *     CHESS_TOURNAMENT_NOT_EXIST - if the tournament does not exist in the system.
+ *     CHESS_OUT_OF_MEMORY - if the tournament was spilled by chessSetMemoryBudget and could not be mapped back.
+ *     CHESS_SUCCESS - if the leaders were written successfully.
+ */
+ChessResult chessGetTournamentLeaders(ChessSystem chess, int tournament_id, int k, int* leaders);
+
 /**
  * chessCalculateAveragePlayTime: the function returns the average playing time for a particular player
  *
@@ -172,29 +369,473 @@ double chessCalculateAveragePlayTime (ChessSystem chess, int player_id, ChessRes
 
 /**
  * chessSavePlayersLevels: prints the rating of all players in the system as
- * explained in the *.pdf
+ * explained in the *.pdf. The ratings are printed from a snapshot, so changes to the system do not wait for
+ * the printing.
  *
  * @param chess - a chess system. Must be non-NULL.
  * @param file - an open, writable output stream, to which the ratings are printed.
  * @return
  *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed.
  *     CHESS_SAVE_FAILURE - if an error occurred while saving.
  *     CHESS_SUCCESS - if the ratings was printed successfully.
  */
 ChessResult chessSavePlayersLevels (ChessSystem chess, FILE* file);
 
+/**
+ * chessSavePlayersLevelsTopK: prints the rating of the k highest rated players in the system, in the same
+ * format and order as chessSavePlayersLevels.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param file - an open, writable output stream, to which the ratings are printed.
+ * @param k - the maximal number of players to print.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed.
+ *     CHESS_SAVE_FAILURE - if an error occurred while saving.
+ *     CHESS_SUCCESS - if the ratings was printed successfully.
+ */
+ChessResult chessSavePlayersLevelsTopK (ChessSystem chess, FILE* file, int k);
+
 /**
  * chessSaveTournamentStatistics: prints to the file the statistics for each tournament that ended as
- * explained in the *.pdf
+ * explained in the *.pdf. The statistics are printed from a snapshot, like chessSavePlayersLevels.
  *
  * @param chess - a chess system. Must be non-NULL.
  * @param path_file - the file path which within it the tournament statistics will be saved.
  * @return
  *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed.
  *     CHESS_NO_TOURNAMENTS_ENDED - if there are no tournaments ended in the system.
  *     CHESS_SAVE_FAILURE - if an error occurred while saving.
  *     CHESS_SUCCESS - if the ratings was printed successfully.
  */
 ChessResult chessSaveTournamentStatistics (ChessSystem chess, char* path_file);
 
+/**
+ * chessSaveSnapshot: saves the whole state of the chess system to a binary file, from which chessLoadSnapshot
+ * can restore it. The file has a format version and a checksum.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param path - the path of the file to write. Must be non-NULL.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/path are NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed, or a spilled tournament could not be mapped back.
+ *     CHESS_SAVE_FAILURE - if an error occurred while saving.
+ *     CHESS_SUCCESS - if the snapshot was saved successfully.
+ */
+ChessResult chessSaveSnapshot(ChessSystem chess, const char* path);
+
+/**
+ * chessSaveCheckpoint: saves a snapshot like chessSaveSnapshot, and starts a new, empty journal in place of the
+ *                      open one, as chessOpenJournal would. No change can run between the two, so replaying the
+ *                      new journal onto the loaded snapshot redoes exactly the changes made after it. The snapshot
+ *                      is synced to the disk before the old journal is closed, and the journal file is replaced
+ *                      only then, so it may be the file of the old journal. If saving the snapshot fails, the old
+ *                      journal stays open.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param path - the path of the snapshot file to write. Must be non-NULL.
+ * @param journal_path - the path of the new journal file. Must be non-NULL.
+ * @param sync_batch - as in chessOpenJournal.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/path/journal_path are NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed, or a spilled tournament could not be mapped back.
+ *     CHESS_SAVE_FAILURE - if an error occurred while saving or syncing the snapshot, closing the old journal
+ *                          failed, or the new journal file could not be opened. Changes are not journaled then.
+ *     CHESS_SUCCESS - if the snapshot was saved and the new journal started.
+ */
+ChessResult chessSaveCheckpoint(ChessSystem chess, const char* path, const char* journal_path, int sync_batch);
+
+/**
+ * chessLoadSnapshot: creates a chess system from a file written by chessSaveSnapshot.
+ *
+ * @param path - the path of the snapshot file. Must be non-NULL.
+ * @return A new chess system in the state that was saved, and NULL if path is NULL, the file could not be read,
+ *     has another format version, is corrupt, or in case of an allocation error.
+ */
+ChessSystem chessLoadSnapshot(const char* path);
+
+/**
+ * chessLoadSnapshotInto: loads a file written by chessSaveSnapshot into a new, empty system, so the loaded system
+ *                        can have its own shards, allocator, memory budget or frozen tournaments. Nothing that
+ *                        is loaded is journaled. chessLoadSnapshot is this with a system from chessCreate.
+ *                        Must not run while other threads use the system.
+ *
+ * @param chess - a chess system that has no tournaments and no players. Must be non-NULL.
+ * @param path - the path of the snapshot file. Must be non-NULL.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/path are NULL.
+ *     CHESS_LOAD_FAILURE - if the system is not empty, the file could not be read, has another format version,
+ *                          is corrupt, or an allocation failed. The system may then hold part of the snapshot,
+ *                          and should be destroyed.
+ *     CHESS_SUCCESS - if the snapshot was loaded.
+ */
+ChessResult chessLoadSnapshotInto(ChessSystem chess, const char* path);
+
+/**
+ * chessSetExportThreads: sets the number of threads chessSavePlayersLevels and chessSaveTournamentStatistics may
+ *                        use. The exports are the same for any number of threads, and small exports use fewer
+ *                        threads than allowed. The default is 1.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param threads - the number of threads, including the calling thread. Values below 1 are taken as 1, and
+ *                  at most 64 threads are used.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_SUCCESS - otherwise.
+ */
+ChessResult chessSetExportThreads(ChessSystem chess, int threads);
+
+/**
+ * chessSetBackgroundReclaim: sets whether chessRemoveTournament destroys the removed tournaments itself, or
+ *                            only unlinks them and leaves freeing their arenas to a background thread.
+ *                            Either way the tournament is gone once chessRemoveTournament returns.
+ *                            The default is to destroy them in chessRemoveTournament.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param enabled - whether removed tournaments are freed in the background. Disabling it waits until all the
+ *                  tournaments that were removed are freed, and so does chessDestroy.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_OUT_OF_MEMORY - if the thread could not be started.
+ *     CHESS_SUCCESS - otherwise.
+ */
+ChessResult chessSetBackgroundReclaim(ChessSystem chess, bool enabled);
+
+/**
+ * chessSetFreezeEndedTournaments: sets whether ended tournaments are frozen. An ended tournament can not change
+ *                                 any more, so a frozen one keeps its games, stats and players by rank in
+ *                                 arrays that fit them exactly, and drops the indexes it needed for adding games.
+ *                                 Every function gives the same results for a frozen tournament. Enabling it
+ *                                 freezes the tournaments that already ended, and the ones that end later are
+ *                                 frozen by chessEndTournament. The default is not to freeze them.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param enabled - whether ended tournaments are frozen. Disabling it does not unfreeze the frozen ones.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_OUT_OF_MEMORY - if a tournament could not be frozen. It is left as it was, and the rest are frozen.
+ *     CHESS_SUCCESS - otherwise.
+ */
+ChessResult chessSetFreezeEndedTournaments(ChessSystem chess, bool enabled);
+
+/**
+ * chessSetMemoryBudget: limits the memory that frozen tournaments take up. Setting a budget freezes the ended
+ *                       tournaments as chessSetFreezeEndedTournaments does. When the frozen tournaments in memory
+ *                       take up more than the budget, the least recently used ones are written to a spill file
+ *                       and only their winner, counts and game totals stay in memory, which is all that
+ *                       chessSaveTournamentStatistics, chessSavePlayersLevels and chessCalculateAveragePlayTime
+ *                       read. A spilled tournament is mapped back from the file with mmap when its leaders,
+ *                       games or stats are needed: by chessGetTournamentLeaders, chessGameIteratorCreate and
+ *                       chessSaveSnapshot. The snapshot only keeps each one in memory while it writes it.
+ *                       chessRemoveTournament reads the stats of a spilled tournament from the mapping, without
+ *                       copying it back into memory. The budget is split evenly between the shards, and each
+ *                       shard spills its own tournaments. A tournament counts against the budget with all the
+ *                       memory its arena holds from the allocator, the headers and the unused ends of its chunks
+ *                       included. The spill file is deleted when the budget is removed, or the system is destroyed.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param budget - the most bytes of frozen tournaments to keep in memory, 0 to map every spilled tournament back
+ *                 and keep them all in memory. The tournaments that are larger than the budget of their shard
+ *                 are only in memory while they are used.
+ * @param spill_path - the path of the spill file, which is replaced if it exists. Must be non-NULL if the budget
+ *                     is not 0. A previous spill file is deleted.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess is NULL, or spill_path is NULL and the budget is not 0.
+ *     CHESS_OUT_OF_MEMORY - if the spilled tournaments could not all be mapped back, in which case the budget
+ *                           and the spill file stay as they were, or a tournament could not be frozen.
+ *     CHESS_SAVE_FAILURE - if the spill file could not be created. The system is left without a budget.
+ *     CHESS_SUCCESS - otherwise.
+ */
+ChessResult chessSetMemoryBudget(ChessSystem chess, size_t budget, const char* spill_path);
+
+/**
+ * chessGetSpillStats: returns how many times tournaments were spilled and mapped back by chessSetMemoryBudget,
+ *                     and how many bytes that moved.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param stats - set to the stats of the system. Must be non-NULL.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/stats are NULL.
+ *     CHESS_SUCCESS - otherwise.
+ */
+ChessResult chessGetSpillStats(ChessSystem chess, ChessSpillStats* stats);
+
+/**
+ * chessGameIteratorCreate: creates an iterator over the games of a tournament, in the order they were added, as
+ *                          they are when it is created. A frozen tournament keeps its games in a compact archive
+ *                          of varints, which never changes, so the iterator shares it with the tournament instead
+ *                          of copying it, and decodes it as it goes. The games of any other tournament are encoded
+ *                          the same way when the iterator is created. The iterator also keeps the ids of the
+ *                          tournament's players, so reading the games does not go over the players of the system.
+ *                          The iterator does not change when the tournament does, or when it is removed, but must
+ *                          be destroyed before the system.
+ *
+ * @param chess - chess system that contains the tournament. Must be non-NULL.
+ * @param tournament_id - the tournament id. Must be positive.
+ * @param chess_result - this variable will contain the returned error code. Must be non-NULL.
+ * @return A new iterator if chess_result is CHESS_SUCCESS, NULL otherwise.
+ *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_INVALID_ID - if the tournament ID number is invalid.
+ *     CHESS_TOURNAMENT_NOT_EXIST - if the tournament does not exist in the system.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed, or a spilled tournament could not be mapped back.
+ *     CHESS_SUCCESS - otherwise.
+ */
+ChessGameIterator chessGameIteratorCreate(ChessSystem chess, int tournament_id, ChessResult* chess_result);
+
+/**
+ * chessGameIteratorNext: writes the next game of an iterator. The id of a player that was removed from the
+ *                        tournament is -1, and the winner is the other player.
+ *
+ * @param iterator - an iterator. Must be non-NULL.
+ * @param game - set to the next game. Must be non-NULL.
+ * @return false if there are no more games, or an argument is NULL, and true otherwise.
+ */
+bool chessGameIteratorNext(ChessGameIterator iterator, ChessGameRecord* game);
+
+/**
+ * chessGameIteratorRead: writes up to count of the next games of an iterator, as chessGameIteratorNext does.
+ *                        Decoding many games at once is several times faster than one at a time.
+ *
+ * @param iterator - an iterator. Must be non-NULL.
+ * @param games - an array of at least count games, to which the games are written. Must be non-NULL.
+ * @param count - the most games to write.
+ * @return the number of games that were written, 0 if there are no more games or an argument is NULL.
+ */
+size_t chessGameIteratorRead(ChessGameIterator iterator, ChessGameRecord* games, size_t count);
+
+/**
+ * chessGameIteratorSeek: moves an iterator to a game, by its position in the order the games were added.
+ *                        The games are kept in blocks of 128 with an index, so only the games before it in its
+ *                        block are decoded again.
+ *
+ * @param iterator - an iterator. If NULL, nothing is done.
+ * @param index - the position of the game that chessGameIteratorNext writes next. Positions past the last game
+ *                end the iteration, negative positions are taken as 0.
+ */
+void chessGameIteratorSeek(ChessGameIterator iterator, int index);
+
+/**
+ * chessGameIteratorDestroy: frees an iterator. If iterator is NULL, nothing is done.
+ */
+void chessGameIteratorDestroy(ChessGameIterator iterator);
+
+/**
+ * chessGetMemoryUsage: returns the memory a tournament takes from the allocator of the system: the tournament
+ *                      itself, and the arena that all its games, stats and indexes are allocated from, with the
+ *                      whole chunks of the arena and the headers of its blocks. The arena is freed at once when
+ *                      the tournament is removed. A spilled tournament only takes the tournament itself.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param tournament_id - the id of the tournament.
+ * @param usage - set to the memory usage of the tournament. Must be non-NULL.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/usage are NULL.
+ *     CHESS_INVALID_ID - if the tournament ID number is invalid.
+ *     CHESS_TOURNAMENT_NOT_EXIST - if the tournament does not exist in the system.
+ *     CHESS_SUCCESS - otherwise.
+ */
+ChessResult chessGetMemoryUsage(ChessSystem chess, int tournament_id, ChessMemoryUsage* usage);
+
+/**
+ * chessGetTournamentBytesInUse: the bytes of chessGetMemoryUsage alone, kept for the callers that used it
+ *                               before chessGetMemoryUsage was added. Takes and returns the same as it.
+ */
+ChessResult chessGetTournamentBytesInUse(ChessSystem chess, int tournament_id, size_t* bytes_in_use);
+
+/**
+ * chessOpenJournal: starts journaling every change to the chess system to a file, from which chessReplayJournal
+ *                   can redo them. Only successful changes are journaled. The journal is appended to the file,
+ *                   and a torn record that a crash left at its end is cut off first. A journal that was already
+ *                   open is closed. chessSaveCheckpoint starts a new journal together with a snapshot.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @param path - the path of the journal file. Must be non-NULL.
+ * @param sync_batch - the journal is written and synced to the disk every sync_batch changes, so a crash loses
+ *                     at most the last sync_batch changes. If it is not positive, the journal is only written
+ *                     when its buffer fills up, and synced when it is closed.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/path are NULL.
+ *     CHESS_SAVE_FAILURE - if the file could not be opened, or closing the previous journal failed.
+ *     CHESS_SUCCESS - if the journal was opened successfully.
+ */
+ChessResult chessOpenJournal(ChessSystem chess, const char* path, int sync_batch);
+
+/**
+ * chessCloseJournal: writes and syncs the rest of the journal, and stops journaling changes.
+ *                    Does nothing if no journal is open. chessDestroy also closes the journal.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess is NULL.
+ *     CHESS_SAVE_FAILURE - if writing any part of the journal failed since it was opened.
+ *     CHESS_SUCCESS - if the journal was closed successfully.
+ */
+ChessResult chessCloseJournal(ChessSystem chess);
+
+/**
+ * chessReplayJournal: redoes the changes in a journal file, in order. Reading stops at a torn or corrupt record.
+ *                     Changes that fail are skipped, and the replayed changes are not journaled again.
+ *                     Replaying is not idempotent: a game that was added before its player was removed is
+ *                     added again. So the journal has to be replayed onto the state it was started from: an
+ *                     empty system for a journal started on an empty one, or the snapshot chessSaveCheckpoint
+ *                     saved when it started the journal.
+ *
+ * @param chess - a chess system in the state the journal was started from. Must be non-NULL.
+ * @param path - the path of the journal file. Must be non-NULL.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if chess/path are NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed.
+ *     CHESS_LOAD_FAILURE - if the file could not be read.
+ *     CHESS_SUCCESS - if the journal was replayed.
+ */
+ChessResult chessReplayJournal(ChessSystem chess, const char* path);
+
+/**
+ * chessAcquireSnapshot: takes a read only view of the player levels and of the ended tournaments' statistics,
+ *                       as they are at the time of the call. The view does not change when the system does, and
+ *                       exporting from it does not hold up any change to the system. Taking the view copies
+ *                       the totals of the players and the ended tournaments of each shard that changed since
+ *                       the latest view, one shard at a time, and shares the copies of the other shards with
+ *                       that view. Changes to a shard only wait while that shard is copied. The totals are then
+ *                       summed per player and the tournaments ordered without holding any shard lock, which
+ *                       takes time in the number of players and ended tournaments.
+ *                       Snapshots taken while nothing changed share the same view, which is freed when the
+ *                       last of them is released. A snapshot stays valid after the system is destroyed.
+ *
+ * @param chess - a chess system. Must be non-NULL.
+ * @return A new snapshot in case of success, and NULL if chess is NULL or in case of an allocation error.
+ */
+ChessReadSnapshot chessAcquireSnapshot(ChessSystem chess);
+
+/**
+ * chessReleaseSnapshot: releases a snapshot taken by chessAcquireSnapshot.
+ *
+ * @param snapshot - the snapshot to release. A NULL value is allowed, and in that case the function does nothing.
+ */
+void chessReleaseSnapshot(ChessReadSnapshot snapshot);
+
+/**
+ * chessSnapshotSavePlayersLevels: the same as chessSavePlayersLevels, for the state of a snapshot.
+ *                                 Any number of threads may export from the same snapshot at once. The exports
+ *                                 of a snapshot use the number of threads set when it was taken.
+ *
+ * @param snapshot - a snapshot. Must be non-NULL.
+ * @param file - an open, writable output stream, to which the ratings are printed.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if snapshot/file are NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed.
+ *     CHESS_SAVE_FAILURE - if an error occurred while saving.
+ *     CHESS_SUCCESS - if the ratings was printed successfully.
+ */
+ChessResult chessSnapshotSavePlayersLevels(ChessReadSnapshot snapshot, FILE* file);
+
+/**
+ * chessSnapshotSavePlayersLevelsTopK: the same as chessSavePlayersLevelsTopK, for the state of a snapshot.
+ *
+ * @param snapshot - a snapshot. Must be non-NULL.
+ * @param file - an open, writable output stream, to which the ratings are printed.
+ * @param k - the maximal number of players to print.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if snapshot/file are NULL.
+ *     CHESS_OUT_OF_MEMORY - if an allocation failed.
+ *     CHESS_SAVE_FAILURE - if an error occurred while saving.
+ *     CHESS_SUCCESS - if the ratings was printed successfully.
+ */
+ChessResult chessSnapshotSavePlayersLevelsTopK(ChessReadSnapshot snapshot, FILE* file, int k);
+
+/**
+ * chessSnapshotSaveTournamentStatistics: the same as chessSaveTournamentStatistics, for the state of a snapshot.
+ *
+ * @param snapshot - a snapshot. Must be non-NULL.
+ * @param path_file - the file path which within it the tournament statistics will be saved.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if snapshot/path_file are NULL.
+ *     CHESS_NO_TOURNAMENTS_ENDED - if no tournament had ended when the snapshot was taken.
+ *     CHESS_SAVE_FAILURE - if an error occurred while saving.
+ *     CHESS_SUCCESS - if the statistics were printed successfully.
+ */
+ChessResult chessSnapshotSaveTournamentStatistics(ChessReadSnapshot snapshot, const char* path_file);
+
+/**
+ * chessIngestQueueCreate: creates a bounded queue of games, and a thread that adds the queued games to a chess
+ *                         system in batches with chessAddGames, in the order they were queued.
+ *                         Any number of threads can submit games at once without taking a lock.
+ *                         If other threads use the chess system while the queue is running, the system must be
+ *                         created with chessCreateThreadSafe.
+ *
+ * @param chess - the chess system to add the games to. Must be non-NULL, and outlive the queue.
+ * @param capacity - the number of games that can wait in the queue, rounded up to a power of 2 that is at
+ *                   least 2. Must be
+ *                   positive and at most 2^30.
+ * @param policy - what submitting a game to a full queue does.
+ * @return A new queue in case of success, and NULL otherwise (e.g. in case of an allocation error, an invalid
+ *     argument, or if the thread could not be started)
+ */
+ChessIngestQueue chessIngestQueueCreate(ChessSystem chess, int capacity, ChessIngestPolicy policy);
+
+/**
+ * chessIngestQueueDestroy: adds the games that are still queued, stops the apply thread and frees the queue.
+ *                          No thread may be submitting to the queue or waiting for a future of it, and it must
+ *                          not be called from a callback.
+ *
+ * @param queue - the queue to destroy. A NULL value is allowed, and in that case the function does nothing.
+ */
+void chessIngestQueueDestroy(ChessIngestQueue queue);
+
+/**
+ * chessIngestQueueSubmit: queues a game to be added. The callback is called on the apply thread with the
+ *                         result chessAddGame would have given, so it should return quickly.
+ *
+ * @param queue - the queue. Must be non-NULL.
+ * @param game - the game, which is copied. Must be non-NULL.
+ * @param callback - called with the result of the game. May be NULL.
+ * @param context - passed to the callback.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if queue/game are NULL.
+ *     CHESS_QUEUE_FULL - if the queue is full and its policy is CHESS_INGEST_FAIL.
+ *     CHESS_SUCCESS - if the game was queued.
+ */
+ChessResult chessIngestQueueSubmit(ChessIngestQueue queue, const ChessGameRecord* game,
+                                   ChessGameCallback callback, void* context);
+
+/**
+ * chessIngestQueueSubmitFuture: queues a game to be added, and sets a future when it is done.
+ *
+ * @param queue - the queue. Must be non-NULL.
+ * @param game - the game, which is copied. Must be non-NULL.
+ * @param future - set to the result of the game. Must be non-NULL, and stay valid until it is done.
+ * @return the same as chessIngestQueueSubmit. If the game was not queued, the future is done at once with
+ *     that result.
+ */
+ChessResult chessIngestQueueSubmitFuture(ChessIngestQueue queue, const ChessGameRecord* game,
+                                         ChessGameFuture* future);
+
+/**
+ * chessIngestQueueFlush: waits until all the games that were queued before the call were added, and their
+ *                        callbacks returned.
+ *
+ * @param queue - the queue. A NULL value is allowed, and in that case the function does nothing.
+ */
+void chessIngestQueueFlush(ChessIngestQueue queue);
+
+/**
+ * chessGameFutureIsDone: returns whether the game of a future was added.
+ */
+bool chessGameFutureIsDone(const ChessGameFuture* future);
+
+/**
+ * chessGameFutureWait: waits until the game of a future was added, and returns its result. It checks the
+ *                      future for a short while, and then sleeps until the apply thread wakes it, so the
+ *                      queue must not be destroyed while a thread waits.
+ *
+ * @param future - a future given to chessIngestQueueSubmitFuture. Must be non-NULL.
+ * @return
+ *     CHESS_NULL_ARGUMENT - if future is NULL.
+ *     Otherwise the result chessAddGame would have given for the game, or the result of submitting it if it
+ *     was not queued.
+ */
+ChessResult chessGameFutureWait(ChessGameFuture* future);
+
 #endif //HW1_CHESSSYSTEM_H
@@ -0,0 +1,199 @@
+#include <string.h>
+#include <assert.h>
+#include "gameArchive.h"
+
+#define RESULT_BITS 2
+#define RESULTS_PER_BYTE (8 / RESULT_BITS)
+#define RESULT_MASK 3
+#define OTHER_RESULT 3 //Marks a result that is not a Winner, which follows the duration
+#define BLOCK_RESULTS_SIZE (GAME_ARCHIVE_BLOCK_GAMES / RESULTS_PER_BYTE)
+#define VARINT_BITS 7
+#define VARINT_MORE 0x80
+
+static int getBlocksCount(int games_count);
+static uint32_t getResultBits(Winner result);
+static uint32_t encodeDifference(int value, int base);
+static size_t getVarintSize(uint32_t value);
+static unsigned char* writeVarint(unsigned char* position, uint32_t value);
+static inline uint32_t readVarint(const unsigned char** position);
+static size_t getGameSize(const Game* game, int previous_first);
+static unsigned char* writeGame(unsigned char* position, const Game* game, int previous_first);
+
+
+size_t gameArchiveGetSize(const Game* games, int games_count)
+{
+    assert(games != NULL || games_count == 0);
+    int blocks_count = getBlocksCount(games_count);
+    size_t size = sizeof(size_t) * blocks_count + BLOCK_RESULTS_SIZE * (size_t)blocks_count;
+    for (int i = 0; i < games_count; i++) {
+        size += getGameSize(&games[i], i % GAME_ARCHIVE_BLOCK_GAMES == 0 ? 0 : games[i - 1].players_slot[0]);
+    }
+    return size;
+}
+
+//The archive must be aligned for size_t, as any allocated block is
+void gameArchiveWrite(const Game* games, int games_count, unsigned char* archive)
+{
+    assert((games != NULL || games_count == 0) && archive != NULL);
+    int blocks_count = getBlocksCount(games_count);
+    size_t *offsets = (size_t*)archive;
+    unsigned char *position = archive + sizeof(size_t) * blocks_count;
+    for (int block = 0; block < blocks_count; block++) {
+        offsets[block] = position - archive;
+        unsigned char *results = position;
+        memset(results, 0, BLOCK_RESULTS_SIZE);
+        position += BLOCK_RESULTS_SIZE;
+        int first = block * GAME_ARCHIVE_BLOCK_GAMES;
+        int end = games_count - first < GAME_ARCHIVE_BLOCK_GAMES ? games_count : first + GAME_ARCHIVE_BLOCK_GAMES;
+        for (int i = first; i < end; i++) {
+            int index = i - first;
+            results[index / RESULTS_PER_BYTE] |= getResultBits(games[i].result) <<
+                                                (RESULT_BITS * (index % RESULTS_PER_BYTE));
+            position = writeGame(position, &games[i], i == first ? 0 : games[i - 1].players_slot[0]);
+        }
+    }
+}
+
+void gameArchiveIteratorInit(GameArchiveIterator* iterator, const unsigned char* archive, int games_count,
+                             int first)
+{
+    assert(iterator != NULL && (archive != NULL || games_count == 0));
+    iterator->archive = archive;
+    iterator->games_count = games_count;
+    iterator->next = first < 0 ? 0 : first > games_count ? games_count : first;
+    iterator->position = NULL;
+    iterator->results = NULL;
+    iterator->previous_first = 0;
+    //Starts at the block of the game, and decodes the games before it in the block
+    int block = iterator->next / GAME_ARCHIVE_BLOCK_GAMES;
+    int skipped = iterator->next - block * GAME_ARCHIVE_BLOCK_GAMES;
+    iterator->next = block * GAME_ARCHIVE_BLOCK_GAMES;
+    Game games[GAME_ARCHIVE_BLOCK_GAMES];
+    gameArchiveIteratorRead(iterator, games, skipped);
+}
+
+bool gameArchiveIteratorNext(GameArchiveIterator* iterator, Game* game)
+{
+    return gameArchiveIteratorRead(iterator, game, 1) == 1;
+}
+
+//Decodes the games block by block, so the loop over the games of a block does not check for the next block
+int gameArchiveIteratorRead(GameArchiveIterator* iterator, Game* games, int count)
+{
+    assert(iterator != NULL && (games != NULL || count <= 0));
+    int read = 0;
+    while (read < count && iterator->next < iterator->games_count) {
+        unsigned index = (unsigned)iterator->next % GAME_ARCHIVE_BLOCK_GAMES;
+        if (index == 0) {
+            int block = iterator->next / GAME_ARCHIVE_BLOCK_GAMES;
+            iterator->results = iterator->archive + ((const size_t*)iterator->archive)[block];
+            iterator->position = iterator->results + BLOCK_RESULTS_SIZE;
+            iterator->previous_first = 0;
+        }
+        int end = GAME_ARCHIVE_BLOCK_GAMES - (int)index;
+        end = count - read < end ? count - read : end;
+        end = iterator->games_count - iterator->next < end ? iterator->games_count - iterator->next : end;
+        const unsigned char *position = iterator->position, *results = iterator->results;
+        uint32_t previous_first = iterator->previous_first;
+        for (int i = 0; i < end; i++, index++) {
+            Game *game = &games[read + i];
+            uint32_t first = readVarint(&position), second = readVarint(&position);
+            first = previous_first + ((first >> 1) ^ -(first & 1));
+            second = first + ((second >> 1) ^ -(second & 1));
+            game->players_slot[0] = (int)first;
+            game->players_slot[1] = (int)second;
+            game->duration = (int)readVarint(&position);
+            uint32_t result = (results[index / RESULTS_PER_BYTE] >> (RESULT_BITS * (index % RESULTS_PER_BYTE))) &
+                              RESULT_MASK;
+            game->result = (Winner)(result == OTHER_RESULT ? (int)readVarint(&position) : (int)result);
+            previous_first = first;
+        }
+        iterator->position = position;
+        iterator->previous_first = previous_first;
+        iterator->next += end;
+        read += end;
+    }
+    return read;
+}
+
+static int getBlocksCount(int games_count)
+{
+    return (games_count + GAME_ARCHIVE_BLOCK_GAMES - 1) / GAME_ARCHIVE_BLOCK_GAMES;
+}
+
+static uint32_t getResultBits(Winner result)
+{
+    return result == FIRST_PLAYER || result == SECOND_PLAYER || result == DRAW ? (uint32_t)result : OTHER_RESULT;
+}
+
+//Zigzag encoding, so small differences of either sign take few bytes
+static uint32_t encodeDifference(int value, int base)
+{
+    uint32_t difference = (uint32_t)value - (uint32_t)base;
+    return (difference << 1) ^ ((difference >> 31) ? UINT32_MAX : 0);
+}
+
+static size_t getVarintSize(uint32_t value)
+{
+    size_t size = 1;
+    while (value >= VARINT_MORE) {
+        value >>= VARINT_BITS;
+        size++;
+    }
+    return size;
+}
+
+static unsigned char* writeVarint(unsigned char* position, uint32_t value)
+{
+    while (value >= VARINT_MORE) {
+        *position++ = (unsigned char)(value | VARINT_MORE);
+        value >>= VARINT_BITS;
+    }
+    *position++ = (unsigned char)value;
+    return position;
+}
+
+//Most varints take one or two bytes, so those are read without a loop
+static inline uint32_t readVarint(const unsigned char** position)
+{
+    const unsigned char *byte = *position;
+    uint32_t value = byte[0];
+    if (value < VARINT_MORE) {
+        *position = byte + 1;
+        return value;
+    }
+    value = (value & ~VARINT_MORE) | (uint32_t)byte[1] << VARINT_BITS;
+    if (byte[1] < VARINT_MORE) {
+        *position = byte + 2;
+        return value;
+    }
+    value &= ~((uint32_t)VARINT_MORE << VARINT_BITS);
+    byte++;
+    for (int shift = 2 * VARINT_BITS; *byte++ & VARINT_MORE; shift += VARINT_BITS) {
+        value |= (uint32_t)(*byte & ~VARINT_MORE) << shift;
+    }
+    *position = byte;
+    return value;
+}
+
+static size_t getGameSize(const Game* game, int previous_first)
+{
+    size_t size = getVarintSize(encodeDifference(game->players_slot[0], previous_first)) +
+                  getVarintSize(encodeDifference(game->players_slot[1], game->players_slot[0])) +
+                  getVarintSize((uint32_t)game->duration);
+    if (getResultBits(game->result) == OTHER_RESULT) {
+        size += getVarintSize((uint32_t)game->result);
+    }
+    return size;
+}
+
+static unsigned char* writeGame(unsigned char* position, const Game* game, int previous_first)
+{
+    position = writeVarint(position, encodeDifference(game->players_slot[0], previous_first));
+    position = writeVarint(position, encodeDifference(game->players_slot[1], game->players_slot[0]));
+    position = writeVarint(position, (uint32_t)game->duration);
+    if (getResultBits(game->result) == OTHER_RESULT) {
+        position = writeVarint(position, (uint32_t)game->result);
+    }
+    return position;
+}
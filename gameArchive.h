@@ -0,0 +1,45 @@
+#ifndef _GAME_ARCHIVE_H
+#define _GAME_ARCHIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game.h"
+
+/**
+* Compact encoding of the games of a tournament that can no longer change.
+*
+* The games are split into blocks of GAME_ARCHIVE_BLOCK_GAMES, and the archive starts with the offset of every
+* block, so decoding can start at any block. A block starts with the results of its games, 2 bits each, and
+* then has the rest of every game as varints: the first player's slot as the difference from the previous
+* game's first player, the second player's slot as the difference from the first, and the duration. A result
+* that is not a Winner is marked in the bits and follows the duration. Player slots are small and games of the
+* same players tend to follow each other, so most games take 3 or 4 bytes instead of the 16 of a Game.
+*
+* The following functions are available:
+*   gameArchiveGetSize		- Returns the size of the archive of some games
+*   gameArchiveWrite		- Encodes games into an archive of that size
+*   gameArchiveIteratorInit	- Starts decoding an archive at one of its games
+*   gameArchiveIteratorNext	- Decodes the next game, returns false after the last one
+*   gameArchiveIteratorRead	- Decodes up to a number of the next games at once, returns how many it decoded
+*/
+
+#define GAME_ARCHIVE_BLOCK_GAMES 128
+
+typedef struct GameArchiveIterator {
+    const unsigned char *archive;
+    const unsigned char *position; //Of the next game's varints
+    const unsigned char *results; //Of the current block
+    int games_count;
+    int next; //The index of the next game
+    uint32_t previous_first; //The first player of the previous game in the block
+} GameArchiveIterator;
+
+size_t gameArchiveGetSize(const Game* games, int games_count);
+void gameArchiveWrite(const Game* games, int games_count, unsigned char* archive);
+void gameArchiveIteratorInit(GameArchiveIterator* iterator, const unsigned char* archive, int games_count,
+                             int first);
+bool gameArchiveIteratorNext(GameArchiveIterator* iterator, Game* game);
+int gameArchiveIteratorRead(GameArchiveIterator* iterator, Game* games, int count);
+
+#endif //_GAME_ARCHIVE_H
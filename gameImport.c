@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include "chessSystem.h"
+
+#define IMPORT_BUFFER_SIZE (1 << 20)
+#define IMPORT_BATCH_SIZE 4096
+#define BINARY_FIELDS 5
+#define BINARY_FIELD_SIZE 4
+#define BINARY_RECORD_SIZE (BINARY_FIELDS * BINARY_FIELD_SIZE)
+#define BITS_PER_BYTE 8
+#define CSV_SEPARATOR ','
+
+/*
+ * Games are parsed straight out of a large read buffer into a batch, which is added with chessAddGames
+ * whenever it fills up. A record that is cut by the end of the buffer is moved to its start and completed
+ * by the next read.
+ */
+typedef struct Importer {
+    ChessSystem chess;
+    ChessImportReport *report;
+    bool skipping_line; //The rest of a CSV line that did not fit in the buffer is ignored
+    size_t count;
+    ChessGameRecord games[IMPORT_BATCH_SIZE];
+    ChessResult results[IMPORT_BATCH_SIZE];
+} Importer;
+
+static ChessResult importFile(Importer* importer, FILE* file, ChessImportFormat format, char* buffer);
+static size_t parseCsv(Importer* importer, const char* data, size_t length, bool last);
+static size_t parseBinary(Importer* importer, const char* data, size_t length, bool last);
+static bool parseCsvLine(const char* line, const char* end, ChessGameRecord* game);
+static bool parseCsvInt(const char** position, const char* end, int* number);
+static int32_t decodeInt32(const unsigned char* bytes);
+static ChessResult flushBatch(Importer* importer);
+
+
+ChessResult chessImportGames(ChessSystem chess, const char* path, ChessImportFormat format,
+                             ChessImportReport* report)
+{
+    if (chess == NULL || path == NULL || report == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    memset(report, 0, sizeof(*report));
+    if (format != CHESS_IMPORT_CSV && format != CHESS_IMPORT_BINARY) {
+        return CHESS_LOAD_FAILURE;
+    }
+    Importer *importer = malloc(sizeof(*importer));
+    char *buffer = malloc(IMPORT_BUFFER_SIZE);
+    if (importer == NULL || buffer == NULL) {
+        free(importer);
+        free(buffer);
+        return CHESS_OUT_OF_MEMORY;
+    }
+    importer->chess = chess;
+    importer->report = report;
+    importer->skipping_line = false;
+    importer->count = 0;
+    ChessResult result = CHESS_LOAD_FAILURE;
+    FILE *file = fopen(path, format == CHESS_IMPORT_CSV ? "r" : "rb");
+    if (file != NULL) {
+        result = importFile(importer, file, format, buffer);
+        fclose(file);
+    }
+    free(buffer);
+    free(importer);
+    return result;
+}
+
+static ChessResult importFile(Importer* importer, FILE* file, ChessImportFormat format, char* buffer)
+{
+    size_t length = 0;
+    bool end_of_file = false;
+    while (!end_of_file || length > 0) {
+        if (!end_of_file) {
+            length += fread(buffer + length, 1, IMPORT_BUFFER_SIZE - length, file);
+            if (ferror(file)) {
+                return CHESS_LOAD_FAILURE;
+            }
+            end_of_file = feof(file);
+        }
+        size_t used = format == CHESS_IMPORT_CSV ? parseCsv(importer, buffer, length, end_of_file) :
+                                                   parseBinary(importer, buffer, length, end_of_file);
+        if (used == 0 && length == IMPORT_BUFFER_SIZE && importer->count < IMPORT_BATCH_SIZE) {
+            //A CSV line longer than the whole buffer can not be a valid game
+            importer->report->malformed += !importer->skipping_line;
+            importer->skipping_line = true;
+            used = length;
+        }
+        memmove(buffer, buffer + used, length - used);
+        length -= used;
+        if (importer->count == IMPORT_BATCH_SIZE || (end_of_file && length == 0)) {
+            ChessResult result = flushBatch(importer);
+            if (result != CHESS_SUCCESS) {
+                return result;
+            }
+        }
+    }
+    return CHESS_SUCCESS;
+}
+
+/*
+ * Both parsers return the number of bytes they used. They stop before an incomplete record, unless it is the
+ * last one in the file, and when the batch is full.
+ */
+static size_t parseCsv(Importer* importer, const char* data, size_t length, bool last)
+{
+    size_t used = 0;
+    while (used < length && importer->count < IMPORT_BATCH_SIZE) {
+        const char *line = data + used;
+        const char *end = memchr(line, '\n', length - used);
+        if (end == NULL && !last) {
+            break;
+        }
+        size_t line_length = end == NULL ? length - used : (size_t)(end - line);
+        used += end == NULL ? line_length : line_length + 1;
+        if (importer->skipping_line) {
+            importer->skipping_line = false;
+            continue;
+        }
+        if (line_length > 0 && line[line_length - 1] == '\r') {
+            line_length--;
+        }
+        if (line_length == 0) {
+            continue;
+        }
+        if (!parseCsvLine(line, line + line_length, &importer->games[importer->count])) {
+            importer->report->malformed++;
+            continue;
+        }
+        importer->count++;
+    }
+    return used;
+}
+
+static size_t parseBinary(Importer* importer, const char* data, size_t length, bool last)
+{
+    size_t used = 0;
+    while (length - used >= BINARY_RECORD_SIZE && importer->count < IMPORT_BATCH_SIZE) {
+        const unsigned char *record = (const unsigned char*)data + used;
+        ChessGameRecord *game = &importer->games[importer->count];
+        game->tournament_id = decodeInt32(record);
+        game->first_player = decodeInt32(record + BINARY_FIELD_SIZE);
+        game->second_player = decodeInt32(record + 2 * BINARY_FIELD_SIZE);
+        int32_t winner = decodeInt32(record + 3 * BINARY_FIELD_SIZE);
+        game->play_time = decodeInt32(record + 4 * BINARY_FIELD_SIZE);
+        used += BINARY_RECORD_SIZE;
+        if (winner != FIRST_PLAYER && winner != SECOND_PLAYER && winner != DRAW) {
+            importer->report->malformed++;
+            continue;
+        }
+        game->winner = (Winner)winner;
+        importer->count++;
+    }
+    if (last && used < length && length - used < BINARY_RECORD_SIZE) {
+        importer->report->malformed++; //A truncated last record
+        used = length;
+    }
+    return used;
+}
+
+static bool parseCsvLine(const char* line, const char* end, ChessGameRecord* game)
+{
+    int winner;
+    if (!parseCsvInt(&line, end, &game->tournament_id) ||
+        !parseCsvInt(&line, end, &game->first_player) ||
+        !parseCsvInt(&line, end, &game->second_player) ||
+        !parseCsvInt(&line, end, &winner) ||
+        !parseCsvInt(&line, end, &game->play_time) || line != end + 1) {
+        return false;
+    }
+    if (winner != FIRST_PLAYER && winner != SECOND_PLAYER && winner != DRAW) {
+        return false;
+    }
+    game->winner = (Winner)winner;
+    return true;
+}
+
+//Parses a number and the separator or line end after it, and moves the position past both.
+static bool parseCsvInt(const char** position, const char* end, int* number)
+{
+    const char *current = *position;
+    if (current >= end) {
+        return false;
+    }
+    bool negative = *current == '-';
+    current += negative;
+    if (current == end || *current < '0' || *current > '9') {
+        return false;
+    }
+    long long value = 0;
+    while (current < end && *current >= '0' && *current <= '9') {
+        value = value * 10 + (*current - '0');
+        if (value > (long long)INT_MAX + negative) {
+            return false;
+        }
+        current++;
+    }
+    if (current != end && *current != CSV_SEPARATOR) {
+        return false;
+    }
+    *number = (int)(negative ? -value : value);
+    *position = current + 1;
+    return true;
+}
+
+static int32_t decodeInt32(const unsigned char* bytes)
+{
+    uint32_t value = 0;
+    for (int i = BINARY_FIELD_SIZE - 1; i >= 0; i--) {
+        value = (value << BITS_PER_BYTE) | bytes[i];
+    }
+    return value > INT32_MAX ? -(int32_t)(UINT32_MAX - value) - 1 : (int32_t)value;
+}
+
+static ChessResult flushBatch(Importer* importer)
+{
+    ChessResult result = chessAddGames(importer->chess, importer->games, importer->count, importer->results);
+    if (result != CHESS_SUCCESS) {
+        return result;
+    }
+    for (size_t i = 0; i < importer->count; i++) {
+        assert(importer->results[i] < CHESS_RESULT_COUNT);
+        importer->report->results[importer->results[i]]++;
+    }
+    importer->count = 0;
+    return CHESS_SUCCESS;
+}
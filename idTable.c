@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include "idTable.h"
+
+#define INIT_SIZE 16
+#define EXPAND_FACTOR 2
+#define HASH_MULTIPLIER 2654435761u
+
+typedef struct IdTableEntry {
+    int id;
+    int slot;
+} IdTableEntry;
+
+typedef struct IdTable_t {
+    Arena arena;
+    IdTableEntry *entries;
+    int max_size;
+    int size;
+} IdTable_t;
+
+static int findEntry(const IdTableEntry* entries, int max_size, int id);
+static IdTableEntry* allocateEntries(Arena arena, int max_size);
+static bool tableResize(IdTable table, int new_size);
+
+
+IdTable idTableCreate(Arena arena)
+{
+    IdTable table = arenaAllocate(arena, sizeof(*table));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->entries = allocateEntries(arena, INIT_SIZE);
+    if (table->entries == NULL) {
+        arenaFree(arena, table, sizeof(*table));
+        return NULL;
+    }
+    table->arena = arena;
+    table->max_size = INIT_SIZE;
+    table->size = 0;
+    return table;
+}
+
+void idTableDestroy(IdTable table)
+{
+    if (table != NULL) {
+        arenaFree(table->arena, table->entries, sizeof(IdTableEntry) * table->max_size);
+        arenaFree(table->arena, table, sizeof(*table));
+    }
+}
+
+IdTable idTableCopy(IdTable table, Arena arena)
+{
+    if (table == NULL) {
+        return NULL;
+    }
+    IdTable copy = arenaAllocate(arena, sizeof(*copy));
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->entries = arenaAllocate(arena, sizeof(IdTableEntry) * table->max_size);
+    if (copy->entries == NULL) {
+        arenaFree(arena, copy, sizeof(*copy));
+        return NULL;
+    }
+    copy->arena = arena;
+    memcpy(copy->entries, table->entries, sizeof(IdTableEntry) * table->max_size);
+    copy->max_size = table->max_size;
+    copy->size = table->size;
+    return copy;
+}
+
+int idTableGetSize(IdTable table)
+{
+    if (table == NULL) {
+        return -1;
+    }
+    return table->size;
+}
+
+int idTableFind(IdTable table, int id)
+{
+    if (table == NULL) {
+        return ID_TABLE_NOT_FOUND;
+    }
+    return table->entries[findEntry(table->entries, table->max_size, id)].slot;
+}
+
+int idTableAdd(IdTable table, int id)
+{
+    if (table == NULL) {
+        return ID_TABLE_NOT_FOUND;
+    }
+    int index = findEntry(table->entries, table->max_size, id);
+    if (table->entries[index].slot != ID_TABLE_NOT_FOUND) {
+        return table->entries[index].slot;
+    }
+    if (2 * (table->size + 1) > table->max_size) { //Keeps the table at most half full
+        if (!tableResize(table, EXPAND_FACTOR * table->max_size)) {
+            return ID_TABLE_NOT_FOUND;
+        }
+        index = findEntry(table->entries, table->max_size, id);
+    }
+    table->entries[index].id = id;
+    table->entries[index].slot = table->size++;
+    return table->entries[index].slot;
+}
+
+bool idTableReserve(IdTable table, int size)
+{
+    assert(table != NULL);
+    int new_size = table->max_size;
+    while (2 * size > new_size) {
+        new_size *= EXPAND_FACTOR;
+    }
+    return new_size == table->max_size || tableResize(table, new_size);
+}
+
+//Returns the index of the id's entry, or of the empty entry where it should be added.
+static int findEntry(const IdTableEntry* entries, int max_size, int id)
+{
+    int mask = max_size - 1;
+    unsigned int hash = (unsigned int)id * HASH_MULTIPLIER;
+    int index = (int)((hash ^ (hash >> 16)) & mask);
+    while (entries[index].slot != ID_TABLE_NOT_FOUND && entries[index].id != id) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+static IdTableEntry* allocateEntries(Arena arena, int max_size)
+{
+    IdTableEntry *entries = arenaAllocate(arena, sizeof(IdTableEntry) * max_size);
+    if (entries == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < max_size; i++) {
+        entries[i].slot = ID_TABLE_NOT_FOUND;
+    }
+    return entries;
+}
+
+static bool tableResize(IdTable table, int new_size)
+{
+    IdTableEntry *entries = allocateEntries(table->arena, new_size);
+    if (entries == NULL) {
+        return false;
+    }
+    for (int i = 0; i < table->max_size; i++) {
+        if (table->entries[i].slot != ID_TABLE_NOT_FOUND) {
+            entries[findEntry(entries, new_size, table->entries[i].id)] = table->entries[i];
+        }
+    }
+    arenaFree(table->arena, table->entries, sizeof(IdTableEntry) * table->max_size);
+    table->entries = entries;
+    table->max_size = new_size;
+    return true;
+}
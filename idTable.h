@@ -0,0 +1,38 @@
+#ifndef _ID_TABLE_H
+#define _ID_TABLE_H
+
+/**
+* Index from ids to dense slots.
+*
+* Every id added to the table gets the next free slot, starting from 0, so the slots can be used
+* directly as indices into a flat array that holds the data of the ids. The index is an open
+* addressing hash table, lookups and insertions take O(1) on average and never allocate per id.
+* A table allocates from the arena it is created with, or from the heap if the arena is NULL.
+*
+* The following functions are available:
+*   idTableCreate	- Creates a new empty table
+*   idTableDestroy	- Deletes an existing table and frees all resources
+*   idTableCopy	- Copies an existing table into an arena
+*   idTableGetSize	- Returns the number of ids in the table, which is also the next free slot
+*   idTableFind	- Returns the slot of an id, or ID_TABLE_NOT_FOUND
+*   idTableAdd		- Returns the slot of an id, giving it the next free slot if it is new
+*   idTableReserve	- Makes room for a number of ids, so adding them does not have to grow the table
+*/
+
+#include <stdbool.h>
+#include "arena.h"
+
+#define ID_TABLE_NOT_FOUND -1
+
+/** Type for defining the id table */
+typedef struct IdTable_t *IdTable;
+
+IdTable idTableCreate(Arena arena);
+void idTableDestroy(IdTable table);
+IdTable idTableCopy(IdTable table, Arena arena);
+int idTableGetSize(IdTable table);
+int idTableFind(IdTable table, int id);
+int idTableAdd(IdTable table, int id);
+bool idTableReserve(IdTable table, int size);
+
+#endif //_ID_TABLE_H
@@ -0,0 +1,357 @@
+#define _POSIX_C_SOURCE 200112L //For sched_yield
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include "chessSystem.h"
+
+#define MAX_CAPACITY (1 << 30)
+#define APPLY_BATCH_SIZE 1024
+#define MIN_CELLS 2 //With one cell, a filled cell would look free for the next round
+#define IDLE_SPINS 64 //Times the apply thread finds the queue empty before it sleeps
+#define FUTURE_SPINS 64 //Times a waiter finds its future not done before it sleeps
+
+/*
+ * A bounded multi producer single consumer ring of games. Every cell has a sequence number that says whose turn
+ * it is: a producer may fill the cell at position p when its sequence is p, and marks it filled by setting it to
+ * p + 1. The apply thread empties it and sets it to p + capacity, the position of the next round. Producers claim
+ * positions with a compare and swap on enqueue_position, so no producer ever waits for a lock.
+ */
+typedef struct QueueCell {
+    size_t sequence;
+    ChessGameRecord game;
+    ChessGameCallback callback;
+    void *context;
+} QueueCell;
+
+typedef struct ChessIngestQueue_t {
+    ChessSystem chess;
+    ChessIngestPolicy policy;
+    QueueCell *cells;
+    size_t mask; //The capacity is a power of 2
+    size_t enqueue_position;
+    size_t dequeue_position; //Only used by the apply thread
+    size_t applied; //The number of games whose callbacks were called
+    bool stopping;
+    bool sleeping; //Set by the apply thread before it waits for games
+    pthread_mutex_t lock; //Only protects the sleep of the apply thread
+    pthread_cond_t games_available;
+    size_t waiters; //Threads sleeping until their futures are done
+    pthread_mutex_t futures_lock; //Only protects the sleep of the waiters
+    pthread_cond_t futures_done;
+    pthread_t apply_thread;
+    ChessGameRecord games[APPLY_BATCH_SIZE];
+    ChessResult results[APPLY_BATCH_SIZE];
+    ChessGameCallback callbacks[APPLY_BATCH_SIZE];
+    void *contexts[APPLY_BATCH_SIZE];
+} ChessIngestQueue_t;
+
+static bool tryEnqueue(ChessIngestQueue queue, const ChessGameRecord* game, ChessGameCallback callback,
+                       void* context);
+static void wakeApplyThread(ChessIngestQueue queue);
+static void* applyGames(void* argument);
+static int dequeueBatch(ChessIngestQueue queue);
+static void waitForGames(ChessIngestQueue queue);
+static bool isEmpty(ChessIngestQueue queue);
+static void completeFuture(const ChessGameRecord* game, ChessResult result, void* context);
+static void waitForFuture(ChessGameFuture* future);
+static void wakeWaiters(ChessIngestQueue queue);
+static void destroyQueue(ChessIngestQueue queue, int locks);
+
+
+ChessIngestQueue chessIngestQueueCreate(ChessSystem chess, int capacity, ChessIngestPolicy policy)
+{
+    if (chess == NULL || capacity <= 0 || capacity > MAX_CAPACITY ||
+        (policy != CHESS_INGEST_BLOCK && policy != CHESS_INGEST_FAIL)) {
+        return NULL;
+    }
+    ChessIngestQueue queue = malloc(sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    size_t cells_count = MIN_CELLS;
+    while (cells_count < (size_t)capacity) {
+        cells_count *= 2;
+    }
+    queue->cells = malloc(sizeof(QueueCell) * cells_count);
+    if (queue->cells == NULL) {
+        free(queue);
+        return NULL;
+    }
+    for (size_t i = 0; i < cells_count; i++) {
+        queue->cells[i].sequence = i;
+    }
+    queue->chess = chess;
+    queue->policy = policy;
+    queue->mask = cells_count - 1;
+    queue->enqueue_position = 0;
+    queue->dequeue_position = 0;
+    queue->applied = 0;
+    queue->stopping = false;
+    queue->sleeping = false;
+    queue->waiters = 0;
+    if (pthread_mutex_init(&queue->lock, NULL) != 0) {
+        destroyQueue(queue, 0);
+        return NULL;
+    }
+    if (pthread_cond_init(&queue->games_available, NULL) != 0) {
+        destroyQueue(queue, 1);
+        return NULL;
+    }
+    if (pthread_mutex_init(&queue->futures_lock, NULL) != 0) {
+        destroyQueue(queue, 2);
+        return NULL;
+    }
+    if (pthread_cond_init(&queue->futures_done, NULL) != 0) {
+        destroyQueue(queue, 3);
+        return NULL;
+    }
+    if (pthread_create(&queue->apply_thread, NULL, applyGames, queue) != 0) {
+        destroyQueue(queue, 4);
+        return NULL;
+    }
+    return queue;
+}
+
+void chessIngestQueueDestroy(ChessIngestQueue queue)
+{
+    if (queue == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&queue->lock);
+    __atomic_store_n(&queue->stopping, true, __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&queue->games_available);
+    pthread_mutex_unlock(&queue->lock);
+    pthread_join(queue->apply_thread, NULL);
+    destroyQueue(queue, 4);
+}
+
+//Frees a queue of which the first locks, of lock, games_available, futures_lock and futures_done, were set up
+static void destroyQueue(ChessIngestQueue queue, int locks)
+{
+    if (locks > 3) {
+        pthread_cond_destroy(&queue->futures_done);
+    }
+    if (locks > 2) {
+        pthread_mutex_destroy(&queue->futures_lock);
+    }
+    if (locks > 1) {
+        pthread_cond_destroy(&queue->games_available);
+    }
+    if (locks > 0) {
+        pthread_mutex_destroy(&queue->lock);
+    }
+    free(queue->cells);
+    free(queue);
+}
+
+ChessResult chessIngestQueueSubmit(ChessIngestQueue queue, const ChessGameRecord* game,
+                                   ChessGameCallback callback, void* context)
+{
+    if (queue == NULL || game == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    while (!tryEnqueue(queue, game, callback, context)) {
+        if (queue->policy == CHESS_INGEST_FAIL) {
+            return CHESS_QUEUE_FULL;
+        }
+        sched_yield();
+    }
+    wakeApplyThread(queue);
+    return CHESS_SUCCESS;
+}
+
+ChessResult chessIngestQueueSubmitFuture(ChessIngestQueue queue, const ChessGameRecord* game,
+                                         ChessGameFuture* future)
+{
+    if (future == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    future->done = false;
+    future->queue = queue;
+    ChessResult result = chessIngestQueueSubmit(queue, game, completeFuture, future);
+    if (result != CHESS_SUCCESS) {
+        completeFuture(game, result, future); //No thread waits for it yet
+    }
+    return result;
+}
+
+ChessResult chessGameFutureWait(ChessGameFuture* future)
+{
+    if (future == NULL) {
+        return CHESS_NULL_ARGUMENT;
+    }
+    for (int spins = 0; !chessGameFutureIsDone(future); spins++) {
+        if (spins >= FUTURE_SPINS) {
+            waitForFuture(future);
+            break;
+        }
+        sched_yield();
+    }
+    return future->result;
+}
+
+/*
+ * The waiter counts itself and then checks its future, and the apply thread completes the futures of a batch and
+ * then checks the count, both with full fences. So either the apply thread sees the waiter, or the waiter sees
+ * its future done.
+ */
+static void waitForFuture(ChessGameFuture* future)
+{
+    ChessIngestQueue queue = future->queue;
+    pthread_mutex_lock(&queue->futures_lock);
+    __atomic_add_fetch(&queue->waiters, 1, __ATOMIC_SEQ_CST);
+    while (!chessGameFutureIsDone(future)) {
+        pthread_cond_wait(&queue->futures_done, &queue->futures_lock);
+    }
+    __atomic_sub_fetch(&queue->waiters, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&queue->futures_lock);
+}
+
+static void wakeWaiters(ChessIngestQueue queue)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&queue->waiters, __ATOMIC_RELAXED) > 0) {
+        pthread_mutex_lock(&queue->futures_lock);
+        pthread_cond_broadcast(&queue->futures_done);
+        pthread_mutex_unlock(&queue->futures_lock);
+    }
+}
+
+bool chessGameFutureIsDone(const ChessGameFuture* future)
+{
+    return future != NULL && __atomic_load_n(&future->done, __ATOMIC_ACQUIRE);
+}
+
+void chessIngestQueueFlush(ChessIngestQueue queue)
+{
+    if (queue == NULL) {
+        return;
+    }
+    size_t submitted = __atomic_load_n(&queue->enqueue_position, __ATOMIC_ACQUIRE);
+    while (__atomic_load_n(&queue->applied, __ATOMIC_ACQUIRE) < submitted) {
+        sched_yield();
+    }
+}
+
+static bool tryEnqueue(ChessIngestQueue queue, const ChessGameRecord* game, ChessGameCallback callback,
+                       void* context)
+{
+    size_t position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+    QueueCell *cell;
+    while (true) {
+        cell = &queue->cells[position & queue->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&queue->enqueue_position, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            return false; //The cell still holds a game of the previous round, so the queue is full
+        }
+        else {
+            position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+        }
+    }
+    cell->game = *game;
+    cell->callback = callback;
+    cell->context = context;
+    __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/*
+ * The producer publishes the game and then checks sleeping, and the apply thread sets sleeping and then checks
+ * for games, both with full fences. So either the producer sees it sleeping, or it sees the game.
+ */
+static void wakeApplyThread(ChessIngestQueue queue)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&queue->sleeping, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&queue->lock);
+        pthread_cond_signal(&queue->games_available);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+//The queue is emptied before the thread stops, so every submitted game gets its result.
+static void* applyGames(void* argument)
+{
+    ChessIngestQueue queue = argument;
+    int idle = 0;
+    while (true) {
+        int count = dequeueBatch(queue);
+        if (count == 0) {
+            if (__atomic_load_n(&queue->stopping, __ATOMIC_SEQ_CST) && isEmpty(queue)) {
+                return NULL;
+            }
+            if (++idle >= IDLE_SPINS) {
+                waitForGames(queue);
+                idle = 0;
+            }
+            else {
+                sched_yield();
+            }
+            continue;
+        }
+        idle = 0;
+        chessAddGames(queue->chess, queue->games, count, queue->results);
+        for (int i = 0; i < count; i++) {
+            if (queue->callbacks[i] != NULL) {
+                queue->callbacks[i](&queue->games[i], queue->results[i], queue->contexts[i]);
+            }
+        }
+        __atomic_fetch_add(&queue->applied, count, __ATOMIC_RELEASE);
+        wakeWaiters(queue);
+    }
+}
+
+static int dequeueBatch(ChessIngestQueue queue)
+{
+    int count = 0;
+    while (count < APPLY_BATCH_SIZE) {
+        size_t position = queue->dequeue_position;
+        QueueCell *cell = &queue->cells[position & queue->mask];
+        if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+            break;
+        }
+        queue->games[count] = cell->game;
+        queue->callbacks[count] = cell->callback;
+        queue->contexts[count] = cell->context;
+        count++;
+        __atomic_store_n(&cell->sequence, position + queue->mask + 1, __ATOMIC_RELEASE);
+        queue->dequeue_position = position + 1;
+    }
+    return count;
+}
+
+static void waitForGames(ChessIngestQueue queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    __atomic_store_n(&queue->sleeping, true, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    while (isEmpty(queue) && !__atomic_load_n(&queue->stopping, __ATOMIC_SEQ_CST)) {
+        pthread_cond_wait(&queue->games_available, &queue->lock);
+    }
+    __atomic_store_n(&queue->sleeping, false, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+//A claimed cell that is not filled yet counts as empty, its producer wakes the apply thread when it is filled.
+static bool isEmpty(ChessIngestQueue queue)
+{
+    QueueCell *cell = &queue->cells[queue->dequeue_position & queue->mask];
+    return __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != queue->dequeue_position + 1;
+}
+
+static void completeFuture(const ChessGameRecord* game, ChessResult result, void* context)
+{
+    ChessGameFuture *future = context;
+    future->result = result;
+    __atomic_store_n(&future->done, true, __ATOMIC_RELEASE);
+}
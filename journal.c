@@ -0,0 +1,225 @@
+#define _POSIX_C_SOURCE 200112L //For fsync and ftruncate
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "journal.h"
+#include "snapshot.h"
+
+#define MAX_VARINT_SIZE 5
+#define MAX_RECORD_HEADER_SIZE (1 + (JOURNAL_MAX_INTS + 1) * MAX_VARINT_SIZE) //Type, ints and string length
+#define CHECKSUM_SIZE 4
+#define VARINT_BITS 7
+#define VARINT_MASK 0x7F
+#define VARINT_MORE 0x80
+#define BITS_PER_BYTE 8
+#define BYTE_MASK 0xFF
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+typedef struct Journal_t {
+    FILE *file;
+    int sync_batch;
+    int unsynced; //Records appended since the last sync
+    bool failed;
+    OutputBuffer output;
+} Journal_t;
+
+static const int RECORD_INTS[JOURNAL_RECORD_TYPES] = {2, 5, 1, 1, 1};
+
+static Journal startJournal(FILE* file, int sync_batch);
+static bool findValidSize(const char* path, size_t* valid_size);
+static int encodeVarint(unsigned char* bytes, int number);
+static bool decodeVarint(const JournalReader* reader, size_t* position, int* number);
+static uint32_t updateChecksum(uint32_t checksum, const unsigned char* data, size_t length);
+
+
+Journal journalOpen(const char* path, int sync_batch)
+{
+    assert(path != NULL && sync_batch >= 0);
+    FILE *file = fopen(path, "ab");
+    if (file == NULL) {
+        return NULL;
+    }
+    size_t valid_size;
+    if (!findValidSize(path, &valid_size) || ftruncate(fileno(file), valid_size) != 0) {
+        fclose(file);
+        return NULL;
+    }
+    return startJournal(file, sync_batch);
+}
+
+Journal journalCreate(const char* path, int sync_batch)
+{
+    assert(path != NULL && sync_batch >= 0);
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return NULL;
+    }
+    return startJournal(file, sync_batch);
+}
+
+static Journal startJournal(FILE* file, int sync_batch)
+{
+    Journal journal = malloc(sizeof(*journal));
+    if (journal == NULL) {
+        fclose(file);
+        return NULL;
+    }
+    journal->file = file;
+    journal->sync_batch = sync_batch;
+    journal->unsynced = 0;
+    journal->failed = false;
+    outputBufferInit(&journal->output, journal->file);
+    return journal;
+}
+
+void journalAppend(Journal journal, const JournalRecord* record)
+{
+    assert(journal != NULL && record != NULL && record->type < JOURNAL_RECORD_TYPES);
+    assert((record->type == JOURNAL_ADD_TOURNAMENT) == (record->string != NULL));
+    unsigned char header[MAX_RECORD_HEADER_SIZE];
+    int length = 0;
+    header[length++] = (unsigned char)record->type;
+    for (int i = 0; i < RECORD_INTS[record->type]; i++) {
+        length += encodeVarint(header + length, record->ints[i]);
+    }
+    int string_length = 0;
+    if (record->string != NULL) {
+        string_length = strlen(record->string) + 1;
+        length += encodeVarint(header + length, string_length);
+    }
+    uint32_t checksum = updateChecksum(FNV_OFFSET_BASIS, header, length);
+    checksum = updateChecksum(checksum, (const unsigned char*)record->string, string_length);
+    unsigned char checksum_bytes[CHECKSUM_SIZE];
+    for (int i = 0; i < CHECKSUM_SIZE; i++) {
+        checksum_bytes[i] = (checksum >> (BITS_PER_BYTE * i)) & BYTE_MASK;
+    }
+    outputBufferWriteBytes(&journal->output, header, length);
+    outputBufferWriteBytes(&journal->output, record->string, string_length);
+    outputBufferWriteBytes(&journal->output, checksum_bytes, CHECKSUM_SIZE);
+    if (journal->sync_batch > 0 && ++journal->unsynced >= journal->sync_batch) {
+        journalSync(journal);
+    }
+}
+
+bool journalSync(Journal journal)
+{
+    assert(journal != NULL);
+    bool synced = outputBufferFlush(&journal->output) && fflush(journal->file) == 0 &&
+                  fsync(fileno(journal->file)) == 0;
+    journal->failed = journal->failed || !synced;
+    journal->unsynced = 0;
+    return !journal->failed;
+}
+
+bool journalClose(Journal journal)
+{
+    if (journal == NULL) {
+        return true;
+    }
+    bool synced = journalSync(journal);
+    bool closed = fclose(journal->file) == 0;
+    free(journal);
+    return synced && closed;
+}
+
+void journalReaderInit(JournalReader* reader, const unsigned char* data, size_t size)
+{
+    assert(reader != NULL && (data != NULL || size == 0));
+    reader->data = data;
+    reader->size = size;
+    reader->position = 0;
+}
+
+//Returns false at the end of the journal, and at a torn or corrupt record.
+bool journalReadRecord(JournalReader* reader, JournalRecord* record)
+{
+    size_t position = reader->position;
+    if (position >= reader->size || reader->data[position] >= JOURNAL_RECORD_TYPES) {
+        return false;
+    }
+    record->type = (JournalRecordType)reader->data[position++];
+    for (int i = 0; i < RECORD_INTS[record->type]; i++) {
+        if (!decodeVarint(reader, &position, &record->ints[i])) {
+            return false;
+        }
+    }
+    record->string = NULL;
+    if (record->type == JOURNAL_ADD_TOURNAMENT) {
+        int string_length;
+        if (!decodeVarint(reader, &position, &string_length) || string_length <= 0 ||
+            (size_t)string_length > reader->size - position ||
+            reader->data[position + string_length - 1] != '\0') {
+            return false;
+        }
+        record->string = (const char*)reader->data + position;
+        position += string_length;
+    }
+    if (reader->size - position < CHECKSUM_SIZE) {
+        return false;
+    }
+    uint32_t checksum = 0;
+    for (int i = CHECKSUM_SIZE - 1; i >= 0; i--) {
+        checksum = (checksum << BITS_PER_BYTE) | reader->data[position + i];
+    }
+    if (updateChecksum(FNV_OFFSET_BASIS, reader->data + reader->position, position - reader->position) != checksum) {
+        return false;
+    }
+    reader->position = position + CHECKSUM_SIZE;
+    return true;
+}
+
+//The size of the records before the first torn or corrupt one.
+static bool findValidSize(const char* path, size_t* valid_size)
+{
+    size_t size;
+    unsigned char *data = snapshotReadFile(path, &size);
+    if (data == NULL) {
+        return false;
+    }
+    JournalReader reader;
+    JournalRecord record;
+    journalReaderInit(&reader, data, size);
+    while (journalReadRecord(&reader, &record));
+    *valid_size = reader.position;
+    free(data);
+    return true;
+}
+
+//Zigzag encoding keeps small negative numbers short.
+static int encodeVarint(unsigned char* bytes, int number)
+{
+    uint32_t value = number < 0 ? ((uint32_t)-(number + 1) << 1) | 1 : (uint32_t)number << 1;
+    int length = 0;
+    while (value > VARINT_MASK) {
+        bytes[length++] = (value & VARINT_MASK) | VARINT_MORE;
+        value >>= VARINT_BITS;
+    }
+    bytes[length++] = value;
+    return length;
+}
+
+static bool decodeVarint(const JournalReader* reader, size_t* position, int* number)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < MAX_VARINT_SIZE && *position < reader->size; i++) {
+        unsigned char byte = reader->data[(*position)++];
+        value |= (uint32_t)(byte & VARINT_MASK) << (VARINT_BITS * i);
+        if (!(byte & VARINT_MORE)) {
+            *number = value & 1 ? -(int)(value >> 1) - 1 : (int)(value >> 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t updateChecksum(uint32_t checksum, const unsigned char* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        checksum = (checksum ^ data[i]) * FNV_PRIME;
+    }
+    return checksum;
+}
@@ -0,0 +1,62 @@
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "outputBuffer.h"
+
+/**
+* Append only journal of the changes made to a chess system.
+*
+* Every record is a type byte, the record's ints as zigzag varints, a string for the types that
+* have one, and a 32 bit FNV-1a checksum of all of these. Records are buffered and written in
+* groups: every sync_batch records the file is flushed and synced to the disk, so a crash loses at
+* most the records of the last group. A crash can also leave a torn record at the end of the file;
+* reading stops there, and opening the journal again cuts it off before appending.
+* Write errors are sticky and are reported when the journal is synced or closed.
+*
+* The following functions are available:
+*   journalOpen		- Opens a journal file for appending, creating it if needed
+*   journalCreate		- Starts an empty journal file, replacing the file if it exists
+*   journalAppend		- Appends a record
+*   journalSync		- Writes and syncs all the appended records
+*   journalClose		- Syncs and closes the journal
+*   journalReaderInit	- Starts reading the records of a journal that was read into memory
+*   journalReadRecord	- Reads the next record
+*/
+
+#define JOURNAL_MAX_INTS 5
+
+typedef enum JournalRecordType {
+    JOURNAL_ADD_TOURNAMENT, //tournament_id, max_games_per_player and the location
+    JOURNAL_ADD_GAME, //tournament_id, first_player, second_player, winner and play_time
+    JOURNAL_END_TOURNAMENT, //tournament_id
+    JOURNAL_REMOVE_TOURNAMENT, //tournament_id
+    JOURNAL_REMOVE_PLAYER, //player_id
+    JOURNAL_RECORD_TYPES
+} JournalRecordType;
+
+typedef struct JournalRecord {
+    JournalRecordType type;
+    int ints[JOURNAL_MAX_INTS];
+    const char *string; //NULL for types without a string
+} JournalRecord;
+
+/** Type for defining the journal */
+typedef struct Journal_t *Journal;
+
+typedef struct JournalReader {
+    const unsigned char *data;
+    size_t size;
+    size_t position;
+} JournalReader;
+
+Journal journalOpen(const char* path, int sync_batch);
+Journal journalCreate(const char* path, int sync_batch);
+void journalAppend(Journal journal, const JournalRecord* record);
+bool journalSync(Journal journal);
+bool journalClose(Journal journal);
+void journalReaderInit(JournalReader* reader, const unsigned char* data, size_t size);
+bool journalReadRecord(JournalReader* reader, JournalRecord* record);
+
+#endif //_JOURNAL_H
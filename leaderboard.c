@@ -0,0 +1,307 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "leaderboard.h"
+
+#define NO_NODE -1
+#define INIT_SIZE 4
+#define EXPAND_FACTOR 2
+#define PRIORITY_MULTIPLIER 2654435761u
+
+typedef struct LeaderboardNode {
+    LeaderboardKey key;
+    unsigned int priority;
+    int left;
+    int right;
+} LeaderboardNode;
+
+typedef struct Leaderboard_t {
+    Arena arena;
+    LeaderboardNode *nodes;
+    int size;
+    int max_size;
+    int root;
+} Leaderboard_t;
+
+static int compareKeys(const LeaderboardKey* first, const LeaderboardKey* second);
+static int compareNodesByRank(const void* first, const void* second);
+static unsigned int computePriority(int player_id);
+static int insertNode(Leaderboard leaderboard, int root, int node);
+static int detachNode(Leaderboard leaderboard, int root, const LeaderboardKey* key, int* detached);
+static int mergeNodes(Leaderboard leaderboard, int left, int right);
+static void collectTop(Leaderboard leaderboard, int root, int k, int* players, int* count);
+
+
+Leaderboard leaderboardCreate(Arena arena)
+{
+    Leaderboard leaderboard = arenaAllocate(arena, sizeof(*leaderboard));
+    if (leaderboard == NULL) {
+        return NULL;
+    }
+    leaderboard->nodes = arenaAllocate(arena, sizeof(LeaderboardNode) * INIT_SIZE);
+    if (leaderboard->nodes == NULL) {
+        arenaFree(arena, leaderboard, sizeof(*leaderboard));
+        return NULL;
+    }
+    leaderboard->arena = arena;
+    leaderboard->size = 0;
+    leaderboard->max_size = INIT_SIZE;
+    leaderboard->root = NO_NODE;
+    return leaderboard;
+}
+
+void leaderboardDestroy(Leaderboard leaderboard)
+{
+    if (leaderboard != NULL) {
+        arenaFree(leaderboard->arena, leaderboard->nodes, sizeof(LeaderboardNode) * leaderboard->max_size);
+        arenaFree(leaderboard->arena, leaderboard, sizeof(*leaderboard));
+    }
+}
+
+Leaderboard leaderboardCopy(Leaderboard leaderboard, Arena arena)
+{
+    if (leaderboard == NULL) {
+        return NULL;
+    }
+    Leaderboard copy = arenaAllocate(arena, sizeof(*copy));
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->nodes = arenaAllocate(arena, sizeof(LeaderboardNode) * leaderboard->max_size);
+    if (copy->nodes == NULL) {
+        arenaFree(arena, copy, sizeof(*copy));
+        return NULL;
+    }
+    copy->arena = arena;
+    memcpy(copy->nodes, leaderboard->nodes, sizeof(LeaderboardNode) * leaderboard->size);
+    copy->size = leaderboard->size;
+    copy->max_size = leaderboard->max_size;
+    copy->root = leaderboard->root;
+    return copy;
+}
+
+int leaderboardGetSize(Leaderboard leaderboard)
+{
+    if (leaderboard == NULL) {
+        return -1;
+    }
+    return leaderboard->size;
+}
+
+LeaderboardResult leaderboardReserve(Leaderboard leaderboard, int size)
+{
+    if (leaderboard == NULL) {
+        return LEADERBOARD_NULL_ARGUMENT;
+    }
+    if (size <= leaderboard->max_size) {
+        return LEADERBOARD_SUCCESS;
+    }
+    int new_size = leaderboard->max_size;
+    while (new_size < size) {
+        new_size *= EXPAND_FACTOR;
+    }
+    LeaderboardNode *nodes = arenaReallocate(leaderboard->arena, leaderboard->nodes,
+                                             sizeof(LeaderboardNode) * leaderboard->max_size,
+                                             sizeof(LeaderboardNode) * new_size);
+    if (nodes == NULL) {
+        return LEADERBOARD_OUT_OF_MEMORY;
+    }
+    leaderboard->nodes = nodes;
+    leaderboard->max_size = new_size;
+    return LEADERBOARD_SUCCESS;
+}
+
+LeaderboardResult leaderboardInsert(Leaderboard leaderboard, const LeaderboardKey* key)
+{
+    if (leaderboard == NULL || key == NULL) {
+        return LEADERBOARD_NULL_ARGUMENT;
+    }
+    if (leaderboardReserve(leaderboard, leaderboard->size + 1) != LEADERBOARD_SUCCESS) {
+        return LEADERBOARD_OUT_OF_MEMORY;
+    }
+    int node = leaderboard->size++;
+    leaderboard->nodes[node].key = *key;
+    leaderboard->nodes[node].priority = computePriority(key->player_id);
+    leaderboard->nodes[node].left = NO_NODE;
+    leaderboard->nodes[node].right = NO_NODE;
+    leaderboard->root = insertNode(leaderboard, leaderboard->root, node);
+    return LEADERBOARD_SUCCESS;
+}
+
+/*
+ * The nodes are sorted by rank and linked into a treap in one pass, keeping the nodes of its rightmost path on a
+ * stack. Each node becomes the right child of the last node on the stack with a higher priority, and takes the
+ * nodes it pops as its left subtree.
+ */
+LeaderboardResult leaderboardBuild(Leaderboard leaderboard, const LeaderboardKey* keys, int count)
+{
+    if (leaderboard == NULL || (keys == NULL && count > 0)) {
+        return LEADERBOARD_NULL_ARGUMENT;
+    }
+    assert(leaderboard->size == 0 && count >= 0);
+    size_t stack_size = sizeof(int) * (count > 0 ? count : 1);
+    int *stack = arenaAllocate(leaderboard->arena, stack_size);
+    if (stack == NULL || leaderboardReserve(leaderboard, count) != LEADERBOARD_SUCCESS) {
+        arenaFree(leaderboard->arena, stack, stack_size);
+        return LEADERBOARD_OUT_OF_MEMORY;
+    }
+    LeaderboardNode *nodes = leaderboard->nodes;
+    for (int node = 0; node < count; node++) {
+        nodes[node].key = keys[node];
+        nodes[node].priority = computePriority(keys[node].player_id);
+        nodes[node].right = NO_NODE;
+    }
+    qsort(nodes, count, sizeof(LeaderboardNode), compareNodesByRank);
+    int top = 0;
+    for (int node = 0; node < count; node++) {
+        int left = NO_NODE;
+        while (top > 0 && nodes[stack[top - 1]].priority < nodes[node].priority) {
+            left = stack[--top];
+        }
+        nodes[node].left = left;
+        if (top > 0) {
+            nodes[stack[top - 1]].right = node;
+        }
+        stack[top++] = node;
+    }
+    leaderboard->size = count;
+    leaderboard->root = count > 0 ? stack[0] : NO_NODE;
+    arenaFree(leaderboard->arena, stack, stack_size);
+    return LEADERBOARD_SUCCESS;
+}
+
+LeaderboardResult leaderboardUpdate(Leaderboard leaderboard, const LeaderboardKey* old_key,
+                                    const LeaderboardKey* new_key)
+{
+    if (leaderboard == NULL || old_key == NULL || new_key == NULL) {
+        return LEADERBOARD_NULL_ARGUMENT;
+    }
+    assert(old_key->player_id == new_key->player_id);
+    int node = NO_NODE;
+    leaderboard->root = detachNode(leaderboard, leaderboard->root, old_key, &node);
+    if (node == NO_NODE) {
+        return LEADERBOARD_ITEM_DOES_NOT_EXIST;
+    }
+    leaderboard->nodes[node].key = *new_key;
+    leaderboard->nodes[node].left = NO_NODE;
+    leaderboard->nodes[node].right = NO_NODE;
+    leaderboard->root = insertNode(leaderboard, leaderboard->root, node);
+    return LEADERBOARD_SUCCESS;
+}
+
+int leaderboardGetTop(Leaderboard leaderboard, int k, int* players)
+{
+    if (leaderboard == NULL || players == NULL) {
+        return 0;
+    }
+    int count = 0;
+    collectTop(leaderboard, leaderboard->root, k, players, &count);
+    return count;
+}
+
+/*
+ * Returns a positive number if the first key ranks higher than the second one, a negative number
+ * if the second key ranks higher and 0 if both are the same player.
+ */
+static int compareKeys(const LeaderboardKey* first, const LeaderboardKey* second)
+{
+    if (first->score != second->score) {
+        return first->score - second->score;
+    }
+    if (first->losses != second->losses) {
+        return second->losses - first->losses;
+    }
+    if (first->wins != second->wins) {
+        return first->wins - second->wins;
+    }
+    return second->player_id - first->player_id;
+}
+
+//Higher ranked nodes come first.
+static int compareNodesByRank(const void* first, const void* second)
+{
+    return compareKeys(&((const LeaderboardNode*)second)->key, &((const LeaderboardNode*)first)->key);
+}
+
+static unsigned int computePriority(int player_id)
+{
+    unsigned int priority = (unsigned int)player_id * PRIORITY_MULTIPLIER;
+    return priority ^ (priority >> 16);
+}
+
+//Higher ranked players are kept to the left, so an in-order walk visits them from first to last.
+static int insertNode(Leaderboard leaderboard, int root, int node)
+{
+    if (root == NO_NODE) {
+        return node;
+    }
+    LeaderboardNode *nodes = leaderboard->nodes;
+    if (compareKeys(&nodes[node].key, &nodes[root].key) > 0) {
+        nodes[root].left = insertNode(leaderboard, nodes[root].left, node);
+        int left = nodes[root].left;
+        if (nodes[left].priority > nodes[root].priority) {
+            nodes[root].left = nodes[left].right;
+            nodes[left].right = root;
+            return left;
+        }
+    }
+    else {
+        nodes[root].right = insertNode(leaderboard, nodes[root].right, node);
+        int right = nodes[root].right;
+        if (nodes[right].priority > nodes[root].priority) {
+            nodes[root].right = nodes[right].left;
+            nodes[right].left = root;
+            return right;
+        }
+    }
+    return root;
+}
+
+static int detachNode(Leaderboard leaderboard, int root, const LeaderboardKey* key, int* detached)
+{
+    if (root == NO_NODE) {
+        return NO_NODE;
+    }
+    LeaderboardNode *nodes = leaderboard->nodes;
+    int compare = compareKeys(key, &nodes[root].key);
+    if (compare > 0) {
+        nodes[root].left = detachNode(leaderboard, nodes[root].left, key, detached);
+        return root;
+    }
+    if (compare < 0) {
+        nodes[root].right = detachNode(leaderboard, nodes[root].right, key, detached);
+        return root;
+    }
+    *detached = root;
+    return mergeNodes(leaderboard, nodes[root].left, nodes[root].right);
+}
+
+//Every node of the left tree ranks higher than every node of the right tree.
+static int mergeNodes(Leaderboard leaderboard, int left, int right)
+{
+    if (left == NO_NODE) {
+        return right;
+    }
+    if (right == NO_NODE) {
+        return left;
+    }
+    LeaderboardNode *nodes = leaderboard->nodes;
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = mergeNodes(leaderboard, nodes[left].right, right);
+        return left;
+    }
+    nodes[right].left = mergeNodes(leaderboard, left, nodes[right].left);
+    return right;
+}
+
+static void collectTop(Leaderboard leaderboard, int root, int k, int* players, int* count)
+{
+    if (root == NO_NODE || *count >= k) {
+        return;
+    }
+    collectTop(leaderboard, leaderboard->nodes[root].left, k, players, count);
+    if (*count < k) {
+        players[(*count)++] = leaderboard->nodes[root].key.player_id;
+        collectTop(leaderboard, leaderboard->nodes[root].right, k, players, count);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef _LEADERBOARD_H
+#define _LEADERBOARD_H
+
+#include <stdbool.h>
+#include "arena.h"
+
+/**
+* Ordered ranking of the players of a single tournament.
+*
+* The players are kept in a treap whose nodes live in one growable array and refer to each other
+* by index, so a player's node is allocated once and then only moved around inside the tree.
+* Players are ordered by max score, then min losses, then max wins and then min id, which is the
+* order used to choose the winner of a tournament. A leaderboard allocates from the arena it is
+* created with, or from the heap if the arena is NULL.
+*
+* The following functions are available:
+*   leaderboardCreate	- Creates a new empty leaderboard
+*   leaderboardDestroy	- Deletes an existing leaderboard and frees all resources
+*   leaderboardCopy	- Copies an existing leaderboard into an arena
+*   leaderboardGetSize	- Returns the number of players in the leaderboard
+*   leaderboardReserve	- Makes room for a number of players, so inserting them cannot fail
+*   leaderboardInsert	- Adds a new player to the leaderboard. O(log n)
+*   leaderboardBuild	- Adds all the players of an empty leaderboard at once. O(n log n), but faster than inserting
+*   leaderboardUpdate	- Moves a player from its old rank to its new rank. O(log n), never allocates
+*   leaderboardGetTop	- Writes the ids of the k highest ranked players. O(k + log n)
+*/
+
+/** Type for defining the leaderboard */
+typedef struct Leaderboard_t *Leaderboard;
+
+/** Type used for returning error codes from leaderboard functions */
+typedef enum LeaderboardResult_t {
+    LEADERBOARD_SUCCESS,
+    LEADERBOARD_OUT_OF_MEMORY,
+    LEADERBOARD_NULL_ARGUMENT,
+    LEADERBOARD_ITEM_DOES_NOT_EXIST
+} LeaderboardResult;
+
+/** The rank of a single player, players with equal keys are the same player */
+typedef struct LeaderboardKey {
+    int score;
+    int losses;
+    int wins;
+    int player_id;
+} LeaderboardKey;
+
+Leaderboard leaderboardCreate(Arena arena);
+void leaderboardDestroy(Leaderboard leaderboard);
+Leaderboard leaderboardCopy(Leaderboard leaderboard, Arena arena);
+int leaderboardGetSize(Leaderboard leaderboard);
+LeaderboardResult leaderboardReserve(Leaderboard leaderboard, int size);
+LeaderboardResult leaderboardInsert(Leaderboard leaderboard, const LeaderboardKey* key);
+LeaderboardResult leaderboardBuild(Leaderboard leaderboard, const LeaderboardKey* keys, int count);
+LeaderboardResult leaderboardUpdate(Leaderboard leaderboard, const LeaderboardKey* old_key,
+                                    const LeaderboardKey* new_key);
+int leaderboardGetTop(Leaderboard leaderboard, int k, int* players);
+
+#endif //_LEADERBOARD_H
@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "locationTable.h"
+
+#define INIT_SIZE 16
+#define EXPAND_FACTOR 2
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+typedef struct LocationEntry_t {
+    struct LocationEntry_t *next;
+    LocationTable table;
+    unsigned int hash;
+    int references;
+    char name[];
+} LocationEntry_t;
+
+typedef struct LocationTable_t {
+    Location *buckets;
+    int buckets_count;
+    int size;
+} LocationTable_t;
+
+static unsigned int hashName(const char* name);
+static Location findEntry(LocationTable table, const char* name, unsigned int hash);
+static void tableExpand(LocationTable table);
+
+
+LocationTable locationTableCreate()
+{
+    LocationTable table = malloc(sizeof(*table));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->buckets = calloc(INIT_SIZE, sizeof(Location));
+    if (table->buckets == NULL) {
+        free(table);
+        return NULL;
+    }
+    table->buckets_count = INIT_SIZE;
+    table->size = 0;
+    return table;
+}
+
+void locationTableDestroy(LocationTable table)
+{
+    if (table == NULL) {
+        return;
+    }
+    for (int i = 0; i < table->buckets_count; i++) {
+        Location entry = table->buckets[i];
+        while (entry != NULL) {
+            Location next = entry->next;
+            free(entry);
+            entry = next;
+        }
+    }
+    free(table->buckets);
+    free(table);
+}
+
+Location locationTableAcquire(LocationTable table, const char* name)
+{
+    if (table == NULL || name == NULL) {
+        return NULL;
+    }
+    Location entry = findEntry(table, name, hashName(name));
+    return entry == NULL ? NULL : locationAcquire(entry);
+}
+
+Location locationTableAdd(LocationTable table, const char* name)
+{
+    if (table == NULL || name == NULL) {
+        return NULL;
+    }
+    unsigned int hash = hashName(name);
+    Location entry = findEntry(table, name, hash);
+    if (entry != NULL) {
+        return locationAcquire(entry);
+    }
+    entry = malloc(sizeof(*entry) + strlen(name) + 1);
+    if (entry == NULL) {
+        return NULL;
+    }
+    strcpy(entry->name, name);
+    entry->table = table;
+    entry->hash = hash;
+    entry->references = 1;
+    if (table->size >= table->buckets_count) {
+        tableExpand(table); //On failure the table keeps working with longer chains.
+    }
+    int bucket = hash % table->buckets_count;
+    entry->next = table->buckets[bucket];
+    table->buckets[bucket] = entry;
+    table->size++;
+    return entry;
+}
+
+Location locationAcquire(Location location)
+{
+    assert(location != NULL);
+    location->references++;
+    return location;
+}
+
+void locationRelease(Location location)
+{
+    if (location == NULL || --location->references > 0) {
+        return;
+    }
+    LocationTable table = location->table;
+    Location *link = &table->buckets[location->hash % table->buckets_count];
+    while (*link != location) {
+        link = &(*link)->next;
+    }
+    *link = location->next;
+    table->size--;
+    free(location);
+}
+
+const char* locationGetName(Location location)
+{
+    assert(location != NULL);
+    return location->name;
+}
+
+static unsigned int hashName(const char* name)
+{
+    unsigned int hash = FNV_OFFSET;
+    while (*name) {
+        hash = (hash ^ (unsigned char)*name++) * FNV_PRIME;
+    }
+    return hash;
+}
+
+static Location findEntry(LocationTable table, const char* name, unsigned int hash)
+{
+    for (Location entry = table->buckets[hash % table->buckets_count]; entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void tableExpand(LocationTable table)
+{
+    int new_count = EXPAND_FACTOR * table->buckets_count;
+    Location *buckets = calloc(new_count, sizeof(Location));
+    if (buckets == NULL) {
+        return;
+    }
+    for (int i = 0; i < table->buckets_count; i++) {
+        Location entry = table->buckets[i];
+        while (entry != NULL) {
+            Location next = entry->next;
+            entry->next = buckets[entry->hash % new_count];
+            buckets[entry->hash % new_count] = entry;
+            entry = next;
+        }
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->buckets_count = new_count;
+}
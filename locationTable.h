@@ -0,0 +1,35 @@
+#ifndef _LOCATION_TABLE_H
+#define _LOCATION_TABLE_H
+
+/**
+* Intern table of tournament locations.
+*
+* Every distinct location name is stored once, inline in a single reference counted entry, and
+* tournaments refer to it through a Location handle. Only validated names should be added, so
+* finding a name in the table also means it does not have to be validated again.
+*
+* The following functions are available:
+*   locationTableCreate	- Creates a new empty table
+*   locationTableDestroy	- Deletes a table and all its entries
+*   locationTableAcquire	- Returns a new reference to an interned name, or NULL if it is not interned
+*   locationTableAdd		- Interns a new name and returns a reference to it
+*   locationAcquire		- Returns another reference to an interned name
+*   locationRelease		- Drops a reference, the entry is removed with its last reference
+*   locationGetName		- Returns the interned name
+*/
+
+/** Type for defining the location table */
+typedef struct LocationTable_t *LocationTable;
+
+/** Type for a reference to an interned location */
+typedef struct LocationEntry_t *Location;
+
+LocationTable locationTableCreate();
+void locationTableDestroy(LocationTable table);
+Location locationTableAcquire(LocationTable table, const char* name);
+Location locationTableAdd(LocationTable table, const char* name);
+Location locationAcquire(Location location);
+void locationRelease(Location location);
+const char* locationGetName(Location location);
+
+#endif //_LOCATION_TABLE_H
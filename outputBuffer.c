@@ -0,0 +1,178 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "outputBuffer.h"
+
+#define MAX_NUMBER_LENGTH 32
+#define EXPONENT_BITS 0x7FF
+#define MANTISSA_BITS 52
+#define EXPONENT_BIAS 1075 //Bias of the exponent plus the mantissa bits
+#define MAX_FAST_SHIFT 64
+#define MAX_PRINTF_LENGTH 512 //Longer than any double printed with "%0.2f"
+#define EXPAND_FACTOR 2
+
+static void writeUnsigned(OutputBuffer* buffer, uint64_t number, int min_digits);
+static void ensureSpace(OutputBuffer* buffer, int length);
+static bool writeToMemory(OutputBuffer* buffer);
+
+
+void outputBufferInit(OutputBuffer* buffer, FILE* file)
+{
+    assert(buffer != NULL);
+    buffer->file = file;
+    buffer->allocator = NULL;
+    buffer->memory = NULL;
+    buffer->memory_size = 0;
+    buffer->memory_max_size = 0;
+    buffer->size = 0;
+    buffer->failed = false;
+}
+
+void outputBufferInitMemory(OutputBuffer* buffer, const ChessAllocator* allocator)
+{
+    outputBufferInit(buffer, NULL);
+    buffer->allocator = allocator;
+}
+
+void outputBufferWriteBytes(OutputBuffer* buffer, const void* data, int length)
+{
+    const char *bytes = data;
+    while (length > 0) {
+        ensureSpace(buffer, 1);
+        int chunk = OUTPUT_BUFFER_SIZE - buffer->size < length ? OUTPUT_BUFFER_SIZE - buffer->size : length;
+        memcpy(buffer->data + buffer->size, bytes, chunk);
+        buffer->size += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+}
+
+void outputBufferWriteString(OutputBuffer* buffer, const char* string)
+{
+    outputBufferWriteBytes(buffer, string, strlen(string));
+}
+
+void outputBufferWriteChar(OutputBuffer* buffer, char character)
+{
+    ensureSpace(buffer, 1);
+    buffer->data[buffer->size++] = character;
+}
+
+void outputBufferWriteInt(OutputBuffer* buffer, int number)
+{
+    if (number < 0) {
+        outputBufferWriteChar(buffer, '-');
+        writeUnsigned(buffer, -(uint64_t)number & UINT32_MAX, 1);
+        return;
+    }
+    writeUnsigned(buffer, (uint64_t)number, 1);
+}
+
+/*
+ * The double is m * 2^e exactly, so the number of hundredths is m * 100 / 2^-e, rounded the way printf
+ * rounds: to nearest, and ties to even. Numbers too large for that to fit in 64 bits, and non finite
+ * numbers, are left to printf.
+ */
+void outputBufferWriteFixed2(OutputBuffer* buffer, double number)
+{
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    int exponent = (int)((bits >> MANTISSA_BITS) & EXPONENT_BITS);
+    uint64_t mantissa = bits & (((uint64_t)1 << MANTISSA_BITS) - 1);
+    int shift = EXPONENT_BIAS - (exponent == 0 ? 1 : exponent);
+    if (exponent == EXPONENT_BITS || shift <= 0) {
+        char text[MAX_PRINTF_LENGTH];
+        snprintf(text, sizeof(text), "%0.2f", number);
+        outputBufferWriteString(buffer, text);
+        return;
+    }
+    if (exponent != 0) {
+        mantissa |= (uint64_t)1 << MANTISSA_BITS;
+    }
+    uint64_t hundredths = 0;
+    if (shift < MAX_FAST_SHIFT) {
+        uint64_t scaled = mantissa * 100;
+        uint64_t remainder = scaled & (((uint64_t)1 << shift) - 1);
+        uint64_t half = (uint64_t)1 << (shift - 1);
+        hundredths = scaled >> shift;
+        if (remainder > half || (remainder == half && (hundredths & 1))) {
+            hundredths++;
+        }
+    }
+    if (bits >> 63) {
+        outputBufferWriteChar(buffer, '-');
+    }
+    writeUnsigned(buffer, hundredths / 100, 1);
+    outputBufferWriteChar(buffer, '.');
+    writeUnsigned(buffer, hundredths % 100, 2);
+}
+
+bool outputBufferFlush(OutputBuffer* buffer)
+{
+    if (!buffer->failed && buffer->size > 0) {
+        if (buffer->file == NULL) {
+            buffer->failed = !writeToMemory(buffer);
+        }
+        else if (fwrite(buffer->data, 1, buffer->size, buffer->file) != (size_t)buffer->size) {
+            buffer->failed = true;
+        }
+    }
+    buffer->size = 0;
+    return !buffer->failed;
+}
+
+const char* outputBufferGetMemory(const OutputBuffer* buffer, size_t* size)
+{
+    assert(buffer != NULL && buffer->file == NULL && size != NULL);
+    *size = buffer->memory_size;
+    return buffer->memory;
+}
+
+void outputBufferFreeMemory(OutputBuffer* buffer)
+{
+    assert(buffer != NULL && buffer->file == NULL);
+    allocatorFree(buffer->allocator, buffer->memory, buffer->memory_max_size);
+    buffer->memory = NULL;
+    buffer->memory_size = 0;
+    buffer->memory_max_size = 0;
+}
+
+static bool writeToMemory(OutputBuffer* buffer)
+{
+    if (buffer->memory_size + buffer->size > buffer->memory_max_size) {
+        size_t new_size = buffer->memory_max_size == 0 ? OUTPUT_BUFFER_SIZE :
+                          EXPAND_FACTOR * buffer->memory_max_size;
+        char *memory = allocatorReallocate(buffer->allocator, buffer->memory, buffer->memory_max_size, new_size);
+        if (memory == NULL) {
+            return false;
+        }
+        buffer->memory = memory;
+        buffer->memory_max_size = new_size;
+    }
+    memcpy(buffer->memory + buffer->memory_size, buffer->data, buffer->size);
+    buffer->memory_size += buffer->size;
+    return true;
+}
+
+static void writeUnsigned(OutputBuffer* buffer, uint64_t number, int min_digits)
+{
+    char digits[MAX_NUMBER_LENGTH];
+    int length = 0;
+    do {
+        digits[length++] = (char)('0' + number % 10);
+        number /= 10;
+    } while (number > 0 || length < min_digits);
+    ensureSpace(buffer, length);
+    while (length > 0) {
+        buffer->data[buffer->size++] = digits[--length];
+    }
+}
+
+static void ensureSpace(OutputBuffer* buffer, int length)
+{
+    assert(length <= OUTPUT_BUFFER_SIZE);
+    if (buffer->size + length > OUTPUT_BUFFER_SIZE) {
+        outputBufferFlush(buffer);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef _OUTPUT_BUFFER_H
+#define _OUTPUT_BUFFER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "allocator.h"
+
+/**
+* Buffered text writer for the export functions.
+*
+* Text is formatted by hand into a fixed buffer that is written to the file in large blocks, so
+* exporting does not allocate and does not go through printf for every field. The numbers are
+* formatted exactly like printf formats them with "%d" and "%0.2f".
+* Errors are sticky: once a block fails to be written, all later writes are ignored and the error
+* is reported by outputBufferFlush.
+* A buffer can also write its blocks to a growing block of memory from an allocator instead of a file, so
+* text can be formatted on several threads and written to the file in order later.
+*
+* The following functions are available:
+*   outputBufferInit		- Starts writing to an open file
+*   outputBufferInitMemory	- Starts writing to memory from the given allocator
+*   outputBufferWriteBytes	- Writes raw bytes
+*   outputBufferWriteString	- Writes a string
+*   outputBufferWriteChar	- Writes a single character
+*   outputBufferWriteInt	- Writes an int like "%d"
+*   outputBufferWriteFixed2	- Writes a double like "%0.2f"
+*   outputBufferFlush		- Writes the buffered text, returns false if any write failed
+*   outputBufferGetMemory	- Returns the text written to memory, up to the last flush
+*   outputBufferFreeMemory	- Frees the memory of a buffer that writes to memory
+*/
+
+#define OUTPUT_BUFFER_SIZE 65536
+
+typedef struct OutputBuffer {
+    FILE *file; //NULL if writing to memory
+    const ChessAllocator *allocator; //Of the memory, NULL for the heap
+    char *memory;
+    size_t memory_size;
+    size_t memory_max_size;
+    int size;
+    bool failed;
+    char data[OUTPUT_BUFFER_SIZE];
+} OutputBuffer;
+
+void outputBufferInit(OutputBuffer* buffer, FILE* file);
+void outputBufferInitMemory(OutputBuffer* buffer, const ChessAllocator* allocator);
+void outputBufferWriteBytes(OutputBuffer* buffer, const void* data, int length);
+void outputBufferWriteString(OutputBuffer* buffer, const char* string);
+void outputBufferWriteChar(OutputBuffer* buffer, char character);
+void outputBufferWriteInt(OutputBuffer* buffer, int number);
+void outputBufferWriteFixed2(OutputBuffer* buffer, double number);
+bool outputBufferFlush(OutputBuffer* buffer);
+const char* outputBufferGetMemory(const OutputBuffer* buffer, size_t* size);
+void outputBufferFreeMemory(OutputBuffer* buffer);
+
+#endif //_OUTPUT_BUFFER_H
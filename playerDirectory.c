@@ -0,0 +1,256 @@
+#define _POSIX_C_SOURCE 200112L //For pthread_rwlock_t
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <pthread.h>
+#include "playerDirectory.h"
+#include "idTable.h"
+#include "arena.h"
+
+#define INIT_SIZE 16
+#define INIT_SIZE_BITS 4
+#define MAX_SEGMENTS (31 - INIT_SIZE_BITS)
+#define INIT_TOURNAMENTS 2
+#define EXPAND_FACTOR 2
+#define PLAYED_GAME 4294967296LL //What a game adds to the played word of a record, above the time of the games
+
+/*
+ * The records are kept in segments that double in size, segment i holds INIT_SIZE << i records.
+ * Segments are never moved, so a record's address stays the same while other players are added.
+ * The segments, the index and the tournaments of the players are allocated from the directory's arena, so a
+ * player's outgrown list of tournaments is reused by the next player that needs a list of that size.
+ */
+typedef struct PlayerDirectory_t {
+    const ChessAllocator *allocator;
+    Arena arena; //Only used under the exclusive lock
+    IdTable index;
+    PlayerRecord *segments[MAX_SEGMENTS];
+    bool thread_safe;
+    pthread_rwlock_t lock; //Only used if thread_safe
+} PlayerDirectory_t;
+
+static void lockShared(PlayerDirectory directory);
+static void lockExclusive(PlayerDirectory directory);
+static void unlock(PlayerDirectory directory);
+static int addPlayer(PlayerDirectory directory, int player_id);
+static bool reserveTournaments(PlayerDirectory directory, PlayerRecord* player, int count);
+static void addToPlayed(PlayerDirectory directory, long long* played, long long value);
+
+
+PlayerDirectory playerDirectoryCreate(bool thread_safe, const ChessAllocator* allocator)
+{
+    PlayerDirectory directory = allocatorAllocate(allocator, sizeof(*directory));
+    if (directory == NULL) {
+        return NULL;
+    }
+    directory->allocator = allocator;
+    directory->arena = arenaCreate(allocator);
+    if (directory->arena == NULL) {
+        allocatorFree(allocator, directory, sizeof(*directory));
+        return NULL;
+    }
+    directory->index = idTableCreate(directory->arena);
+    if (directory->index == NULL || (thread_safe && pthread_rwlock_init(&directory->lock, NULL) != 0)) {
+        arenaDestroy(directory->arena);
+        allocatorFree(allocator, directory, sizeof(*directory));
+        return NULL;
+    }
+    memset(directory->segments, 0, sizeof(directory->segments));
+    directory->thread_safe = thread_safe;
+    return directory;
+}
+
+void playerDirectoryDestroy(PlayerDirectory directory)
+{
+    if (directory != NULL) {
+        if (directory->thread_safe) {
+            pthread_rwlock_destroy(&directory->lock);
+        }
+        arenaDestroy(directory->arena); //The segments, the index and the tournaments of the players
+        allocatorFree(directory->allocator, directory, sizeof(*directory));
+    }
+}
+
+int playerDirectoryGetSize(PlayerDirectory directory)
+{
+    if (directory == NULL) {
+        return -1;
+    }
+    lockShared(directory);
+    int size = idTableGetSize(directory->index);
+    unlock(directory);
+    return size;
+}
+
+int playerDirectoryFind(PlayerDirectory directory, int player_id)
+{
+    if (directory == NULL) {
+        return PLAYER_DIRECTORY_NOT_FOUND;
+    }
+    lockShared(directory);
+    int slot = idTableFind(directory->index, player_id);
+    unlock(directory);
+    return slot;
+}
+
+int playerDirectoryAdd(PlayerDirectory directory, int player_id)
+{
+    if (directory == NULL) {
+        return PLAYER_DIRECTORY_NOT_FOUND;
+    }
+    int slot = playerDirectoryFind(directory, player_id);
+    if (slot != ID_TABLE_NOT_FOUND) {
+        return slot;
+    }
+    lockExclusive(directory);
+    slot = addPlayer(directory, player_id);
+    unlock(directory);
+    return slot;
+}
+
+//The player may have been added by another thread since it was looked up, so it is looked up again.
+static int addPlayer(PlayerDirectory directory, int player_id)
+{
+    int slot = idTableFind(directory->index, player_id);
+    if (slot != ID_TABLE_NOT_FOUND) {
+        return slot;
+    }
+    int size = idTableGetSize(directory->index);
+    int bits = size + INIT_SIZE;
+    int segment = 31 - __builtin_clz(bits) - INIT_SIZE_BITS;
+    if (segment >= MAX_SEGMENTS) {
+        return PLAYER_DIRECTORY_NOT_FOUND;
+    }
+    if (directory->segments[segment] == NULL) {
+        directory->segments[segment] = arenaAllocate(directory->arena, sizeof(PlayerRecord) * (INIT_SIZE << segment));
+        if (directory->segments[segment] == NULL) {
+            return PLAYER_DIRECTORY_NOT_FOUND;
+        }
+    }
+    slot = idTableAdd(directory->index, player_id);
+    if (slot == ID_TABLE_NOT_FOUND) {
+        return PLAYER_DIRECTORY_NOT_FOUND;
+    }
+    assert(slot == size);
+    PlayerRecord *player = playerDirectoryGet(directory, slot);
+    memset(player, 0, sizeof(PlayerRecord));
+    player->player_id = player_id;
+    return slot;
+}
+
+PlayerRecord* playerDirectoryGet(PlayerDirectory directory, int slot)
+{
+    assert(directory != NULL);
+    assert(slot >= 0 && slot <= INT_MAX - INIT_SIZE);
+    int bits = slot + INIT_SIZE;
+    int high_bit = 31 - __builtin_clz(bits);
+    assert(directory->segments[high_bit - INIT_SIZE_BITS] != NULL);
+    return &directory->segments[high_bit - INIT_SIZE_BITS][bits - (1 << high_bit)];
+}
+
+bool playerDirectoryReserveTournaments(PlayerDirectory directory, int slot, int count)
+{
+    lockExclusive(directory);
+    bool reserved = reserveTournaments(directory, playerDirectoryGet(directory, slot), count);
+    unlock(directory);
+    return reserved;
+}
+
+static bool reserveTournaments(PlayerDirectory directory, PlayerRecord* player, int count)
+{
+    if (player->tournaments_count + count <= player->tournaments_max_size) {
+        return true;
+    }
+    //Grows like adding one tournament at a time would, so reserving before each add stays amortized
+    int new_size = player->tournaments_max_size == 0 ? INIT_TOURNAMENTS :
+                   EXPAND_FACTOR * player->tournaments_max_size;
+    if (new_size < player->tournaments_count + count) {
+        new_size = player->tournaments_count + count;
+    }
+    struct Tournament **tournaments = arenaReallocate(directory->arena, player->tournaments,
+                                                      sizeof(*tournaments) * player->tournaments_max_size,
+                                                      sizeof(*tournaments) * new_size);
+    if (tournaments == NULL) {
+        return false;
+    }
+    player->tournaments = tournaments;
+    player->tournaments_max_size = new_size;
+    return true;
+}
+
+bool playerDirectoryAddTournament(PlayerDirectory directory, int slot, struct Tournament* tournament)
+{
+    lockExclusive(directory);
+    PlayerRecord *player = playerDirectoryGet(directory, slot);
+    if (!reserveTournaments(directory, player, 1)) {
+        unlock(directory);
+        return false;
+    }
+    player->tournaments[player->tournaments_count++] = tournament;
+    unlock(directory);
+    return true;
+}
+
+void playerDirectoryRemoveTournament(PlayerDirectory directory, int slot, struct Tournament* tournament)
+{
+    lockExclusive(directory);
+    PlayerRecord *player = playerDirectoryGet(directory, slot);
+    for (int i = 0; i < player->tournaments_count; i++) {
+        if (player->tournaments[i] == tournament) {
+            player->tournaments[i] = player->tournaments[--player->tournaments_count];
+            break;
+        }
+    }
+    unlock(directory);
+}
+
+void playerDirectoryUpdateStats(PlayerDirectory directory, int slot, int wins, int losses, int draws,
+                                int time_played)
+{
+    PlayerRecord *player = playerDirectoryGet(directory, slot);
+    addToPlayed(directory, &player->played, (long long)(wins + losses + draws) * PLAYED_GAME + time_played);
+}
+
+//The games and time of a player never go below 0, so the time never borrows from the games
+void playerDirectoryGetPlayed(PlayerDirectory directory, int slot, int* games, int* time_played)
+{
+    assert(games != NULL && time_played != NULL);
+    PlayerRecord *player = playerDirectoryGet(directory, slot);
+    long long played = directory->thread_safe ? __atomic_load_n(&player->played, __ATOMIC_RELAXED) : player->played;
+    assert(played >= 0);
+    *games = (int)(played / PLAYED_GAME);
+    *time_played = (int)(played % PLAYED_GAME);
+}
+
+//Totals of the same player are updated from the tournaments of different shards at once
+static void addToPlayed(PlayerDirectory directory, long long* played, long long value)
+{
+    if (directory->thread_safe) {
+        __atomic_fetch_add(played, value, __ATOMIC_RELAXED);
+    }
+    else {
+        *played += value;
+    }
+}
+
+static void lockShared(PlayerDirectory directory)
+{
+    if (directory->thread_safe) {
+        pthread_rwlock_rdlock(&directory->lock);
+    }
+}
+
+static void lockExclusive(PlayerDirectory directory)
+{
+    if (directory->thread_safe) {
+        pthread_rwlock_wrlock(&directory->lock);
+    }
+}
+
+static void unlock(PlayerDirectory directory)
+{
+    if (directory->thread_safe) {
+        pthread_rwlock_unlock(&directory->lock);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef _PLAYER_DIRECTORY_H
+#define _PLAYER_DIRECTORY_H
+
+/**
+* System wide directory of players.
+*
+* Every player id gets a dense slot the first time it is seen, and keeps it for the lifetime of the
+* directory. Games and tournament stats refer to players by slot, so data about a player that is
+* spread over several tournaments can be joined by indexing flat arrays with the slot.
+* A record stays at the same address for the lifetime of the directory.
+*
+* A thread safe directory can be used by several threads at once: looking up and adding players, and
+* changing the tournaments of a player, are locked. The number of games of a player and their time are
+* packed into a single word, so they are updated and read together atomically, without a lock. Reading
+* the tournaments of a record is up to the caller to synchronize with their writers.
+*
+* The following functions are available:
+*   playerDirectoryCreate	- Creates a new empty directory, thread safe or not, using the given allocator
+*   playerDirectoryDestroy	- Deletes an existing directory and frees all resources
+*   playerDirectoryGetSize	- Returns the number of players, slots are 0 to size - 1
+*   playerDirectoryFind	- Returns the slot of a player id, or PLAYER_DIRECTORY_NOT_FOUND
+*   playerDirectoryAdd		- Returns the slot of a player id, giving it a new slot if it was never seen
+*   playerDirectoryGet		- Returns the record of the player in a slot
+*   playerDirectoryReserveTournaments	- Makes room for recording a number of tournaments of a player
+*   playerDirectoryAddTournament	- Records that a player has stats in a tournament, which can not fail once reserved
+*   playerDirectoryRemoveTournament	- Forgets that a player has stats in a tournament
+*   playerDirectoryUpdateStats	- Adds to the totals of a player over all the tournaments
+*   playerDirectoryGetPlayed	- Returns the number of games of a player over all the tournaments, and their time
+*/
+
+#include <stdbool.h>
+#include "allocator.h"
+
+#define PLAYER_DIRECTORY_NOT_FOUND -1
+
+struct Tournament;
+
+/** Type for defining the player directory */
+typedef struct PlayerDirectory_t *PlayerDirectory;
+
+/** The system wide data of a single player */
+typedef struct PlayerRecord {
+    int player_id;
+    long long played; //The games of the player over all the tournaments in the system, times 2^32, plus their time
+    struct Tournament **tournaments; //The tournaments that have stats of the player, in no order
+    int tournaments_count;
+    int tournaments_max_size;
+} PlayerRecord;
+
+PlayerDirectory playerDirectoryCreate(bool thread_safe, const ChessAllocator* allocator);
+void playerDirectoryDestroy(PlayerDirectory directory);
+int playerDirectoryGetSize(PlayerDirectory directory);
+int playerDirectoryFind(PlayerDirectory directory, int player_id);
+int playerDirectoryAdd(PlayerDirectory directory, int player_id);
+PlayerRecord* playerDirectoryGet(PlayerDirectory directory, int slot);
+bool playerDirectoryReserveTournaments(PlayerDirectory directory, int slot, int count);
+bool playerDirectoryAddTournament(PlayerDirectory directory, int slot, struct Tournament* tournament);
+void playerDirectoryRemoveTournament(PlayerDirectory directory, int slot, struct Tournament* tournament);
+void playerDirectoryUpdateStats(PlayerDirectory directory, int slot, int wins, int losses, int draws,
+                                int time_played);
+void playerDirectoryGetPlayed(PlayerDirectory directory, int slot, int* games, int* time_played);
+
+#endif //_PLAYER_DIRECTORY_H
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <pthread.h>
+#include "reclaimer.h"
+
+#define INIT_SIZE 16
+
+typedef struct Reclaimer_t {
+    ReclaimerDestroyFunction destroy;
+    void **pending; //Added since the thread last took the garbage
+    int pending_count;
+    int pending_max_size;
+    void **spare; //Swapped with the pending array by the thread
+    int spare_max_size;
+    bool stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t garbage_available;
+    pthread_t thread;
+} Reclaimer_t;
+
+static void* reclaimGarbage(void* argument);
+
+
+Reclaimer reclaimerCreate(ReclaimerDestroyFunction destroy)
+{
+    assert(destroy != NULL);
+    Reclaimer reclaimer = malloc(sizeof(*reclaimer));
+    if (reclaimer == NULL) {
+        return NULL;
+    }
+    reclaimer->pending = malloc(sizeof(void*) * INIT_SIZE);
+    reclaimer->spare = malloc(sizeof(void*) * INIT_SIZE);
+    if (reclaimer->pending == NULL || reclaimer->spare == NULL) {
+        free(reclaimer->pending);
+        free(reclaimer->spare);
+        free(reclaimer);
+        return NULL;
+    }
+    reclaimer->destroy = destroy;
+    reclaimer->pending_count = 0;
+    reclaimer->pending_max_size = INIT_SIZE;
+    reclaimer->spare_max_size = INIT_SIZE;
+    reclaimer->stopping = false;
+    if (pthread_mutex_init(&reclaimer->lock, NULL) != 0) {
+        free(reclaimer->pending);
+        free(reclaimer->spare);
+        free(reclaimer);
+        return NULL;
+    }
+    if (pthread_cond_init(&reclaimer->garbage_available, NULL) != 0) {
+        pthread_mutex_destroy(&reclaimer->lock);
+        free(reclaimer->pending);
+        free(reclaimer->spare);
+        free(reclaimer);
+        return NULL;
+    }
+    if (pthread_create(&reclaimer->thread, NULL, reclaimGarbage, reclaimer) != 0) {
+        pthread_cond_destroy(&reclaimer->garbage_available);
+        pthread_mutex_destroy(&reclaimer->lock);
+        free(reclaimer->pending);
+        free(reclaimer->spare);
+        free(reclaimer);
+        return NULL;
+    }
+    return reclaimer;
+}
+
+void reclaimerDestroy(Reclaimer reclaimer)
+{
+    if (reclaimer == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&reclaimer->lock);
+    reclaimer->stopping = true;
+    pthread_cond_signal(&reclaimer->garbage_available);
+    pthread_mutex_unlock(&reclaimer->lock);
+    pthread_join(reclaimer->thread, NULL);
+    assert(reclaimer->pending_count == 0);
+    pthread_cond_destroy(&reclaimer->garbage_available);
+    pthread_mutex_destroy(&reclaimer->lock);
+    free(reclaimer->pending);
+    free(reclaimer->spare);
+    free(reclaimer);
+}
+
+bool reclaimerAdd(Reclaimer reclaimer, void* garbage)
+{
+    assert(reclaimer != NULL);
+    pthread_mutex_lock(&reclaimer->lock);
+    if (reclaimer->pending_count == reclaimer->pending_max_size) {
+        void **pending = realloc(reclaimer->pending, sizeof(void*) * reclaimer->pending_max_size * 2);
+        if (pending == NULL) {
+            pthread_mutex_unlock(&reclaimer->lock);
+            return false;
+        }
+        reclaimer->pending = pending;
+        reclaimer->pending_max_size *= 2;
+    }
+    reclaimer->pending[reclaimer->pending_count++] = garbage;
+    if (reclaimer->pending_count == 1) {
+        pthread_cond_signal(&reclaimer->garbage_available);
+    }
+    pthread_mutex_unlock(&reclaimer->lock);
+    return true;
+}
+
+/*
+ * The thread swaps the pending array for its spare one, so adding garbage never waits for the destroying.
+ * It only stops once nothing is pending.
+ */
+static void* reclaimGarbage(void* argument)
+{
+    Reclaimer reclaimer = argument;
+    pthread_mutex_lock(&reclaimer->lock);
+    while (true) {
+        while (reclaimer->pending_count == 0 && !reclaimer->stopping) {
+            pthread_cond_wait(&reclaimer->garbage_available, &reclaimer->lock);
+        }
+        if (reclaimer->pending_count == 0) {
+            break;
+        }
+        void **taken = reclaimer->pending;
+        int taken_count = reclaimer->pending_count;
+        int taken_max_size = reclaimer->pending_max_size;
+        reclaimer->pending = reclaimer->spare;
+        reclaimer->pending_max_size = reclaimer->spare_max_size;
+        reclaimer->pending_count = 0;
+        pthread_mutex_unlock(&reclaimer->lock);
+        for (int i = 0; i < taken_count; i++) {
+            reclaimer->destroy(taken[i]);
+        }
+        pthread_mutex_lock(&reclaimer->lock);
+        reclaimer->spare = taken;
+        reclaimer->spare_max_size = taken_max_size;
+    }
+    pthread_mutex_unlock(&reclaimer->lock);
+    return NULL;
+}
@@ -0,0 +1,51 @@
+#ifndef _RECLAIMER_H
+#define _RECLAIMER_H
+
+#include <stdbool.h>
+
+/**
+* Frees memory on a background thread.
+*
+* Garbage that is added to a reclaimer is handed to its thread, which destroys it with the reclaimer's destroy
+* function. Adding only appends a pointer to a pending array under a short lock, so the caller does not wait
+* for the memory to be freed. The thread takes the whole pending array at once, and destroys it outside the lock.
+* The destroy function must not touch anything that is shared with the threads that add garbage.
+*
+* The following functions are available:
+*   reclaimerCreate	- Creates a reclaimer and starts its thread
+*   reclaimerDestroy	- Waits for all the garbage that was added to be destroyed, and stops the thread
+*   reclaimerAdd	- Hands garbage to the thread
+*/
+
+/** Type for defining the reclaimer */
+typedef struct Reclaimer_t *Reclaimer;
+
+/** Type of the function that destroys the garbage */
+typedef void (*ReclaimerDestroyFunction)(void*);
+
+/**
+* reclaimerCreate: Creates a reclaimer and starts its thread.
+*
+* @param destroy - The function that destroys the garbage. Must be non-NULL.
+* @return NULL if an allocation failed or the thread could not be started, a new reclaimer otherwise.
+*/
+Reclaimer reclaimerCreate(ReclaimerDestroyFunction destroy);
+
+/**
+* reclaimerDestroy: Waits until all the garbage that was added is destroyed, stops the thread and frees the
+* reclaimer. No thread may be adding garbage meanwhile.
+*
+* @param reclaimer - The reclaimer. If NULL nothing is done.
+*/
+void reclaimerDestroy(Reclaimer reclaimer);
+
+/**
+* reclaimerAdd: Hands garbage to the thread of the reclaimer. Any number of threads may add garbage at once.
+*
+* @param reclaimer - The reclaimer. Must be non-NULL.
+* @param garbage - The garbage to destroy.
+* @return false if an allocation failed, and then the caller still owns the garbage. true otherwise.
+*/
+bool reclaimerAdd(Reclaimer reclaimer, void* garbage);
+
+#endif //_RECLAIMER_H
@@ -0,0 +1,205 @@
+#define _POSIX_C_SOURCE 200112L //For fileno and fsync
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "snapshot.h"
+
+#define SNAPSHOT_MAGIC 0x53534843 //"CHSS"
+#define CHECKSUM_SIZE 8
+#define WORD_SIZE 8
+#define HEADER_SIZE (2 * SNAPSHOT_INT_SIZE)
+#define BITS_PER_BYTE 8
+#define BYTE_MASK 0xFF
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static void checksumInit(SnapshotChecksum* checksum);
+static void checksumUpdate(SnapshotChecksum* checksum, const unsigned char* data, size_t length);
+static uint64_t checksumFinish(SnapshotChecksum* checksum);
+static uint64_t decodeUint64(const unsigned char* bytes, int size);
+static uint32_t decodeUint32(const unsigned char* bytes);
+
+
+void snapshotWriterInit(SnapshotWriter* writer, FILE* file)
+{
+    assert(writer != NULL && file != NULL);
+    checksumInit(&writer->checksum);
+    outputBufferInit(&writer->output, file);
+    snapshotWriteInt(writer, SNAPSHOT_MAGIC);
+    snapshotWriteInt(writer, SNAPSHOT_VERSION);
+}
+
+void snapshotWriteInt(SnapshotWriter* writer, int number)
+{
+    unsigned char bytes[SNAPSHOT_INT_SIZE];
+    uint32_t bits = (uint32_t)number;
+    for (int i = 0; i < SNAPSHOT_INT_SIZE; i++) {
+        bytes[i] = (bits >> (BITS_PER_BYTE * i)) & BYTE_MASK;
+    }
+    snapshotWriteBytes(writer, bytes, SNAPSHOT_INT_SIZE);
+}
+
+void snapshotWriteBytes(SnapshotWriter* writer, const void* data, int length)
+{
+    checksumUpdate(&writer->checksum, data, length);
+    outputBufferWriteBytes(&writer->output, data, length);
+}
+
+bool snapshotWriterFinish(SnapshotWriter* writer)
+{
+    unsigned char bytes[CHECKSUM_SIZE];
+    uint64_t checksum = checksumFinish(&writer->checksum);
+    for (int i = 0; i < CHECKSUM_SIZE; i++) {
+        bytes[i] = (checksum >> (BITS_PER_BYTE * i)) & BYTE_MASK;
+    }
+    outputBufferWriteBytes(&writer->output, bytes, CHECKSUM_SIZE);
+    return outputBufferFlush(&writer->output);
+}
+
+bool snapshotWriterSync(SnapshotWriter* writer)
+{
+    assert(writer != NULL && writer->output.file != NULL);
+    return outputBufferFlush(&writer->output) && fflush(writer->output.file) == 0 &&
+           fsync(fileno(writer->output.file)) == 0;
+}
+
+unsigned char* snapshotReadFile(const char* path, size_t* size)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    unsigned char *data = NULL;
+    if (length >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc(length > 0 ? length : 1);
+    }
+    if (data != NULL && fread(data, 1, length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size = length;
+    return data;
+}
+
+bool snapshotReaderInit(SnapshotReader* reader, const unsigned char* data, size_t size)
+{
+    assert(reader != NULL && data != NULL);
+    if (size < HEADER_SIZE + CHECKSUM_SIZE) {
+        return false;
+    }
+    SnapshotChecksum checksum;
+    checksumInit(&checksum);
+    checksumUpdate(&checksum, data, size - CHECKSUM_SIZE);
+    reader->data = data;
+    reader->size = size - CHECKSUM_SIZE;
+    reader->position = 0;
+    reader->failed = checksumFinish(&checksum) != decodeUint64(data + reader->size, CHECKSUM_SIZE);
+    if (reader->failed || decodeUint32(data) != SNAPSHOT_MAGIC || decodeUint32(data + SNAPSHOT_INT_SIZE) != SNAPSHOT_VERSION) {
+        return false;
+    }
+    reader->position = HEADER_SIZE;
+    return true;
+}
+
+int snapshotReadInt(SnapshotReader* reader)
+{
+    const unsigned char *bytes = snapshotReadBytes(reader, SNAPSHOT_INT_SIZE);
+    if (bytes == NULL) {
+        return 0;
+    }
+    return snapshotDecodeInt(bytes);
+}
+
+//Checking the size up front keeps a corrupt count from being used to allocate memory.
+int snapshotReadCount(SnapshotReader* reader, int record_size)
+{
+    int count = snapshotReadInt(reader);
+    if (count < 0 || (size_t)count * record_size > reader->size - reader->position) {
+        reader->failed = true;
+        return 0;
+    }
+    return count;
+}
+
+const void* snapshotReadBytes(SnapshotReader* reader, int length)
+{
+    if (reader->failed || length < 0 || (size_t)length > reader->size - reader->position) {
+        reader->failed = true;
+        return NULL;
+    }
+    const unsigned char *bytes = reader->data + reader->position;
+    reader->position += length;
+    return bytes;
+}
+
+int snapshotDecodeInt(const unsigned char* bytes)
+{
+    uint32_t bits = decodeUint32(bytes);
+    return bits > INT32_MAX ? -(int)(UINT32_MAX - bits) - 1 : (int)bits;
+}
+
+bool snapshotReaderFinish(const SnapshotReader* reader)
+{
+    return !reader->failed && reader->position == reader->size;
+}
+
+static void checksumInit(SnapshotChecksum* checksum)
+{
+    checksum->hash = FNV_OFFSET_BASIS;
+    checksum->word = 0;
+    checksum->word_size = 0;
+}
+
+//Whole words are taken straight from the data, bytes are only collected when a word is split between writes.
+static void checksumUpdate(SnapshotChecksum* checksum, const unsigned char* data, size_t length)
+{
+    size_t i = 0;
+    while (i < length) {
+        if (checksum->word_size == 0 && length - i >= WORD_SIZE) {
+            checksum->hash = (checksum->hash ^ decodeUint64(data + i, WORD_SIZE)) * FNV_PRIME;
+            i += WORD_SIZE;
+            continue;
+        }
+        checksum->word |= (uint64_t)data[i++] << (BITS_PER_BYTE * checksum->word_size++);
+        if (checksum->word_size == WORD_SIZE) {
+            checksum->hash = (checksum->hash ^ checksum->word) * FNV_PRIME;
+            checksum->word = 0;
+            checksum->word_size = 0;
+        }
+    }
+}
+
+//A last partial word is padded with zeros.
+static uint64_t checksumFinish(SnapshotChecksum* checksum)
+{
+    if (checksum->word_size > 0) {
+        checksum->hash = (checksum->hash ^ checksum->word) * FNV_PRIME;
+        checksum->word = 0;
+        checksum->word_size = 0;
+    }
+    return checksum->hash;
+}
+
+static uint64_t decodeUint64(const unsigned char* bytes, int size)
+{
+    uint64_t value = 0;
+    for (int i = size - 1; i >= 0; i--) {
+        value = (value << BITS_PER_BYTE) | bytes[i];
+    }
+    return value;
+}
+
+static uint32_t decodeUint32(const unsigned char* bytes)
+{
+    uint32_t value = 0;
+    for (int i = SNAPSHOT_INT_SIZE - 1; i >= 0; i--) {
+        value = (value << BITS_PER_BYTE) | bytes[i];
+    }
+    return value;
+}
@@ -0,0 +1,69 @@
+#ifndef _SNAPSHOT_H
+#define _SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "outputBuffer.h"
+
+/**
+* Binary snapshot files.
+*
+* A snapshot is a header with a magic number and a format version, the data, and a 64 bit checksum
+* of everything before it. The checksum is FNV-1a taken over little endian 64 bit words instead of
+* bytes, which makes it about 8 times faster to compute. The data is a sequence of little endian 32 bit integers and raw
+* byte strings, and its layout is up to the writer and the reader.
+* A snapshot is read into memory as a whole, and is then parsed in place. Reading past the end of
+* the data does not fail immediately: the reader is marked as failed and returns zeros, so a
+* sequence of reads only has to be checked once at its end.
+*
+* The following functions are available:
+*   snapshotWriterInit		- Starts writing a snapshot to an open file
+*   snapshotWriteInt		- Writes an int
+*   snapshotWriteBytes		- Writes raw bytes
+*   snapshotWriterFinish	- Writes the checksum, returns false if any write failed
+*   snapshotWriterSync		- Writes the buffered data and syncs the file to the disk
+*   snapshotReadFile		- Reads a whole file into memory
+*   snapshotReaderInit		- Starts reading snapshot data, returns false if it is not a valid snapshot
+*   snapshotReadInt		- Reads an int
+*   snapshotReadCount		- Reads a count of records, failing if there is not enough data left for them
+*   snapshotReadBytes		- Returns a pointer to raw bytes inside the data
+*   snapshotDecodeInt		- Decodes an int from raw bytes, for reading many ints at once
+*   snapshotReaderFinish	- Returns true if all the data was read, and no read failed
+*/
+
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_INT_SIZE 4
+
+typedef struct SnapshotChecksum {
+    uint64_t hash;
+    uint64_t word; //The bytes of the current word that were already written
+    int word_size;
+} SnapshotChecksum;
+
+typedef struct SnapshotWriter {
+    SnapshotChecksum checksum;
+    OutputBuffer output;
+} SnapshotWriter;
+
+typedef struct SnapshotReader {
+    const unsigned char *data;
+    size_t size; //Without the checksum
+    size_t position;
+    bool failed;
+} SnapshotReader;
+
+void snapshotWriterInit(SnapshotWriter* writer, FILE* file);
+void snapshotWriteInt(SnapshotWriter* writer, int number);
+void snapshotWriteBytes(SnapshotWriter* writer, const void* data, int length);
+bool snapshotWriterFinish(SnapshotWriter* writer);
+bool snapshotWriterSync(SnapshotWriter* writer);
+unsigned char* snapshotReadFile(const char* path, size_t* size);
+bool snapshotReaderInit(SnapshotReader* reader, const unsigned char* data, size_t size);
+int snapshotReadInt(SnapshotReader* reader);
+int snapshotReadCount(SnapshotReader* reader, int record_size);
+const void* snapshotReadBytes(SnapshotReader* reader, int length);
+int snapshotDecodeInt(const unsigned char* bytes);
+bool snapshotReaderFinish(const SnapshotReader* reader);
+
+#endif //_SNAPSHOT_H
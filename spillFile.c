@@ -0,0 +1,99 @@
+#define _POSIX_C_SOURCE 200809L //For pwrite, mmap and sysconf
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "spillFile.h"
+
+typedef struct SpillFile_t {
+    int descriptor;
+    char *path;
+    long long size; //Where the next data is written
+    pthread_mutex_t lock; //Of size
+} SpillFile_t;
+
+
+SpillFile spillFileOpen(const char* path)
+{
+    assert(path != NULL);
+    SpillFile file = malloc(sizeof(*file));
+    if (file == NULL) {
+        return NULL;
+    }
+    file->path = malloc(strlen(path) + 1);
+    if (file->path == NULL) {
+        free(file);
+        return NULL;
+    }
+    strcpy(file->path, path);
+    file->descriptor = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (file->descriptor < 0 || pthread_mutex_init(&file->lock, NULL) != 0) {
+        if (file->descriptor >= 0) {
+            close(file->descriptor);
+            unlink(path);
+        }
+        free(file->path);
+        free(file);
+        return NULL;
+    }
+    file->size = 0;
+    return file;
+}
+
+void spillFileClose(SpillFile file)
+{
+    if (file != NULL) {
+        close(file->descriptor);
+        unlink(file->path);
+        pthread_mutex_destroy(&file->lock);
+        free(file->path);
+        free(file);
+    }
+}
+
+//The place of the data is taken under the lock, and the data is written outside it
+bool spillFileWrite(SpillFile file, const void* data, size_t size, long long* offset)
+{
+    assert(file != NULL && (data != NULL || size == 0) && offset != NULL);
+    pthread_mutex_lock(&file->lock);
+    *offset = file->size;
+    file->size += size;
+    pthread_mutex_unlock(&file->lock);
+    const unsigned char *bytes = data;
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = pwrite(file->descriptor, bytes + written, size - written, (off_t)(*offset + written));
+        if (result <= 0) {
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+bool spillFileMap(SpillFile file, long long offset, size_t size, SpillMapping* mapping)
+{
+    assert(file != NULL && offset >= 0 && mapping != NULL);
+    long long page_size = sysconf(_SC_PAGESIZE);
+    long long first_page = offset - offset % page_size;
+    mapping->pages_size = (size_t)(offset - first_page) + (size > 0 ? size : 1);
+    mapping->pages = mmap(NULL, mapping->pages_size, PROT_READ, MAP_PRIVATE, file->descriptor, (off_t)first_page);
+    if (mapping->pages == MAP_FAILED) {
+        mapping->pages = NULL;
+        return false;
+    }
+    mapping->data = (const unsigned char*)mapping->pages + (offset - first_page);
+    return true;
+}
+
+void spillFileUnmap(SpillMapping* mapping)
+{
+    assert(mapping != NULL);
+    if (mapping->pages != NULL) {
+        munmap(mapping->pages, mapping->pages_size);
+        mapping->pages = NULL;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef _SPILL_FILE_H
+#define _SPILL_FILE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+* Scratch file that memory is moved out to, and mapped back from.
+*
+* Data is appended to the end of the file, and is read back by mapping its pages with mmap, so the operating
+* system reads only what is used and nothing is copied through a buffer. Data that is no longer needed is not
+* reclaimed, the file only grows until it is closed. Closing the file deletes it. Any number of threads can
+* write and map at once.
+*
+* The following functions are available:
+*   spillFileOpen		- Creates the file, replacing any file at its path
+*   spillFileClose		- Closes and deletes the file
+*   spillFileWrite		- Appends data and returns where it was written
+*   spillFileMap		- Maps data that was written back into memory
+*   spillFileUnmap		- Unmaps mapped data
+*/
+
+/** Type for defining the spill file */
+typedef struct SpillFile_t *SpillFile;
+
+/** Data mapped back from a spill file */
+typedef struct SpillMapping {
+    const unsigned char *data;
+    void *pages; //The mapped pages, which start at the page that has the first byte of data
+    size_t pages_size;
+} SpillMapping;
+
+SpillFile spillFileOpen(const char* path);
+void spillFileClose(SpillFile file);
+bool spillFileWrite(SpillFile file, const void* data, size_t size, long long* offset);
+bool spillFileMap(SpillFile file, long long offset, size_t size, SpillMapping* mapping);
+void spillFileUnmap(SpillMapping* mapping);
+
+#endif //_SPILL_FILE_H
@@ -0,0 +1,223 @@
+#define _POSIX_C_SOURCE 200112L //For clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "../chessSystem.h"
+
+/*
+ * Multi threaded ingestion benchmark: every run adds the same games to a new thread safe system, with the
+ * tournaments split between the threads, and prints the throughput for 1, 2, 4... threads.
+ * The same games are then submitted through an ingestion queue by 1, 2, 4... producers, printing the throughput
+ * and the latency from submitting a game to its callback.
+ * Usage: chess_benchmark [max_threads]
+ */
+
+#define DEFAULT_MAX_THREADS 8
+#define SHARDS 64
+#define TOURNAMENTS 256
+#define GAMES_PER_TOURNAMENT 1000
+#define PLAYERS 400
+#define MAX_GAMES_PER_PLAYER 1000000
+#define RANDOM_SEED 2021
+#define NANOSECONDS 1e9
+#define MICROSECONDS 1e6
+#define QUEUE_CAPACITY 4096
+#define PERCENTILE_50 0.5
+#define PERCENTILE_99 0.99
+
+typedef struct {
+    ChessIngestQueue queue;
+    const ChessGameRecord* games;
+    double* latencies; //The submit time of each game, replaced by its latency when it is added
+    int producers;
+    int producer;
+} Producer;
+
+typedef struct {
+    ChessSystem chess;
+    const ChessGameRecord* games;
+    int threads;
+    int thread;
+} Worker;
+
+//The games are added round by round, one game of each of the thread's tournaments per round
+static void* addGames(void* argument)
+{
+    Worker *worker = argument;
+    for (int i = 0; i < TOURNAMENTS * GAMES_PER_TOURNAMENT; i++) {
+        const ChessGameRecord *game = &worker->games[i];
+        if (game->tournament_id % worker->threads == worker->thread) {
+            chessAddGame(worker->chess, game->tournament_id, game->first_player, game->second_player,
+                         game->winner, game->play_time);
+        }
+    }
+    return NULL;
+}
+
+static double getSeconds();
+
+static void recordLatency(const ChessGameRecord* game, ChessResult result, void* context)
+{
+    double *latency = context;
+    *latency = getSeconds() - *latency;
+}
+
+static void* submitGames(void* argument)
+{
+    Producer *producer = argument;
+    for (int i = producer->producer; i < TOURNAMENTS * GAMES_PER_TOURNAMENT; i += producer->producers) {
+        producer->latencies[i] = getSeconds();
+        chessIngestQueueSubmit(producer->queue, &producer->games[i], recordLatency, &producer->latencies[i]);
+    }
+    return NULL;
+}
+
+static int compareDoubles(const void* first, const void* second)
+{
+    double first_double = *(const double*)first, second_double = *(const double*)second;
+    return first_double < second_double ? -1 : first_double > second_double;
+}
+
+static double getSeconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / NANOSECONDS;
+}
+
+//Returns the seconds it took to add all the games, or a negative number on failure
+static double runBenchmark(const ChessGameRecord* games, int threads_count)
+{
+    ChessSystem chess = chessCreateThreadSafe(SHARDS);
+    if (chess == NULL) {
+        return -1;
+    }
+    for (int id = 1; id <= TOURNAMENTS; id++) {
+        chessAddTournament(chess, id, MAX_GAMES_PER_PLAYER, "Benchmark");
+    }
+    pthread_t *threads = malloc(sizeof(pthread_t) * threads_count);
+    Worker *workers = malloc(sizeof(Worker) * threads_count);
+    if (threads == NULL || workers == NULL) {
+        free(threads);
+        free(workers);
+        chessDestroy(chess);
+        return -1;
+    }
+    double start = getSeconds();
+    int started = 0;
+    for (; started < threads_count; started++) {
+        Worker worker = {chess, games, threads_count, started};
+        workers[started] = worker;
+        if (pthread_create(&threads[started], NULL, addGames, &workers[started]) != 0) {
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double seconds = getSeconds() - start;
+    free(threads);
+    free(workers);
+    chessDestroy(chess);
+    return started == threads_count ? seconds : -1;
+}
+
+//Returns the seconds it took to add all the games, or a negative number on failure. Sorts the latencies.
+static double runQueueBenchmark(const ChessGameRecord* games, int producers_count, double* latencies)
+{
+    ChessSystem chess = chessCreateThreadSafe(SHARDS);
+    if (chess == NULL) {
+        return -1;
+    }
+    for (int id = 1; id <= TOURNAMENTS; id++) {
+        chessAddTournament(chess, id, MAX_GAMES_PER_PLAYER, "Benchmark");
+    }
+    ChessIngestQueue queue = chessIngestQueueCreate(chess, QUEUE_CAPACITY, CHESS_INGEST_BLOCK);
+    pthread_t *threads = malloc(sizeof(pthread_t) * producers_count);
+    Producer *producers = malloc(sizeof(Producer) * producers_count);
+    if (queue == NULL || threads == NULL || producers == NULL) {
+        chessIngestQueueDestroy(queue);
+        free(threads);
+        free(producers);
+        chessDestroy(chess);
+        return -1;
+    }
+    double start = getSeconds();
+    int started = 0;
+    for (; started < producers_count; started++) {
+        Producer producer = {queue, games, latencies, producers_count, started};
+        producers[started] = producer;
+        if (pthread_create(&threads[started], NULL, submitGames, &producers[started]) != 0) {
+            break;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    chessIngestQueueFlush(queue);
+    double seconds = getSeconds() - start;
+    chessIngestQueueDestroy(queue);
+    free(threads);
+    free(producers);
+    chessDestroy(chess);
+    qsort(latencies, TOURNAMENTS * GAMES_PER_TOURNAMENT, sizeof(double), compareDoubles);
+    return started == producers_count ? seconds : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    int max_threads = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_THREADS;
+    if (max_threads <= 0) {
+        fprintf(stderr, "Usage: %s [max_threads]\n", argv[0]);
+        return 1;
+    }
+    ChessGameRecord *games = malloc(sizeof(ChessGameRecord) * TOURNAMENTS * GAMES_PER_TOURNAMENT);
+    double *latencies = malloc(sizeof(double) * TOURNAMENTS * GAMES_PER_TOURNAMENT);
+    if (games == NULL || latencies == NULL) {
+        free(games);
+        free(latencies);
+        return 1;
+    }
+    srand(RANDOM_SEED);
+    for (int i = 0; i < TOURNAMENTS * GAMES_PER_TOURNAMENT; i++) {
+        int first_player = rand() % PLAYERS + 1;
+        int second_player = (first_player + rand() % (PLAYERS - 1)) % PLAYERS + 1;
+        ChessGameRecord game = {i % TOURNAMENTS + 1, first_player, second_player, (Winner)(rand() % 3),
+                                rand() % 100};
+        games[i] = game;
+    }
+    printf("threads   seconds   games/s   speedup\n");
+    double base_seconds = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double seconds = runBenchmark(games, threads);
+        if (seconds < 0) {
+            fprintf(stderr, "Benchmark with %d threads failed\n", threads);
+            free(games);
+            free(latencies);
+            return 1;
+        }
+        if (threads == 1) {
+            base_seconds = seconds;
+        }
+        printf("%7d %9.3f %9.0f %9.2f\n", threads, seconds, TOURNAMENTS * GAMES_PER_TOURNAMENT / seconds,
+               base_seconds / seconds);
+    }
+    printf("\nproducers   seconds   games/s   p50 us   p99 us\n");
+    for (int producers = 1; producers <= max_threads; producers *= 2) {
+        double seconds = runQueueBenchmark(games, producers, latencies);
+        if (seconds < 0) {
+            fprintf(stderr, "Queue benchmark with %d producers failed\n", producers);
+            free(games);
+            free(latencies);
+            return 1;
+        }
+        int count = TOURNAMENTS * GAMES_PER_TOURNAMENT;
+        printf("%9d %9.3f %9.0f %8.1f %8.1f\n", producers, seconds, count / seconds,
+               latencies[(int)(count * PERCENTILE_50)] * MICROSECONDS,
+               latencies[(int)(count * PERCENTILE_99)] * MICROSECONDS);
+    }
+    free(games);
+    free(latencies);
+    return 0;
+}
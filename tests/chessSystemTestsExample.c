@@ -1,9 +1,85 @@
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "../chessSystem.h"
 #include "../test_utilities.h"
 
 /*The number of tests*/
-#define NUMBER_TESTS 4
+#define NUMBER_TESTS 29
+
+#define RANDOM_SEED 2021
+#define RANDOM_TOURNAMENTS 200
+#define RANDOM_PLAYERS 6
+#define RANDOM_GAMES 14
+#define RANDOM_ID_RANGE 100
+#define RANDOM_WINNERS_FILE "./tests/random_winners_your_output.txt"
+#define LOCATIONS_FILE "./tests/locations_your_output.txt"
+#define ROUNDING_FILE "./tests/levels_rounding_your_output.txt"
+#define ROUNDING_GAMES 32
+#define LEVELS_PLAYERS 40
+#define LEVELS_LINE_LENGTH 32
+#define BATCH_GAMES 3000
+#define BATCH_TOURNAMENTS 6
+#define BATCH_PLAYERS 30
+#define BATCH_FILE "./tests/batch_your_output.txt"
+#define BATCH_EXPECTED_FILE "./tests/batch_expected_your_output.txt"
+#define IMPORT_GAMES 6000
+#define IMPORT_CSV_FILE "./tests/import_your_output.csv"
+#define IMPORT_BINARY_FILE "./tests/import_your_output.bin"
+#define SNAPSHOT_FILE "./tests/snapshot_your_output.bin"
+#define SNAPSHOT_CORRUPT_FILE "./tests/snapshot_corrupt_your_output.bin"
+#define SNAPSHOT_FROZEN_FILE "./tests/snapshot_frozen_your_output.bin"
+#define JOURNAL_FILE "./tests/journal_your_output.bin"
+#define JOURNAL_TORN_FILE "./tests/journal_torn_your_output.bin"
+#define JOURNAL_TORN_BYTES 3
+#define THREADS 3
+#define THREAD_SAFE_SHARDS 4
+#define PARALLEL_TOURNAMENTS 10000
+#define PARALLEL_PLAYERS 20000
+#define PARALLEL_GAMES 70000
+#define QUEUE_CAPACITY 64
+#define FULL_QUEUE_GAMES 200
+#define SNAPSHOTS_WHILE_ADDING 20
+#define ARENA_GAMES 2000
+#define WARM_UP_GAMES 1100 //Enough for every player to be in the tournament, and for room for 2048 games
+#define STEADY_PLAYERS 64
+#define ALLOCATOR_LIMIT (64 * 1024)
+#define FAILING_TOURNAMENTS (BATCH_TOURNAMENTS - 1) //All the ones testSameSystems compares
+#define FAILING_PLAYERS 403
+#define FAILING_STEP 16 //Bytes of headroom added until a game fits, so each of its allocations fails in turn
+#define ARCHIVE_TOURNAMENT 5 //The batch tournament with the most games
+#define SEEK_GAME 130 //In the second block of an archive
+#define SPILL_FILE "./tests/spill_your_output.bin"
+#define SPILL_BUDGET 1 //Less than any tournament takes up, so each one is spilled once it is not used
+#define SMALL_TOURNAMENTS 10
+#define SMALL_SPILL_BUDGET (4 * 4096) //Each tournament holds a chunk of 4096 bytes and more, so three fit
+#define SMALL_RESIDENT 3
+
+typedef struct {
+    int players_id[2];
+    Winner winner;
+} TestGame;
+
+typedef struct {
+    ChessSystem chess;
+    const ChessGameRecord* games;
+    ChessResult* results;
+    int thread;
+} TestWorker;
+
+typedef struct {
+    ChessIngestQueue queue;
+    const ChessGameRecord* games;
+    ChessResult* results;
+    int thread;
+} TestProducer;
+
+typedef struct {
+    int wins;
+    int losses;
+    int draws;
+    bool played;
+} TestStats;
 
 
 bool testChessAddTournament() {
@@ -62,13 +138,1453 @@ bool testChessPrintLevelsAndTournamentStatistics(){
 }
 
 
+static bool testGamePlayed(TestGame games[], int games_count, int first_player, int second_player)
+{
+    for (int i = 0; i < games_count; i++) {
+        if ((games[i].players_id[0] == first_player && games[i].players_id[1] == second_player) ||
+            (games[i].players_id[0] == second_player && games[i].players_id[1] == first_player)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void testAddGameStats(TestStats stats[], int player, int wins, int losses, int draws)
+{
+    stats[player].wins += wins;
+    stats[player].losses += losses;
+    stats[player].draws += draws;
+    stats[player].played = true;
+}
+
+static void testRemovePlayer(TestGame games[], int games_count, TestStats stats[], int player)
+{
+    for (int i = 0; i < games_count; i++) {
+        for (int side = 0; side < 2; side++) {
+            int opponent = games[i].players_id[1 - side];
+            if (games[i].players_id[side] != player) {
+                continue;
+            }
+            if (opponent != -1 && games[i].winner == DRAW) {
+                testAddGameStats(stats, opponent, 1, 0, -1);
+            }
+            else if (opponent != -1 && games[i].winner == (side == 0 ? FIRST_PLAYER : SECOND_PLAYER)) {
+                testAddGameStats(stats, opponent, 1, -1, 0);
+            }
+            games[i].players_id[side] = -1;
+            games[i].winner = side == 0 ? SECOND_PLAYER : FIRST_PLAYER;
+        }
+    }
+    stats[player].wins = stats[player].losses = stats[player].draws = 0;
+}
+
+/*The reference winner, filtering the players by max score, then min losses, then max wins, then min id*/
+static int testFindWinner(TestStats stats[])
+{
+    int max_score = -1, min_losses = -1, max_wins = -1;
+    for (int i = 1; i <= RANDOM_PLAYERS; i++) {
+        int score = 2 * stats[i].wins + stats[i].draws;
+        if (stats[i].played && score > max_score) {
+            max_score = score;
+        }
+    }
+    for (int i = 1; i <= RANDOM_PLAYERS; i++) {
+        int score = 2 * stats[i].wins + stats[i].draws;
+        if (stats[i].played && score == max_score && (min_losses == -1 || stats[i].losses < min_losses)) {
+            min_losses = stats[i].losses;
+        }
+    }
+    for (int i = 1; i <= RANDOM_PLAYERS; i++) {
+        int score = 2 * stats[i].wins + stats[i].draws;
+        if (stats[i].played && score == max_score && stats[i].losses == min_losses && stats[i].wins > max_wins) {
+            max_wins = stats[i].wins;
+        }
+    }
+    for (int i = 1; i <= RANDOM_PLAYERS; i++) {
+        int score = 2 * stats[i].wins + stats[i].draws;
+        if (stats[i].played && score == max_score && stats[i].losses == min_losses && stats[i].wins == max_wins) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool testChessEndTournamentRandomWinners(){
+    int expected_winners[RANDOM_TOURNAMENTS + 1];
+    srand(RANDOM_SEED);
+    ChessSystem chess = chessCreate();
+    for (int tournament_id = 1; tournament_id <= RANDOM_TOURNAMENTS; tournament_id++) {
+        TestGame games[RANDOM_GAMES];
+        TestStats stats[RANDOM_PLAYERS + 1] = {{0}};
+        int games_count = 0;
+        int base_id = tournament_id * RANDOM_ID_RANGE;
+        ASSERT_TEST(chessAddTournament(chess, tournament_id, RANDOM_GAMES, "London") == CHESS_SUCCESS);
+        for (int i = 0; i < RANDOM_GAMES; i++) {
+            if (games_count > 0 && rand() % 8 == 0) {
+                int removed = 1 + rand() % RANDOM_PLAYERS;
+                bool exists = stats[removed].wins + stats[removed].losses + stats[removed].draws > 0;
+                ChessResult result = chessRemovePlayer(chess, base_id + removed);
+                ASSERT_TEST(result == (exists ? CHESS_SUCCESS : CHESS_PLAYER_NOT_EXIST));
+                testRemovePlayer(games, games_count, stats, removed);
+                continue;
+            }
+            int first = 1 + rand() % RANDOM_PLAYERS;
+            int second = 1 + rand() % RANDOM_PLAYERS;
+            Winner winner = (Winner)(rand() % 3);
+            if (first == second || testGamePlayed(games, games_count, first, second)) {
+                continue;
+            }
+            ASSERT_TEST(chessAddGame(chess, tournament_id, base_id + first, base_id + second,
+                                     winner, 1 + rand() % 1000) == CHESS_SUCCESS);
+            games[games_count].players_id[0] = first;
+            games[games_count].players_id[1] = second;
+            games[games_count++].winner = winner;
+            testAddGameStats(stats, first, winner == FIRST_PLAYER, winner == SECOND_PLAYER, winner == DRAW);
+            testAddGameStats(stats, second, winner == SECOND_PLAYER, winner == FIRST_PLAYER, winner == DRAW);
+        }
+        if (games_count == 0) {
+            ASSERT_TEST(chessEndTournament(chess, tournament_id) == CHESS_NO_GAMES);
+            ASSERT_TEST(chessAddGame(chess, tournament_id, base_id + 1, base_id + 2, DRAW, 1) == CHESS_SUCCESS);
+            testAddGameStats(stats, 1, 0, 0, 1);
+            testAddGameStats(stats, 2, 0, 0, 1);
+        }
+        expected_winners[tournament_id] = base_id + testFindWinner(stats);
+        int leader;
+        ASSERT_TEST(chessGetTournamentLeaders(chess, tournament_id, 1, &leader) == CHESS_SUCCESS);
+        ASSERT_TEST(leader == expected_winners[tournament_id]);
+        ASSERT_TEST(chessEndTournament(chess, tournament_id) == CHESS_SUCCESS);
+    }
+    ASSERT_TEST(chessSaveTournamentStatistics(chess, RANDOM_WINNERS_FILE) == CHESS_SUCCESS);
+    chessDestroy(chess);
+    FILE* file = fopen(RANDOM_WINNERS_FILE, "r");
+    ASSERT_TEST(file != NULL);
+    for (int tournament_id = 1; tournament_id <= RANDOM_TOURNAMENTS; tournament_id++) {
+        int winner, longest_game, games_count, players_count;
+        double average_time;
+        char location[16];
+        ASSERT_TEST_WITH_FREE(fscanf(file, "%d %d %lf %15s %d %d", &winner, &longest_game, &average_time,
+                                     location, &games_count, &players_count) == 6, fclose(file));
+        ASSERT_TEST_WITH_FREE(winner == expected_winners[tournament_id], fclose(file));
+    }
+    fclose(file);
+    return true;
+}
+
+bool testChessGetTournamentLeaders(){
+    int leaders[5];
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 1, 5, leaders) == CHESS_TOURNAMENT_NOT_EXIST);
+    ASSERT_TEST(chessAddTournament(chess, 1, 4, "London") == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 1, 5, NULL) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 0, 5, leaders) == CHESS_INVALID_ID);
+    ASSERT_TEST(chessAddGame(chess, 1, 1, 2, FIRST_PLAYER, 2000) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 1, 1, 3, FIRST_PLAYER, 3000) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 1, 3, 2, SECOND_PLAYER, 3000) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 1, 5, leaders) == CHESS_SUCCESS);
+    ASSERT_TEST(leaders[0] == 1 && leaders[1] == 2 && leaders[2] == 3 && leaders[3] == -1 && leaders[4] == -1);
+    ASSERT_TEST(chessAddGame(chess, 1, 4, 1, SECOND_PLAYER, 1000) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 1, 2, 4, FIRST_PLAYER, 3500) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 1, 3, 4, DRAW, 400) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 1, 5, leaders) == CHESS_SUCCESS);
+    ASSERT_TEST(leaders[0] == 1 && leaders[1] == 2 && leaders[2] == 3 && leaders[3] == 4 && leaders[4] == -1);
+    ASSERT_TEST(chessRemovePlayer(chess, 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 1, 2, leaders) == CHESS_SUCCESS);
+    ASSERT_TEST(leaders[0] == 2 && leaders[1] == 3);
+
+    chessDestroy(chess);
+    return true;
+}
+
+bool testChessAddTournamentSharedLocations(){
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chessAddTournament(chess, 1, 4, "london") == CHESS_INVALID_LOCATION);
+    ASSERT_TEST(chessAddTournament(chess, 1, 4, "Tel aviv") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 2, 0, "Tel aviv") == CHESS_INVALID_MAX_GAMES);
+    ASSERT_TEST(chessAddTournament(chess, 2, 4, "Tel aviv") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 3, 4, "Tel Aviv") == CHESS_INVALID_LOCATION);
+    ASSERT_TEST(chessAddTournament(chess, 3, 4, "") == CHESS_INVALID_LOCATION);
+    ASSERT_TEST(chessRemoveTournament(chess, 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 3, 4, "Haifa") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 4, 4, "Tel aviv") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 3, 1, 2, DRAW, 10) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 4, 1, 2, DRAW, 10) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 4) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveTournamentStatistics(chess, LOCATIONS_FILE) == CHESS_SUCCESS);
+    chessDestroy(chess);
+    FILE* file = fopen(LOCATIONS_FILE, "r");
+    ASSERT_TEST(file != NULL);
+    char lines[12][16];
+    for (int i = 0; i < 12; i++) {
+        ASSERT_TEST_WITH_FREE(fgets(lines[i], sizeof(lines[i]), file) != NULL, fclose(file));
+    }
+    fclose(file);
+    ASSERT_TEST(strcmp(lines[3], "Haifa\n") == 0);
+    ASSERT_TEST(strcmp(lines[9], "Tel aviv\n") == 0);
+    return true;
+}
+
+bool testChessPlayerAcrossTournaments(){
+    ChessResult result;
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chessAddTournament(chess, 1, 4, "London") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 2, 4, "Paris") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 3, 4, "Paris") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 1, 1, 2, FIRST_PLAYER, 100) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 2, 1, 2, SECOND_PLAYER, 200) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 2, 3, 1, DRAW, 300) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 3, 2, 3, DRAW, 50) == CHESS_SUCCESS);
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 1, &result) == 200 && result == CHESS_SUCCESS);
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 4, &result) == -1 && result == CHESS_PLAYER_NOT_EXIST);
+    ASSERT_TEST(chessEndTournament(chess, 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 2, &result) == 150 && result == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemovePlayer(chess, 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 1, &result) == 100 && result == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 1, &result) == -1 && result == CHESS_PLAYER_NOT_EXIST);
+    ASSERT_TEST(chessRemovePlayer(chess, 1) == CHESS_PLAYER_NOT_EXIST);
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 3, &result) == 300 && result == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 2, 1, 3, FIRST_PLAYER, 400) == CHESS_SUCCESS);
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 1, &result) == 400 && result == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 2, 3, 1, DRAW, 400) == CHESS_GAME_ALREADY_EXISTS);
+
+    chessDestroy(chess);
+    return true;
+}
+
+static int testReadLines(FILE* file, char lines[][LEVELS_LINE_LENGTH], int max_lines)
+{
+    int count = 0;
+    rewind(file);
+    while (count < max_lines && fgets(lines[count], LEVELS_LINE_LENGTH, file) != NULL) {
+        count++;
+    }
+    return count;
+}
+
+bool testChessSavePlayersLevelsTopK(){
+    char all_lines[LEVELS_PLAYERS + 1][LEVELS_LINE_LENGTH];
+    char top_lines[LEVELS_PLAYERS + 1][LEVELS_LINE_LENGTH];
+    int ks[] = {0, 1, 2, 7, LEVELS_PLAYERS - 1, LEVELS_PLAYERS, LEVELS_PLAYERS + 5};
+    srand(RANDOM_SEED);
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chessAddTournament(chess, 1, LEVELS_PLAYERS, "London") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 2, LEVELS_PLAYERS, "Paris") == CHESS_SUCCESS);
+    for (int i = 0; i < 4 * LEVELS_PLAYERS; i++) {
+        int first = 1 + rand() % LEVELS_PLAYERS, second = 1 + rand() % LEVELS_PLAYERS;
+        chessAddGame(chess, 1 + rand() % 2, first, second, (Winner)(rand() % 3), rand() % 100);
+    }
+    FILE* file = tmpfile();
+    ASSERT_TEST_WITH_FREE(file != NULL, chessDestroy(chess));
+    ASSERT_TEST_WITH_FREE(chessSavePlayersLevels(chess, file) == CHESS_SUCCESS, chessDestroy(chess));
+    int all_count = testReadLines(file, all_lines, LEVELS_PLAYERS + 1);
+    fclose(file);
+    ASSERT_TEST_WITH_FREE(all_count == LEVELS_PLAYERS, chessDestroy(chess));
+    for (int i = 0; i < (int)(sizeof(ks) / sizeof(ks[0])); i++) {
+        file = tmpfile();
+        ASSERT_TEST_WITH_FREE(file != NULL, chessDestroy(chess));
+        ASSERT_TEST_WITH_FREE(chessSavePlayersLevelsTopK(chess, file, ks[i]) == CHESS_SUCCESS,
+                              (chessDestroy(chess), fclose(file)));
+        int top_count = testReadLines(file, top_lines, LEVELS_PLAYERS + 1);
+        fclose(file);
+        ASSERT_TEST_WITH_FREE(top_count == (ks[i] < all_count ? ks[i] : all_count), chessDestroy(chess));
+        for (int line = 0; line < top_count; line++) {
+            ASSERT_TEST_WITH_FREE(strcmp(top_lines[line], all_lines[line]) == 0, chessDestroy(chess));
+        }
+    }
+    ASSERT_TEST(chessSavePlayersLevelsTopK(NULL, stdout, 1) == CHESS_NULL_ARGUMENT);
+
+    chessDestroy(chess);
+    return true;
+}
+
+//Levels of exactly 0.125 and -0.125 are ties, which "%0.2f" rounds to the even digit
+bool testChessSavePlayersLevelsRounding(){
+    char lines[2 * ROUNDING_GAMES + 2][LEVELS_LINE_LENGTH];
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chessAddTournament(chess, 1, ROUNDING_GAMES, "London") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 2, ROUNDING_GAMES, "Paris") == CHESS_SUCCESS);
+    for (int i = 0; i < ROUNDING_GAMES; i++) {
+        //1000: 5 losses and 27 draws, 2000: 1 win, 6 losses and 25 draws
+        Winner first_result = i < 5 ? SECOND_PLAYER : DRAW;
+        Winner second_result = i < 1 ? FIRST_PLAYER : (i < 7 ? SECOND_PLAYER : DRAW);
+        ASSERT_TEST(chessAddGame(chess, 1, 1000, 1 + i, first_result, 10) == CHESS_SUCCESS);
+        ASSERT_TEST(chessAddGame(chess, 2, 2000, 101 + i, second_result, 10) == CHESS_SUCCESS);
+    }
+    FILE* file = fopen(ROUNDING_FILE, "w");
+    ASSERT_TEST_WITH_FREE(file != NULL, chessDestroy(chess));
+    ASSERT_TEST_WITH_FREE(chessSavePlayersLevels(chess, file) == CHESS_SUCCESS, (chessDestroy(chess), fclose(file)));
+    fclose(file);
+    file = fopen(ROUNDING_FILE, "r");
+    ASSERT_TEST_WITH_FREE(file != NULL, chessDestroy(chess));
+    int count = testReadLines(file, lines, 2 * ROUNDING_GAMES + 2);
+    bool found_positive = false, found_negative = false;
+    for (int line = 0; line < count; line++) {
+        found_positive = found_positive || strcmp(lines[line], "1000 0.12\n") == 0;
+        found_negative = found_negative || strcmp(lines[line], "2000 -0.12\n") == 0;
+    }
+    ASSERT_TEST_WITH_FREE(count == 2 * ROUNDING_GAMES + 2 && found_positive && found_negative,
+                          (chessDestroy(chess), fclose(file)));
+    //Writing to a read only stream fails when the buffered levels are written
+    ASSERT_TEST_WITH_FREE(chessSavePlayersLevels(chess, file) == CHESS_SAVE_FAILURE,
+                          (chessDestroy(chess), fclose(file)));
+    fclose(file);
+
+    chessDestroy(chess);
+    return true;
+}
+
+static bool testSameContent(FILE* first, FILE* second)
+{
+    int first_char, second_char;
+    rewind(first);
+    rewind(second);
+    do {
+        first_char = fgetc(first);
+        second_char = fgetc(second);
+    } while (first_char == second_char && first_char != EOF);
+    return first_char == second_char;
+}
+
+//Tournament 1 has already ended, and there is no tournament with the highest id the games use
+static bool testAddBatchTournaments(ChessSystem chess)
+{
+    for (int id = 1; id < BATCH_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessAddTournament(chess, id, 1 + id * 3, "London") == CHESS_SUCCESS);
+    }
+    ASSERT_TEST(chessAddGame(chess, 1, 1, 2, DRAW, 10) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 1) == CHESS_SUCCESS);
+    return true;
+}
+
+static void testRandomGameRecords(ChessGameRecord games[], int count)
+{
+    for (int i = 0; i < count; i++) {
+        ChessGameRecord game = {rand() % (BATCH_TOURNAMENTS + 1), rand() % BATCH_PLAYERS - 1,
+                                rand() % BATCH_PLAYERS - 1, (Winner)(rand() % 3), rand() % 100 - 2};
+        games[i] = game;
+    }
+}
+
+//A batch, with every kind of invalid game, is added both with chessAddGames and one game at a time
+bool testChessAddGamesBatch(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    ChessSystem batch_chess = chessCreate(), single_chess = chessCreate();
+    ASSERT_TEST(testAddBatchTournaments(batch_chess) && testAddBatchTournaments(single_chess));
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(batch_chess, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    for (int i = 0; i < BATCH_GAMES; i++) {
+        ChessResult expected = chessAddGame(single_chess, games[i].tournament_id, games[i].first_player,
+                                            games[i].second_player, games[i].winner, games[i].play_time);
+        ASSERT_TEST_WITH_FREE(results[i] == expected, (chessDestroy(batch_chess), chessDestroy(single_chess)));
+    }
+    for (int id = 2; id < BATCH_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessEndTournament(batch_chess, id) == chessEndTournament(single_chess, id));
+    }
+    ASSERT_TEST(chessSaveTournamentStatistics(batch_chess, BATCH_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveTournamentStatistics(single_chess, BATCH_EXPECTED_FILE) == CHESS_SUCCESS);
+    FILE* batch_file = fopen(BATCH_FILE, "r");
+    FILE* single_file = fopen(BATCH_EXPECTED_FILE, "r");
+    ASSERT_TEST(batch_file != NULL && single_file != NULL);
+    bool same_statistics = testSameContent(batch_file, single_file);
+    fclose(batch_file);
+    fclose(single_file);
+    batch_file = tmpfile();
+    single_file = tmpfile();
+    ASSERT_TEST(batch_file != NULL && single_file != NULL);
+    ASSERT_TEST(chessSavePlayersLevels(batch_chess, batch_file) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSavePlayersLevels(single_chess, single_file) == CHESS_SUCCESS);
+    bool same_levels = testSameContent(batch_file, single_file);
+    fclose(batch_file);
+    fclose(single_file);
+    ASSERT_TEST_WITH_FREE(same_statistics && same_levels, (chessDestroy(batch_chess), chessDestroy(single_chess)));
+    ASSERT_TEST(chessAddGames(batch_chess, NULL, 0, NULL) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(batch_chess, NULL, 1, results) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessAddGames(NULL, games, 1, results) == CHESS_NULL_ARGUMENT);
+
+    chessDestroy(batch_chess);
+    chessDestroy(single_chess);
+    return true;
+}
+
+static void testWriteInt32(FILE* file, int number)
+{
+    unsigned int bits = (unsigned int)number;
+    for (int i = 0; i < 4; i++) {
+        fputc((bits >> (8 * i)) & 0xFF, file);
+    }
+}
+
+static bool testSameReport(const ChessImportReport* first, const ChessImportReport* second)
+{
+    for (int i = 0; i < CHESS_RESULT_COUNT; i++) {
+        if (first->results[i] != second->results[i]) {
+            return false;
+        }
+    }
+    return first->malformed == second->malformed;
+}
+
+//The same games, and some malformed records, are imported from a CSV and a binary file
+bool testChessImportGames(){
+    static ChessGameRecord games[IMPORT_GAMES];
+    ChessImportReport expected = {{0}, 0}, csv_report, binary_report;
+    srand(RANDOM_SEED);
+    testRandomGameRecords(games, IMPORT_GAMES);
+    FILE* csv_file = fopen(IMPORT_CSV_FILE, "w");
+    FILE* binary_file = fopen(IMPORT_BINARY_FILE, "wb");
+    ASSERT_TEST(csv_file != NULL && binary_file != NULL);
+    fprintf(csv_file, "tournament,first,second,winner,time\n");
+    for (int i = 0; i < IMPORT_GAMES; i++) {
+        fprintf(csv_file, "%d,%d,%d,%d,%d%s", games[i].tournament_id, games[i].first_player,
+                games[i].second_player, games[i].winner, games[i].play_time, i % 2 ? "\n" : "\r\n");
+        testWriteInt32(binary_file, games[i].tournament_id);
+        testWriteInt32(binary_file, games[i].first_player);
+        testWriteInt32(binary_file, games[i].second_player);
+        testWriteInt32(binary_file, games[i].winner);
+        testWriteInt32(binary_file, games[i].play_time);
+        if (i == IMPORT_GAMES / 2) {
+            fprintf(csv_file, "\n1,2,3,4,5\n1,2,3,0,99999999999\n");
+            for (int field = 0; field < 5; field++) {
+                testWriteInt32(binary_file, field == 3 ? 3 : 1);
+            }
+        }
+    }
+    fprintf(csv_file, "1,2,3,0");
+    testWriteInt32(binary_file, 1);
+    fputc(0, binary_file);
+    fclose(csv_file);
+    fclose(binary_file);
+
+    ChessSystem csv_chess = chessCreate(), binary_chess = chessCreate(), single_chess = chessCreate();
+    ASSERT_TEST(testAddBatchTournaments(csv_chess) && testAddBatchTournaments(binary_chess));
+    ASSERT_TEST(testAddBatchTournaments(single_chess));
+    for (int i = 0; i < IMPORT_GAMES; i++) {
+        expected.results[chessAddGame(single_chess, games[i].tournament_id, games[i].first_player,
+                                      games[i].second_player, games[i].winner, games[i].play_time)]++;
+    }
+    ASSERT_TEST(chessImportGames(csv_chess, IMPORT_CSV_FILE, CHESS_IMPORT_CSV, &csv_report) == CHESS_SUCCESS);
+    ASSERT_TEST(chessImportGames(binary_chess, IMPORT_BINARY_FILE, CHESS_IMPORT_BINARY,
+                                 &binary_report) == CHESS_SUCCESS);
+    expected.malformed = 4; //The header line, the invalid winner, the too large play time and the last line
+    ASSERT_TEST(testSameReport(&csv_report, &expected));
+    expected.malformed = 2; //The invalid winner and the truncated last record
+    ASSERT_TEST(testSameReport(&binary_report, &expected));
+    FILE* csv_levels = tmpfile();
+    FILE* binary_levels = tmpfile();
+    FILE* single_levels = tmpfile();
+    ASSERT_TEST(csv_levels != NULL && binary_levels != NULL && single_levels != NULL);
+    ASSERT_TEST(chessSavePlayersLevels(csv_chess, csv_levels) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSavePlayersLevels(binary_chess, binary_levels) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSavePlayersLevels(single_chess, single_levels) == CHESS_SUCCESS);
+    bool same_levels = testSameContent(csv_levels, single_levels) && testSameContent(binary_levels, single_levels);
+    fclose(csv_levels);
+    fclose(binary_levels);
+    fclose(single_levels);
+    ASSERT_TEST(same_levels);
+    ASSERT_TEST(chessImportGames(csv_chess, "./tests/no_such_file.csv", CHESS_IMPORT_CSV,
+                                 &csv_report) == CHESS_LOAD_FAILURE);
+    ASSERT_TEST(chessImportGames(csv_chess, NULL, CHESS_IMPORT_CSV, &csv_report) == CHESS_NULL_ARGUMENT);
+
+    chessDestroy(csv_chess);
+    chessDestroy(binary_chess);
+    chessDestroy(single_chess);
+    return true;
+}
+
+//Compares everything the two systems export
+static bool testSameSystems(ChessSystem first, ChessSystem second)
+{
+    int first_leaders[BATCH_PLAYERS], second_leaders[BATCH_PLAYERS];
+    for (int id = 1; id <= BATCH_TOURNAMENTS; id++) {
+        memset(first_leaders, 0, sizeof(first_leaders)); //Left as they are for a tournament that does not exist
+        memset(second_leaders, 0, sizeof(second_leaders));
+        ChessResult result = chessGetTournamentLeaders(first, id, BATCH_PLAYERS, first_leaders);
+        ASSERT_TEST(chessGetTournamentLeaders(second, id, BATCH_PLAYERS, second_leaders) == result);
+        ASSERT_TEST(memcmp(first_leaders, second_leaders, sizeof(first_leaders)) == 0);
+    }
+    ASSERT_TEST(chessSaveTournamentStatistics(first, BATCH_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveTournamentStatistics(second, BATCH_EXPECTED_FILE) == CHESS_SUCCESS);
+    FILE* first_file = fopen(BATCH_FILE, "r");
+    FILE* second_file = fopen(BATCH_EXPECTED_FILE, "r");
+    ASSERT_TEST(first_file != NULL && second_file != NULL);
+    bool same_statistics = testSameContent(first_file, second_file);
+    fclose(first_file);
+    fclose(second_file);
+    first_file = tmpfile();
+    second_file = tmpfile();
+    ASSERT_TEST(first_file != NULL && second_file != NULL);
+    ASSERT_TEST(chessSavePlayersLevels(first, first_file) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSavePlayersLevels(second, second_file) == CHESS_SUCCESS);
+    bool same_levels = testSameContent(first_file, second_file);
+    fclose(first_file);
+    fclose(second_file);
+    return same_statistics && same_levels;
+}
+
+//A loaded system has to behave like the saved one, also when both are changed after loading
+bool testChessSaveAndLoadSnapshot(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(testAddBatchTournaments(chess));
+    ASSERT_TEST(chessAddTournament(chess, BATCH_TOURNAMENTS, 3, "Tel aviv") == CHESS_SUCCESS);
+    testRandomGameRecords(games, BATCH_GAMES / 2);
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES / 2, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemovePlayer(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ChessSystem loaded = chessLoadSnapshot(SNAPSHOT_FILE);
+    ASSERT_TEST(loaded != NULL);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, loaded), (chessDestroy(chess), chessDestroy(loaded)));
+
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(loaded, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    for (int player = 1; player < 4; player++) {
+        ASSERT_TEST(chessRemovePlayer(chess, player) == chessRemovePlayer(loaded, player));
+    }
+    for (int id = 1; id <= BATCH_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessEndTournament(chess, id) == chessEndTournament(loaded, id));
+    }
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, loaded), (chessDestroy(chess), chessDestroy(loaded)));
+    chessDestroy(loaded);
+
+    FILE* file = fopen(SNAPSHOT_FILE, "rb");
+    FILE* corrupt = fopen(SNAPSHOT_CORRUPT_FILE, "wb");
+    ASSERT_TEST(file != NULL && corrupt != NULL);
+    int byte, position = 0;
+    while ((byte = fgetc(file)) != EOF) {
+        fputc(position++ == 100 ? byte ^ 1 : byte, corrupt);
+    }
+    fclose(file);
+    fclose(corrupt);
+    ASSERT_TEST(chessLoadSnapshot(SNAPSHOT_CORRUPT_FILE) == NULL);
+    ASSERT_TEST(chessLoadSnapshot("./tests/no_such_file.bin") == NULL);
+    ASSERT_TEST(chessSaveSnapshot(NULL, SNAPSHOT_FILE) == CHESS_NULL_ARGUMENT);
+
+    chessDestroy(chess);
+    return true;
+}
+
+//A replayed journal has to rebuild the system, and a torn last record has to be dropped
+bool testChessReplayJournal(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    remove(JOURNAL_FILE);
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chessOpenJournal(chess, JOURNAL_FILE, 16) == CHESS_SUCCESS);
+    ASSERT_TEST(testAddBatchTournaments(chess));
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES / 2, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 4, 1000, 1001, DRAW, 5) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemovePlayer(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(chess, games + BATCH_GAMES / 2, BATCH_GAMES / 2, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, BATCH_TOURNAMENTS - 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessCloseJournal(chess) == CHESS_SUCCESS);
+
+    ChessSystem replayed = chessCreate();
+    ASSERT_TEST(chessReplayJournal(replayed, JOURNAL_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, replayed), (chessDestroy(chess), chessDestroy(replayed)));
+    chessDestroy(replayed);
+
+    FILE* file = fopen(JOURNAL_FILE, "rb");
+    FILE* torn = fopen(JOURNAL_TORN_FILE, "wb");
+    ASSERT_TEST(file != NULL && torn != NULL);
+    ASSERT_TEST(fseek(file, 0, SEEK_END) == 0);
+    long size = ftell(file);
+    rewind(file);
+    for (long position = 0; position < size - JOURNAL_TORN_BYTES; position++) {
+        fputc(fgetc(file), torn);
+    }
+    fclose(file);
+    fclose(torn);
+    replayed = chessCreate();
+    ASSERT_TEST(chessReplayJournal(replayed, JOURNAL_TORN_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessOpenJournal(replayed, JOURNAL_TORN_FILE, 0) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(replayed, BATCH_TOURNAMENTS - 1) == CHESS_SUCCESS);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, replayed), (chessDestroy(chess), chessDestroy(replayed)));
+    chessDestroy(replayed);
+
+    //Reopening cut the torn record off, so the new one is read after it
+    replayed = chessCreate();
+    ASSERT_TEST(chessReplayJournal(replayed, JOURNAL_TORN_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(replayed, BATCH_TOURNAMENTS - 1) == CHESS_TOURNAMENT_ENDED);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, replayed), (chessDestroy(chess), chessDestroy(replayed)));
+    chessDestroy(replayed);
+
+    ASSERT_TEST(chessReplayJournal(chess, "./tests/no_such_file.bin") == CHESS_LOAD_FAILURE);
+    ASSERT_TEST(chessReplayJournal(NULL, JOURNAL_FILE) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessOpenJournal(chess, NULL, 0) == CHESS_NULL_ARGUMENT);
+    chessDestroy(chess);
+    return true;
+}
+
+
+//Replaying the journal a checkpoint started onto its snapshot has to redo only the later changes
+bool testChessCheckpointAndReplay(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    remove(JOURNAL_FILE);
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chessOpenJournal(chess, JOURNAL_FILE, 16) == CHESS_SUCCESS);
+    ASSERT_TEST(testAddBatchTournaments(chess));
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES / 2, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveCheckpoint(chess, SNAPSHOT_FILE, JOURNAL_FILE, 16) == CHESS_SUCCESS);
+    //Player 3 played before the checkpoint, so replaying those games after removing them would add them again
+    ASSERT_TEST(chessRemovePlayer(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(chess, games + BATCH_GAMES / 2, BATCH_GAMES / 2, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessCloseJournal(chess) == CHESS_SUCCESS);
+
+    ChessSystem loaded = chessLoadSnapshot(SNAPSHOT_FILE);
+    ASSERT_TEST(loaded != NULL);
+    ASSERT_TEST(chessReplayJournal(loaded, JOURNAL_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, loaded), (chessDestroy(chess), chessDestroy(loaded)));
+    chessDestroy(loaded);
+
+    ASSERT_TEST(chessSaveCheckpoint(NULL, SNAPSHOT_FILE, JOURNAL_FILE, 0) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessSaveCheckpoint(chess, SNAPSHOT_FILE, NULL, 0) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessSaveCheckpoint(chess, "./tests/no_such_dir/snapshot.bin", JOURNAL_FILE, 0) == CHESS_SAVE_FAILURE);
+    chessDestroy(chess);
+    return true;
+}
+
+//Each worker adds the games of the tournaments with id % THREADS == thread, in the order of the batch
+static void* testAddGamesWorker(void* argument)
+{
+    TestWorker *worker = argument;
+    for (int i = 0; i < BATCH_GAMES; i++) {
+        const ChessGameRecord *game = &worker->games[i];
+        if (game->tournament_id % THREADS == worker->thread) {
+            worker->results[i] = chessAddGame(worker->chess, game->tournament_id, game->first_player,
+                                              game->second_player, game->winner, game->play_time);
+        }
+    }
+    return NULL;
+}
+
+//Games of different tournaments added from several threads have to give the same system as adding them in order
+bool testChessThreadSafeAddGames(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    static ChessResult expected_results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    ASSERT_TEST(chessCreateThreadSafe(0) == NULL);
+    ChessSystem chess = chessCreateThreadSafe(THREAD_SAFE_SHARDS);
+    ChessSystem expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    ASSERT_TEST(testAddBatchTournaments(chess));
+    ASSERT_TEST(testAddBatchTournaments(expected));
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES, expected_results) == CHESS_SUCCESS);
+
+    pthread_t threads[THREADS];
+    TestWorker workers[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        TestWorker worker = {chess, games, results, i};
+        workers[i] = worker;
+        ASSERT_TEST(pthread_create(&threads[i], NULL, testAddGamesWorker, &workers[i]) == 0);
+    }
+    //Reading while the games are added only has to be safe, its result depends on the timing
+    FILE* file = tmpfile();
+    ASSERT_TEST(file != NULL);
+    ASSERT_TEST(chessSavePlayersLevels(chess, file) == CHESS_SUCCESS);
+    fclose(file);
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    ASSERT_TEST(memcmp(results, expected_results, sizeof(results)) == 0);
+
+    ASSERT_TEST(chessRemovePlayer(chess, 3) == chessRemovePlayer(expected, 3));
+    for (int id = 1; id <= BATCH_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessEndTournament(chess, id) == chessEndTournament(expected, id));
+    }
+    ASSERT_TEST(chessRemoveTournament(chess, 4) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(expected, 4) == CHESS_SUCCESS);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, expected), (chessDestroy(chess), chessDestroy(expected)));
+    chessDestroy(expected);
+
+    //Snapshots do not depend on the shards, and load into a system with other shards that threads keep changing
+    ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ChessSystem loaded = chessCreateThreadSafe(THREAD_SAFE_SHARDS + 1);
+    ASSERT_TEST(loaded != NULL && chessLoadSnapshotInto(loaded, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessLoadSnapshotInto(loaded, SNAPSHOT_FILE) == CHESS_LOAD_FAILURE); //It is not empty anymore
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, loaded), (chessDestroy(chess), chessDestroy(loaded)));
+    for (int id = BATCH_TOURNAMENTS + 1; id < 2 * BATCH_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessAddTournament(chess, id, id * 3, "London") == CHESS_SUCCESS);
+        ASSERT_TEST(chessAddTournament(loaded, id, id * 3, "London") == CHESS_SUCCESS);
+    }
+    for (int i = 0; i < BATCH_GAMES; i++) {
+        games[i].tournament_id += BATCH_TOURNAMENTS;
+    }
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES, expected_results) == CHESS_SUCCESS);
+    for (int i = 0; i < THREADS; i++) {
+        TestWorker worker = {loaded, games, results, i};
+        workers[i] = worker;
+        ASSERT_TEST(pthread_create(&threads[i], NULL, testAddGamesWorker, &workers[i]) == 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    ASSERT_TEST(memcmp(results, expected_results, sizeof(results)) == 0);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, loaded), (chessDestroy(chess), chessDestroy(loaded)));
+    chessDestroy(loaded);
+    chessDestroy(chess);
+    return true;
+}
+
+static bool testSameLevels(ChessSystem chess, int first_threads, int second_threads)
+{
+    FILE* first_file = tmpfile();
+    FILE* second_file = tmpfile();
+    ASSERT_TEST(first_file != NULL && second_file != NULL);
+    ASSERT_TEST(chessSetExportThreads(chess, first_threads) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSavePlayersLevels(chess, first_file) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSetExportThreads(chess, second_threads) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSavePlayersLevels(chess, second_file) == CHESS_SUCCESS);
+    ASSERT_TEST(ftell(first_file) > 0);
+    bool same = testSameContent(first_file, second_file);
+    fclose(first_file);
+    fclose(second_file);
+    return same;
+}
+
+//Enough players and games for the exports to use several threads
+static bool testAddParallelGames(ChessSystem chess)
+{
+    static ChessGameRecord games[PARALLEL_GAMES];
+    static ChessResult results[PARALLEL_GAMES];
+    srand(RANDOM_SEED);
+    for (int id = 1; id <= PARALLEL_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessAddTournament(chess, id, PARALLEL_GAMES, "London") == CHESS_SUCCESS);
+    }
+    for (int i = 0; i < PARALLEL_GAMES; i++) {
+        ChessGameRecord game = {rand() % PARALLEL_TOURNAMENTS + 1, rand() % PARALLEL_PLAYERS + 1,
+                                rand() % PARALLEL_PLAYERS + 1, (Winner)(rand() % 3), rand() % 100};
+        games[i] = game;
+    }
+    ASSERT_TEST(chessAddGames(chess, games, PARALLEL_GAMES, results) == CHESS_SUCCESS);
+    return true;
+}
+
+//The levels computed by several threads have to be exactly the serial ones, in the same order
+bool testChessSavePlayersLevelsParallel(){
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST_WITH_FREE(testAddParallelGames(chess), chessDestroy(chess));
+    ASSERT_TEST_WITH_FREE(testSameLevels(chess, 1, 3), chessDestroy(chess));
+    ASSERT_TEST_WITH_FREE(testSameLevels(chess, 1, 100), chessDestroy(chess));
+    for (int player = 1; player < PARALLEL_PLAYERS; player += 7) {
+        chessRemovePlayer(chess, player);
+    }
+    ASSERT_TEST_WITH_FREE(testSameLevels(chess, 1, 4), chessDestroy(chess));
+    ASSERT_TEST_WITH_FREE(testSameLevels(chess, 0, 2), chessDestroy(chess));
+    ASSERT_TEST(chessSetExportThreads(NULL, 2) == CHESS_NULL_ARGUMENT);
+    chessDestroy(chess);
+    return true;
+}
+
+//The statistics printed by several threads have to be written in the order of the tournaments
+bool testChessSaveTournamentStatisticsParallel(){
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST_WITH_FREE(testAddParallelGames(chess), chessDestroy(chess));
+    //A few of the tournaments got no games
+    for (int id = 1; id <= PARALLEL_TOURNAMENTS; id += 2) {
+        ChessResult result = chessEndTournament(chess, id);
+        ASSERT_TEST(result == CHESS_SUCCESS || result == CHESS_NO_GAMES);
+    }
+    ASSERT_TEST(chessRemoveTournament(chess, 1) == CHESS_SUCCESS);
+    for (int threads = 2; threads <= 5; threads++) {
+        ASSERT_TEST(chessSetExportThreads(chess, 1) == CHESS_SUCCESS);
+        ASSERT_TEST(chessSaveTournamentStatistics(chess, BATCH_EXPECTED_FILE) == CHESS_SUCCESS);
+        ASSERT_TEST(chessSetExportThreads(chess, threads) == CHESS_SUCCESS);
+        ASSERT_TEST(chessSaveTournamentStatistics(chess, BATCH_FILE) == CHESS_SUCCESS);
+        FILE* file = fopen(BATCH_FILE, "r");
+        FILE* expected_file = fopen(BATCH_EXPECTED_FILE, "r");
+        ASSERT_TEST(file != NULL && expected_file != NULL);
+        bool same = testSameContent(file, expected_file);
+        fclose(file);
+        fclose(expected_file);
+        ASSERT_TEST_WITH_FREE(same, chessDestroy(chess));
+    }
+    chessDestroy(chess);
+    return true;
+}
+
+static void testStoreResult(const ChessGameRecord* game, ChessResult result, void* context)
+{
+    *(ChessResult*)context = result;
+}
+
+//Each producer submits the games of the tournaments with id % THREADS == thread, so they keep their order
+static void* testSubmitGamesWorker(void* argument)
+{
+    TestProducer *producer = argument;
+    for (int i = 0; i < BATCH_GAMES; i++) {
+        if (producer->games[i].tournament_id % THREADS == producer->thread &&
+            chessIngestQueueSubmit(producer->queue, &producer->games[i], testStoreResult,
+                                   &producer->results[i]) != CHESS_SUCCESS) {
+            producer->results[i] = CHESS_QUEUE_FULL;
+        }
+    }
+    return NULL;
+}
+
+//Games submitted from several threads have to get the results of adding them in order
+bool testChessIngestQueue(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    static ChessResult expected_results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    ChessSystem chess = chessCreateThreadSafe(THREAD_SAFE_SHARDS);
+    ChessSystem expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    ASSERT_TEST(testAddBatchTournaments(chess));
+    ASSERT_TEST(testAddBatchTournaments(expected));
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES, expected_results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessIngestQueueCreate(chess, 0, CHESS_INGEST_BLOCK) == NULL);
+    ChessIngestQueue queue = chessIngestQueueCreate(chess, QUEUE_CAPACITY, CHESS_INGEST_BLOCK);
+    ASSERT_TEST(queue != NULL);
+
+    pthread_t threads[THREADS];
+    TestProducer producers[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        TestProducer producer = {queue, games, results, i};
+        producers[i] = producer;
+        ASSERT_TEST(pthread_create(&threads[i], NULL, testSubmitGamesWorker, &producers[i]) == 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    chessIngestQueueFlush(queue);
+    ASSERT_TEST(memcmp(results, expected_results, sizeof(results)) == 0);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, expected), (chessDestroy(chess), chessDestroy(expected)));
+    chessDestroy(expected);
+
+    ChessGameFuture future;
+    ChessGameRecord game = {2, 1000, 1001, DRAW, -1};
+    ASSERT_TEST(chessIngestQueueSubmitFuture(queue, &game, &future) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGameFutureWait(&future) == CHESS_INVALID_PLAY_TIME);
+    ASSERT_TEST(chessIngestQueueSubmit(queue, NULL, NULL, NULL) == CHESS_NULL_ARGUMENT);
+    chessIngestQueueDestroy(queue);
+
+    //A full queue may refuse games, but every game it took gets its result
+    queue = chessIngestQueueCreate(chess, 1, CHESS_INGEST_FAIL);
+    ASSERT_TEST(queue != NULL);
+    static ChessGameFuture futures[FULL_QUEUE_GAMES];
+    int queued = 0;
+    for (int i = 0; i < FULL_QUEUE_GAMES; i++) {
+        ChessGameRecord full_game = {3, 2000 + i, 3000 + i, FIRST_PLAYER, 1};
+        ChessResult result = chessIngestQueueSubmitFuture(queue, &full_game, &futures[i]);
+        ASSERT_TEST(result == CHESS_SUCCESS || result == CHESS_QUEUE_FULL);
+        if (result == CHESS_SUCCESS) {
+            queued++;
+        }
+        else {
+            ASSERT_TEST(chessGameFutureIsDone(&futures[i]) && chessGameFutureWait(&futures[i]) == CHESS_QUEUE_FULL);
+        }
+    }
+    ASSERT_TEST(chessGameFutureWait(&futures[0]) == CHESS_SUCCESS); //The queue was empty for the first one
+    ASSERT_TEST(chessIngestQueueSubmitFuture(queue, NULL, &future) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessGameFutureWait(&future) == CHESS_NULL_ARGUMENT);
+    chessIngestQueueDestroy(queue);
+    ASSERT_TEST(queued > 0);
+    for (int i = 0; i < FULL_QUEUE_GAMES; i++) {
+        ASSERT_TEST(chessGameFutureIsDone(&futures[i]));
+    }
+    chessDestroy(chess);
+    return true;
+}
+
+static bool testSameFiles(const char* first_path, const char* second_path)
+{
+    FILE* first = fopen(first_path, "r");
+    FILE* second = fopen(second_path, "r");
+    bool same = first != NULL && second != NULL && testSameContent(first, second);
+    if (first != NULL) {
+        fclose(first);
+    }
+    if (second != NULL) {
+        fclose(second);
+    }
+    return same;
+}
+
+//A snapshot keeps the state it was taken at while games are added on another thread, and outlives the system
+bool testChessReadSnapshot(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    ChessSystem chess = chessCreateThreadSafe(THREAD_SAFE_SHARDS);
+    ASSERT_TEST(chess != NULL);
+    ASSERT_TEST(testAddBatchTournaments(chess));
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES / 2, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 2) == CHESS_SUCCESS);
+    ChessReadSnapshot snapshot = chessAcquireSnapshot(chess);
+    ChessReadSnapshot kept = chessAcquireSnapshot(chess);
+    ASSERT_TEST(snapshot != NULL && kept != NULL);
+    FILE* expected_levels = tmpfile();
+    FILE* levels = tmpfile();
+    ASSERT_TEST(expected_levels != NULL && levels != NULL);
+    ASSERT_TEST(chessSavePlayersLevels(chess, expected_levels) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveTournamentStatistics(chess, BATCH_EXPECTED_FILE) == CHESS_SUCCESS);
+
+    pthread_t thread;
+    TestWorker worker = {chess, games, results, 0};
+    ASSERT_TEST(pthread_create(&thread, NULL, testAddGamesWorker, &worker) == 0);
+    ASSERT_TEST(chessSnapshotSavePlayersLevels(snapshot, levels) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSnapshotSaveTournamentStatistics(snapshot, BATCH_FILE) == CHESS_SUCCESS);
+    //New views are copied one shard at a time while the games are added
+    for (int i = 0; i < SNAPSHOTS_WHILE_ADDING; i++) {
+        ChessReadSnapshot adding = chessAcquireSnapshot(chess);
+        ASSERT_TEST(adding != NULL);
+        chessReleaseSnapshot(adding);
+    }
+    pthread_join(thread, NULL);
+    ASSERT_TEST(testSameContent(levels, expected_levels));
+    ASSERT_TEST(testSameFiles(BATCH_FILE, BATCH_EXPECTED_FILE));
+    chessReleaseSnapshot(snapshot);
+
+    //Once the games are in, the shards add up to the same view as a single shard
+    static ChessResult expected_results[BATCH_GAMES];
+    ChessSystem expected = chessCreate();
+    ASSERT_TEST(expected != NULL);
+    ASSERT_TEST(testAddBatchTournaments(expected));
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES / 2, expected_results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(expected, 2) == CHESS_SUCCESS);
+    TestWorker expected_worker = {expected, games, expected_results, 0};
+    testAddGamesWorker(&expected_worker);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, expected), (chessDestroy(chess), chessDestroy(expected)));
+    chessDestroy(expected);
+
+    //A new snapshot sees the changes, the one that is kept does not
+    ASSERT_TEST(chessEndTournament(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveTournamentStatistics(chess, BATCH_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(!testSameFiles(BATCH_FILE, BATCH_EXPECTED_FILE));
+    chessDestroy(chess);
+    rewind(levels);
+    ASSERT_TEST(chessSnapshotSavePlayersLevels(kept, levels) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameContent(levels, expected_levels));
+    ASSERT_TEST(chessSnapshotSaveTournamentStatistics(kept, BATCH_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameFiles(BATCH_FILE, BATCH_EXPECTED_FILE));
+    fclose(levels);
+    fclose(expected_levels);
+    chessReleaseSnapshot(kept);
+
+    ASSERT_TEST(chessAcquireSnapshot(NULL) == NULL);
+    ASSERT_TEST(chessSnapshotSavePlayersLevelsTopK(NULL, stdout, 1) == CHESS_NULL_ARGUMENT);
+    chessReleaseSnapshot(NULL);
+    return true;
+}
+
+//Removing tournaments with a background reclaimer has to leave the same system as removing them directly
+bool testChessBackgroundReclaim(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    ChessSystem chess = chessCreateThreadSafe(THREAD_SAFE_SHARDS);
+    ChessSystem expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    ASSERT_TEST(chessSetBackgroundReclaim(chess, true) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSetBackgroundReclaim(chess, true) == CHESS_SUCCESS);
+    ASSERT_TEST(testAddBatchTournaments(chess));
+    ASSERT_TEST(testAddBatchTournaments(expected));
+    testRandomGameRecords(games, BATCH_GAMES);
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    for (int id = 1; id < BATCH_TOURNAMENTS; id += 2) {
+        ASSERT_TEST(chessRemoveTournament(chess, id) == CHESS_SUCCESS);
+        ASSERT_TEST(chessRemoveTournament(expected, id) == CHESS_SUCCESS);
+    }
+    //The location of the removed tournaments is gone, so it is interned again
+    ASSERT_TEST(chessAddTournament(chess, 1, 4, "Paris") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(expected, 1, 4, "Paris") == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 4) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(expected, 4) == CHESS_SUCCESS);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, expected), (chessDestroy(chess), chessDestroy(expected)));
+    ASSERT_TEST(chessSetBackgroundReclaim(chess, false) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(expected, 2) == CHESS_SUCCESS);
+    ASSERT_TEST_WITH_FREE(testSameSystems(chess, expected), (chessDestroy(chess), chessDestroy(expected)));
+
+    //Destroying the system waits for the tournaments that are still being freed
+    ASSERT_TEST(chessSetBackgroundReclaim(chess, true) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 4) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSetBackgroundReclaim(NULL, true) == CHESS_NULL_ARGUMENT);
+    chessDestroy(chess);
+    chessDestroy(expected);
+    return true;
+}
+
+//The bytes of a tournament grow with its games, and the arena is freed with the tournament
+bool testChessTournamentBytesInUse(){
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chess != NULL);
+    ASSERT_TEST(chessAddTournament(chess, 1, ARENA_GAMES, "London") == CHESS_SUCCESS);
+    size_t empty_bytes, bytes, previous_bytes;
+    ASSERT_TEST(chessGetTournamentBytesInUse(chess, 1, &empty_bytes) == CHESS_SUCCESS);
+    ASSERT_TEST(empty_bytes > 0);
+    previous_bytes = empty_bytes;
+    for (int i = 0; i < ARENA_GAMES; i++) {
+        ASSERT_TEST(chessAddGame(chess, 1, i + 1, i + 2, DRAW, 5) == CHESS_SUCCESS);
+        ASSERT_TEST(chessGetTournamentBytesInUse(chess, 1, &bytes) == CHESS_SUCCESS);
+        ASSERT_TEST(bytes >= previous_bytes);
+        previous_bytes = bytes;
+    }
+    ASSERT_TEST(bytes > empty_bytes + ARENA_GAMES * sizeof(int));
+    ASSERT_TEST(chessAddGame(chess, 1, 1, 2, DRAW, 5) == CHESS_GAME_ALREADY_EXISTS);
+    ASSERT_TEST(chessGetTournamentBytesInUse(chess, 1, &previous_bytes) == CHESS_SUCCESS);
+    ASSERT_TEST(previous_bytes == bytes);
+
+    //A loaded tournament is packed into its arena at once, so it takes no more than the one it was saved from
+    ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ChessSystem loaded = chessLoadSnapshot(SNAPSHOT_FILE);
+    ASSERT_TEST(loaded != NULL);
+    ASSERT_TEST(chessGetTournamentBytesInUse(loaded, 1, &previous_bytes) == CHESS_SUCCESS);
+    ASSERT_TEST(previous_bytes > empty_bytes && previous_bytes <= bytes);
+    chessDestroy(loaded);
+
+    ASSERT_TEST(chessRemoveTournament(chess, 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetTournamentBytesInUse(chess, 1, &bytes) == CHESS_TOURNAMENT_NOT_EXIST);
+    ASSERT_TEST(chessGetTournamentBytesInUse(chess, 0, &bytes) == CHESS_INVALID_ID);
+    ASSERT_TEST(chessGetTournamentBytesInUse(chess, 1, NULL) == CHESS_NULL_ARGUMENT);
+    chessDestroy(chess);
+    return true;
+}
+
+//Once the tournament has room for the games and the players are in it, adding games never calls the allocator
+bool testChessAddGameNoAllocations(){
+    ChessCountingAllocator counting;
+    chessCountingAllocatorInit(&counting, 0);
+    ChessSystem chess = chessCreateWithAllocator(&counting.allocator);
+    ASSERT_TEST(chess != NULL);
+    ASSERT_TEST(chessAddTournament(chess, 1, STEADY_PLAYERS, "London") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, 2, STEADY_PLAYERS, "Paris") == CHESS_SUCCESS);
+    size_t allocations = 0;
+    int games = 0;
+    for (int first = 1; first <= STEADY_PLAYERS; first++) {
+        for (int second = first + 1; second <= STEADY_PLAYERS; second++, games++) {
+            if (games == WARM_UP_GAMES) {
+                allocations = counting.allocations;
+            }
+            ASSERT_TEST(chessAddGame(chess, 1, first, second, (Winner)(games % 3), games % 50) == CHESS_SUCCESS);
+        }
+    }
+    ASSERT_TEST(allocations > 0 && counting.allocations == allocations);
+    //Failed games do not allocate either
+    ASSERT_TEST(chessAddGame(chess, 1, 1, 2, DRAW, 10) == CHESS_GAME_ALREADY_EXISTS);
+    ASSERT_TEST(chessAddGame(chess, 3, 1, 2, DRAW, 10) == CHESS_TOURNAMENT_NOT_EXIST);
+    ASSERT_TEST(counting.allocations == allocations);
+
+    //The first games and players of a tournament fit in the chunk it was created with
+    ASSERT_TEST(chessAddGame(chess, 2, 1, 2, DRAW, 10) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, 2, 3, 4, FIRST_PLAYER, 10) == CHESS_SUCCESS);
+    ASSERT_TEST(counting.allocations == allocations);
+    chessDestroy(chess);
+    return true;
+}
+
+//Everything the system takes from its allocator is given back, and running out of memory leaves it usable
+bool testChessCreateWithAllocator(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    ChessCountingAllocator counting;
+    chessCountingAllocatorInit(&counting, 0);
+    srand(RANDOM_SEED);
+    testRandomGameRecords(games, BATCH_GAMES);
+    ChessSystem chess = chessCreateWithAllocator(&counting.allocator);
+    ChessSystem expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    ASSERT_TEST(testAddBatchTournaments(chess) && testAddBatchTournaments(expected));
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 2) == CHESS_SUCCESS && chessEndTournament(expected, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(expected, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(counting.blocks > 0 && counting.peak_bytes >= counting.bytes);
+
+    ChessMemoryUsage usage;
+    size_t bytes;
+    ASSERT_TEST(chessGetMemoryUsage(chess, 1, &usage) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetTournamentBytesInUse(chess, 1, &bytes) == CHESS_SUCCESS);
+    ASSERT_TEST(usage.bytes == bytes && usage.objects > 1 && usage.bytes < counting.bytes);
+    ASSERT_TEST(chessGetMemoryUsage(chess, 3, &usage) == CHESS_TOURNAMENT_NOT_EXIST);
+    ASSERT_TEST(chessGetMemoryUsage(chess, 0, &usage) == CHESS_INVALID_ID);
+    ASSERT_TEST(chessGetMemoryUsage(chess, 1, NULL) == CHESS_NULL_ARGUMENT);
+
+    //Removing a tournament gives back all that it took from the allocator, and the block of its key
+    size_t system_bytes = counting.bytes, system_blocks = counting.blocks;
+    ASSERT_TEST(chessGetMemoryUsage(chess, ARCHIVE_TOURNAMENT, &usage) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, ARCHIVE_TOURNAMENT) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(expected, ARCHIVE_TOURNAMENT) == CHESS_SUCCESS);
+    ASSERT_TEST(system_bytes - counting.bytes > usage.bytes && system_blocks - counting.blocks == usage.objects + 1);
+
+    ChessReadSnapshot snapshot = chessAcquireSnapshot(chess);
+    ASSERT_TEST(snapshot != NULL);
+    ASSERT_TEST(chessSaveTournamentStatistics(expected, BATCH_EXPECTED_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSnapshotSaveTournamentStatistics(snapshot, BATCH_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameFiles(BATCH_FILE, BATCH_EXPECTED_FILE));
+    ASSERT_TEST(testSameSystems(chess, expected));
+
+    //A snapshot loads into a system with its own allocator
+    ChessCountingAllocator loading;
+    chessCountingAllocatorInit(&loading, 0);
+    ChessSystem loaded = chessCreateWithAllocator(&loading.allocator);
+    ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(loaded != NULL && chessLoadSnapshotInto(loaded, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(loading.blocks > 0 && loading.bytes > 0);
+    ASSERT_TEST(testSameSystems(chess, loaded));
+    chessDestroy(loaded);
+    ASSERT_TEST(loading.bytes == 0 && loading.blocks == 0);
+    ASSERT_TEST(chessLoadSnapshotInto(NULL, SNAPSHOT_FILE) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessLoadSnapshotInto(chess, NULL) == CHESS_NULL_ARGUMENT);
+
+    chessDestroy(chess);
+    chessDestroy(expected);
+    ASSERT_TEST(counting.blocks > 0); //The snapshot is still held
+    chessReleaseSnapshot(snapshot);
+    ASSERT_TEST(counting.bytes == 0 && counting.blocks == 0);
+
+    chessCountingAllocatorInit(&counting, ALLOCATOR_LIMIT);
+    chess = chessCreateWithAllocator(&counting.allocator);
+    ASSERT_TEST(chess != NULL);
+    int tournament_id = 1;
+    ChessResult result;
+    while ((result = chessAddTournament(chess, tournament_id, BATCH_GAMES, "London")) == CHESS_SUCCESS) {
+        ASSERT_TEST(chessAddGame(chess, tournament_id, 1, 2, DRAW, 10) == CHESS_SUCCESS);
+        tournament_id++;
+    }
+    ASSERT_TEST(result == CHESS_OUT_OF_MEMORY && tournament_id > 1);
+    ASSERT_TEST(counting.bytes <= ALLOCATOR_LIMIT && counting.peak_bytes <= ALLOCATOR_LIMIT);
+    ASSERT_TEST(chessRemoveTournament(chess, 1) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddTournament(chess, tournament_id, BATCH_GAMES, "London") == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGame(chess, tournament_id, 1, 2, DRAW, 10) == CHESS_SUCCESS);
+    chessDestroy(chess);
+    ASSERT_TEST(counting.bytes == 0 && counting.blocks == 0);
+
+    ASSERT_TEST(chessCreateWithAllocator(NULL) == NULL);
+    return true;
+}
+
+//A system with frozen tournaments gives the same results as one without, and takes less memory
+bool testChessFreezeEndedTournaments(){
+    static ChessGameRecord games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    testRandomGameRecords(games, BATCH_GAMES);
+    ChessSystem chess = chessCreate(), expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    ASSERT_TEST(testAddBatchTournaments(chess) && testAddBatchTournaments(expected));
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, 2) == CHESS_SUCCESS && chessEndTournament(expected, 2) == CHESS_SUCCESS);
+    ChessMemoryUsage before, after;
+    ASSERT_TEST(chessGetMemoryUsage(chess, 2, &before) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSetFreezeEndedTournaments(chess, true) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetMemoryUsage(chess, 2, &after) == CHESS_SUCCESS);
+    ASSERT_TEST(after.bytes < before.bytes && after.objects < before.objects);
+    ASSERT_TEST(chessEndTournament(chess, 3) == CHESS_SUCCESS && chessEndTournament(expected, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameSystems(chess, expected));
+
+    //The frozen tournaments can not change, and are saved as they were
+    ASSERT_TEST(chessAddGame(chess, 3, 1, 2, DRAW, 10) == CHESS_TOURNAMENT_ENDED);
+    ASSERT_TEST(chessEndTournament(chess, 3) == CHESS_TOURNAMENT_ENDED);
+    ASSERT_TEST(chessRemovePlayer(chess, 3) == chessRemovePlayer(expected, 3));
+    ChessResult first_result, second_result;
+    double average = chessCalculateAveragePlayTime(chess, 4, &first_result);
+    ASSERT_TEST(average == chessCalculateAveragePlayTime(expected, 4, &second_result));
+    ASSERT_TEST(first_result == second_result);
+    ASSERT_TEST(testSameSystems(chess, expected));
+    ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_FROZEN_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveSnapshot(expected, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameFiles(SNAPSHOT_FROZEN_FILE, SNAPSHOT_FILE));
+
+    ASSERT_TEST(chessSetBackgroundReclaim(chess, true) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(expected, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameSystems(chess, expected));
+    ASSERT_TEST(chessSetFreezeEndedTournaments(NULL, true) == CHESS_NULL_ARGUMENT);
+    chessDestroy(chess);
+    chessDestroy(expected);
+    return true;
+}
+
+//Reads up to count games of a tournament, returns the number of games read or -1 if there was an error
+static int testReadGames(ChessSystem chess, int tournament_id, int first, ChessGameRecord games[], int count)
+{
+    ChessResult result;
+    ChessGameIterator iterator = chessGameIteratorCreate(chess, tournament_id, &result);
+    if (result != CHESS_SUCCESS) {
+        return -1;
+    }
+    chessGameIteratorSeek(iterator, first);
+    int read = (int)chessGameIteratorRead(iterator, games, count);
+    chessGameIteratorDestroy(iterator);
+    return read;
+}
+
+//The archive of a frozen tournament decodes to the same games as the tournament had
+bool testChessGameIterator(){
+    static ChessGameRecord games[BATCH_GAMES], expected_games[BATCH_GAMES], read_games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    testRandomGameRecords(games, BATCH_GAMES);
+    ChessSystem chess = chessCreate(), expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    ASSERT_TEST(testAddBatchTournaments(chess) && testAddBatchTournaments(expected));
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    int count = 0;
+    for (int i = 0; i < BATCH_GAMES; i++) {
+        if (results[i] == CHESS_SUCCESS && games[i].tournament_id == ARCHIVE_TOURNAMENT) {
+            expected_games[count++] = games[i];
+        }
+    }
+    ASSERT_TEST(count > SEEK_GAME);
+    ASSERT_TEST(testReadGames(chess, ARCHIVE_TOURNAMENT, 0, read_games, BATCH_GAMES) == count);
+    ASSERT_TEST(memcmp(read_games, expected_games, sizeof(ChessGameRecord) * count) == 0);
+
+    //Removed players are kept in the games as -1
+    ASSERT_TEST(chessRemovePlayer(chess, 3) == CHESS_SUCCESS && chessRemovePlayer(expected, 3) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(chess, ARCHIVE_TOURNAMENT) == CHESS_SUCCESS &&
+                chessEndTournament(expected, ARCHIVE_TOURNAMENT) == CHESS_SUCCESS);
+    ASSERT_TEST(testReadGames(expected, ARCHIVE_TOURNAMENT, 0, expected_games, BATCH_GAMES) == count);
+    ChessMemoryUsage before, after;
+    ASSERT_TEST(chessGetMemoryUsage(chess, ARCHIVE_TOURNAMENT, &before) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSetFreezeEndedTournaments(chess, true) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetMemoryUsage(chess, ARCHIVE_TOURNAMENT, &after) == CHESS_SUCCESS);
+    ASSERT_TEST(after.bytes < before.bytes / 2);
+    ASSERT_TEST(testReadGames(chess, ARCHIVE_TOURNAMENT, 0, read_games, BATCH_GAMES) == count);
+    ASSERT_TEST(memcmp(read_games, expected_games, sizeof(ChessGameRecord) * count) == 0);
+    bool removed = false;
+    for (int i = 0; i < count; i++) {
+        removed = removed || read_games[i].first_player == -1 || read_games[i].second_player == -1;
+    }
+    ASSERT_TEST(removed);
+    ASSERT_TEST(testReadGames(chess, ARCHIVE_TOURNAMENT, SEEK_GAME, read_games, 1) == 1);
+    ASSERT_TEST(memcmp(&read_games[0], &expected_games[SEEK_GAME], sizeof(ChessGameRecord)) == 0);
+    ASSERT_TEST(testReadGames(chess, ARCHIVE_TOURNAMENT, count, read_games, 1) == 0);
+
+    //An iterator keeps its games after the tournament is gone
+    ChessResult result;
+    ChessGameIterator iterator = chessGameIteratorCreate(chess, ARCHIVE_TOURNAMENT, &result);
+    ASSERT_TEST(result == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(chess, ARCHIVE_TOURNAMENT) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGameIteratorNext(iterator, &read_games[0]));
+    ASSERT_TEST(memcmp(&read_games[0], &expected_games[0], sizeof(ChessGameRecord)) == 0);
+    chessGameIteratorDestroy(iterator);
+    ASSERT_TEST(chessGameIteratorCreate(chess, ARCHIVE_TOURNAMENT, &result) == NULL && result == CHESS_TOURNAMENT_NOT_EXIST);
+    ASSERT_TEST(chessGameIteratorCreate(chess, 0, &result) == NULL && result == CHESS_INVALID_ID);
+    ASSERT_TEST(!chessGameIteratorNext(NULL, &read_games[0]));
+    chessDestroy(chess);
+    chessDestroy(expected);
+    return true;
+}
+
+//Spilled tournaments give the same results as ones in memory, and are mapped back when they are needed
+bool testChessMemoryBudget(){
+    static ChessGameRecord games[BATCH_GAMES], expected_games[BATCH_GAMES], read_games[BATCH_GAMES];
+    static ChessResult results[BATCH_GAMES];
+    srand(RANDOM_SEED);
+    testRandomGameRecords(games, BATCH_GAMES);
+    ChessSystem chess = chessCreateThreadSafe(THREAD_SAFE_SHARDS), expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    ASSERT_TEST(testAddBatchTournaments(chess) && testAddBatchTournaments(expected));
+    ASSERT_TEST(chessAddGames(chess, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessAddGames(expected, games, BATCH_GAMES, results) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSetMemoryBudget(chess, SPILL_BUDGET, SPILL_FILE) == CHESS_SUCCESS);
+    for (int id = 2; id < BATCH_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessEndTournament(chess, id) == CHESS_SUCCESS);
+        ASSERT_TEST(chessEndTournament(expected, id) == CHESS_SUCCESS);
+    }
+    ChessSpillStats stats;
+    ASSERT_TEST(chessGetSpillStats(chess, &stats) == CHESS_SUCCESS);
+    ASSERT_TEST(stats.spills == BATCH_TOURNAMENTS - 1 && stats.spilled_bytes > 0);
+    ASSERT_TEST(stats.reloads == 0 && stats.resident_bytes == 0);
+    ChessMemoryUsage spilled, in_memory;
+    ASSERT_TEST(chessGetMemoryUsage(chess, ARCHIVE_TOURNAMENT, &spilled) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetMemoryUsage(expected, ARCHIVE_TOURNAMENT, &in_memory) == CHESS_SUCCESS);
+    ASSERT_TEST(spilled.bytes < in_memory.bytes);
+
+    //Reading the leaders, the games or a snapshot maps the tournaments back, and spills them again
+    ASSERT_TEST(testSameSystems(chess, expected));
+    int count = testReadGames(expected, ARCHIVE_TOURNAMENT, 0, expected_games, BATCH_GAMES);
+    ASSERT_TEST(testReadGames(chess, ARCHIVE_TOURNAMENT, 0, read_games, BATCH_GAMES) == count);
+    ASSERT_TEST(memcmp(read_games, expected_games, sizeof(ChessGameRecord) * count) == 0);
+    ASSERT_TEST(chessSaveSnapshot(chess, SNAPSHOT_FROZEN_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(chessSaveSnapshot(expected, SNAPSHOT_FILE) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameFiles(SNAPSHOT_FROZEN_FILE, SNAPSHOT_FILE));
+    ChessSpillStats reloaded;
+    ASSERT_TEST(chessGetSpillStats(chess, &reloaded) == CHESS_SUCCESS);
+    ASSERT_TEST(reloaded.reloads > stats.reloads && reloaded.reloaded_bytes > 0);
+    ASSERT_TEST(reloaded.spills == stats.spills + reloaded.reloads);
+    ASSERT_TEST(reloaded.spilled_bytes == stats.spilled_bytes && reloaded.resident_bytes == 0);
+
+    ASSERT_TEST(chessRemoveTournament(chess, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemoveTournament(expected, 2) == CHESS_SUCCESS);
+    ASSERT_TEST(chessRemovePlayer(chess, 3) == chessRemovePlayer(expected, 3));
+    ASSERT_TEST(testSameSystems(chess, expected));
+
+    //Without a budget every tournament is back in memory, and the spill file is gone
+    ASSERT_TEST(chessSetMemoryBudget(chess, 0, NULL) == CHESS_SUCCESS);
+    ASSERT_TEST(fopen(SPILL_FILE, "r") == NULL);
+    ASSERT_TEST(chessGetMemoryUsage(chess, ARCHIVE_TOURNAMENT, &in_memory) == CHESS_SUCCESS);
+    ASSERT_TEST(in_memory.bytes > spilled.bytes);
+    ASSERT_TEST(testSameSystems(chess, expected));
+    ASSERT_TEST(chessGetSpillStats(chess, &stats) == CHESS_SUCCESS);
+    ASSERT_TEST(stats.reloads > reloaded.reloads && stats.resident_bytes == 0);
+    ASSERT_TEST(chessSetMemoryBudget(chess, SPILL_BUDGET, NULL) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessSetMemoryBudget(NULL, 0, NULL) == CHESS_NULL_ARGUMENT);
+    ASSERT_TEST(chessGetSpillStats(chess, NULL) == CHESS_NULL_ARGUMENT);
+    chessDestroy(chess);
+    chessDestroy(expected);
+    return true;
+}
+
+static size_t testSpillReloads(ChessSystem chess)
+{
+    ChessSpillStats stats;
+    chessGetSpillStats(chess, &stats);
+    return stats.reloads;
+}
+
+//Every frozen tournament in memory holds at least a whole chunk of its arena, and the budget counts all of it.
+//The tournaments that are spilled to stay within it are the least recently used ones.
+bool testChessSpillSmallTournaments(){
+    ChessSystem chess = chessCreate();
+    ASSERT_TEST(chess != NULL);
+    ASSERT_TEST(chessSetMemoryBudget(chess, SMALL_SPILL_BUDGET, SPILL_FILE) == CHESS_SUCCESS);
+    for (int id = 1; id <= SMALL_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessAddTournament(chess, id, 1, "London") == CHESS_SUCCESS);
+        ASSERT_TEST(chessAddGame(chess, id, 1, 2, FIRST_PLAYER, 10) == CHESS_SUCCESS);
+        ASSERT_TEST(chessEndTournament(chess, id) == CHESS_SUCCESS);
+    }
+    ChessSpillStats stats;
+    ASSERT_TEST(chessGetSpillStats(chess, &stats) == CHESS_SUCCESS);
+    ASSERT_TEST(stats.resident_bytes > 0 && stats.resident_bytes <= SMALL_SPILL_BUDGET);
+    ASSERT_TEST(stats.spills == SMALL_TOURNAMENTS - SMALL_RESIDENT);
+
+    //The last three to end are in memory, the least recently used first: 8, 9 and 10. Using a tournament in
+    //memory does not map anything back, using a spilled one maps it back and spills the least recently used.
+    int leaders[1];
+    ChessGameRecord game;
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 8, 1, leaders) == CHESS_SUCCESS); //9, 10, 8
+    ASSERT_TEST(testSpillReloads(chess) == 0);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 5, 1, leaders) == CHESS_SUCCESS); //10, 8, 5, 9 is spilled
+    ASSERT_TEST(testSpillReloads(chess) == 1);
+    ASSERT_TEST(testReadGames(chess, 10, 0, &game, 1) == 1); //8, 5, 10
+    ASSERT_TEST(testSpillReloads(chess) == 1);
+    ASSERT_TEST(testReadGames(chess, 9, 0, &game, 1) == 1); //5, 10, 9, 8 is spilled
+    ASSERT_TEST(testSpillReloads(chess) == 2);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 5, 1, leaders) == CHESS_SUCCESS); //10, 9, 5
+    ASSERT_TEST(testSpillReloads(chess) == 2);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 8, 1, leaders) == CHESS_SUCCESS); //9, 5, 8, 10 is spilled
+    ASSERT_TEST(testSpillReloads(chess) == 3);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 9, 1, leaders) == CHESS_SUCCESS);
+    ASSERT_TEST(chessGetTournamentLeaders(chess, 10, 1, leaders) == CHESS_SUCCESS);
+    ASSERT_TEST(testSpillReloads(chess) == 4);
+    ASSERT_TEST(chessGetSpillStats(chess, &stats) == CHESS_SUCCESS);
+    ASSERT_TEST(stats.resident_bytes <= SMALL_SPILL_BUDGET);
+
+    //Removing a spilled tournament reads its stats from the spill file, without mapping it back
+    ASSERT_TEST(chessRemoveTournament(chess, 1) == CHESS_SUCCESS);
+    ChessSpillStats removed;
+    ASSERT_TEST(chessGetSpillStats(chess, &removed) == CHESS_SUCCESS);
+    ASSERT_TEST(removed.reloads == stats.reloads && removed.spills == stats.spills);
+    ChessResult result;
+    ASSERT_TEST(chessCalculateAveragePlayTime(chess, 1, &result) == 10 && result == CHESS_SUCCESS);
+    chessDestroy(chess);
+    return true;
+}
+
+//A game that runs out of memory is not added at all, so removing its tournament and players later is safe
+bool testChessAddGameOutOfMemory(){
+    ChessCountingAllocator counting;
+    chessCountingAllocatorInit(&counting, 0);
+    ChessSystem chess = chessCreateWithAllocator(&counting.allocator), expected = chessCreate();
+    ASSERT_TEST(chess != NULL && expected != NULL);
+    for (int id = 1; id <= FAILING_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessAddTournament(chess, id, 2, "London") == CHESS_SUCCESS);
+        ASSERT_TEST(chessAddTournament(expected, id, 2, "London") == CHESS_SUCCESS);
+    }
+    int failures = 0;
+    for (int player = 1; player < FAILING_PLAYERS; player++) {
+        for (int id = 1; id <= FAILING_TOURNAMENTS; id++) {
+            Winner winner = (Winner)((player + id) % 3);
+            ChessResult result = CHESS_OUT_OF_MEMORY;
+            for (size_t headroom = 0; result == CHESS_OUT_OF_MEMORY; headroom += FAILING_STEP) {
+                counting.limit = counting.bytes + headroom;
+                result = chessAddGame(chess, id, player, player + 1, winner, player);
+                failures += result == CHESS_OUT_OF_MEMORY;
+            }
+            counting.limit = 0;
+            ASSERT_TEST(result == CHESS_SUCCESS);
+            ASSERT_TEST(chessAddGame(expected, id, player, player + 1, winner, player) == CHESS_SUCCESS);
+        }
+    }
+    ASSERT_TEST(failures > 0);
+    ASSERT_TEST(chessEndTournament(chess, FAILING_TOURNAMENTS) == CHESS_SUCCESS);
+    ASSERT_TEST(chessEndTournament(expected, FAILING_TOURNAMENTS) == CHESS_SUCCESS);
+    ASSERT_TEST(testSameSystems(chess, expected));
+    for (int id = 1; id < FAILING_TOURNAMENTS; id++) {
+        ASSERT_TEST(chessRemoveTournament(chess, id) == CHESS_SUCCESS);
+        ASSERT_TEST(chessRemoveTournament(expected, id) == CHESS_SUCCESS);
+    }
+    for (int player = 1; player <= FAILING_PLAYERS; player++) {
+        ASSERT_TEST(chessRemovePlayer(chess, player) == chessRemovePlayer(expected, player));
+    }
+    ASSERT_TEST(testSameSystems(chess, expected));
+    chessDestroy(chess);
+    chessDestroy(expected);
+    ASSERT_TEST(counting.bytes == 0 && counting.blocks == 0);
+    return true;
+}
 
 /*The functions for the tests should be added here*/
 bool (*tests[]) (void) = {
         testChessAddTournament,
         testChessRemoveTournament,
         testChessAddGame,
-        testChessPrintLevelsAndTournamentStatistics
+        testChessPrintLevelsAndTournamentStatistics,
+        testChessEndTournamentRandomWinners,
+        testChessGetTournamentLeaders,
+        testChessAddTournamentSharedLocations,
+        testChessPlayerAcrossTournaments,
+        testChessSavePlayersLevelsTopK,
+        testChessSavePlayersLevelsRounding,
+        testChessAddGamesBatch,
+        testChessImportGames,
+        testChessSaveAndLoadSnapshot,
+        testChessReplayJournal,
+        testChessCheckpointAndReplay,
+        testChessThreadSafeAddGames,
+        testChessSavePlayersLevelsParallel,
+        testChessSaveTournamentStatisticsParallel,
+        testChessIngestQueue,
+        testChessReadSnapshot,
+        testChessBackgroundReclaim,
+        testChessTournamentBytesInUse,
+        testChessAddGameNoAllocations,
+        testChessCreateWithAllocator,
+        testChessFreezeEndedTournaments,
+        testChessGameIterator,
+        testChessMemoryBudget,
+        testChessSpillSmallTournaments,
+        testChessAddGameOutOfMemory
 };
 
 /*The names of the test functions should be added here*/
@@ -76,7 +1592,32 @@ const char* testNames[] = {
         "testChessAddTournament",
         "testChessRemoveTournament",
         "testChessAddGame",
-        "testChessPrintLevelsAndTournamentStatistics"
+        "testChessPrintLevelsAndTournamentStatistics",
+        "testChessEndTournamentRandomWinners",
+        "testChessGetTournamentLeaders",
+        "testChessAddTournamentSharedLocations",
+        "testChessPlayerAcrossTournaments",
+        "testChessSavePlayersLevelsTopK",
+        "testChessSavePlayersLevelsRounding",
+        "testChessAddGamesBatch",
+        "testChessImportGames",
+        "testChessSaveAndLoadSnapshot",
+        "testChessReplayJournal",
+        "testChessCheckpointAndReplay",
+        "testChessThreadSafeAddGames",
+        "testChessSavePlayersLevelsParallel",
+        "testChessSaveTournamentStatisticsParallel",
+        "testChessIngestQueue",
+        "testChessReadSnapshot",
+        "testChessBackgroundReclaim",
+        "testChessTournamentBytesInUse",
+        "testChessAddGameNoAllocations",
+        "testChessCreateWithAllocator",
+        "testChessFreezeEndedTournaments",
+        "testChessGameIterator",
+        "testChessMemoryBudget",
+        "testChessSpillSmallTournaments",
+        "testChessAddGameOutOfMemory"
 };
 
 int main(int argc, char *argv[]) {
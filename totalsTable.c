@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "totalsTable.h"
+#include "idTable.h"
+#include "arena.h"
+
+#define INIT_SIZE 16
+#define EXPAND_FACTOR 2
+
+//The index maps the slot of a player to its row. The rows and the index are allocated from the table's arena.
+typedef struct TotalsTable_t {
+    const ChessAllocator *allocator;
+    Arena arena;
+    IdTable index;
+    TotalsRow *rows;
+    int size;
+    int max_size;
+} TotalsTable_t;
+
+
+TotalsTable totalsTableCreate(const ChessAllocator* allocator)
+{
+    TotalsTable table = allocatorAllocate(allocator, sizeof(*table));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->allocator = allocator;
+    table->arena = arenaCreate(allocator);
+    if (table->arena == NULL) {
+        allocatorFree(allocator, table, sizeof(*table));
+        return NULL;
+    }
+    table->index = idTableCreate(table->arena);
+    table->rows = arenaAllocate(table->arena, sizeof(TotalsRow) * INIT_SIZE);
+    if (table->index == NULL || table->rows == NULL) {
+        arenaDestroy(table->arena);
+        allocatorFree(allocator, table, sizeof(*table));
+        return NULL;
+    }
+    table->size = 0;
+    table->max_size = INIT_SIZE;
+    return table;
+}
+
+void totalsTableDestroy(TotalsTable table)
+{
+    if (table != NULL) {
+        arenaDestroy(table->arena); //The rows and the index
+        allocatorFree(table->allocator, table, sizeof(*table));
+    }
+}
+
+bool totalsTableAdd(TotalsTable table, int player_slot)
+{
+    assert(table != NULL);
+    if (idTableFind(table->index, player_slot) != ID_TABLE_NOT_FOUND) {
+        return true;
+    }
+    if (table->size == table->max_size) {
+        int new_size = EXPAND_FACTOR * table->max_size;
+        TotalsRow *rows = arenaReallocate(table->arena, table->rows, sizeof(TotalsRow) * table->max_size,
+                                          sizeof(TotalsRow) * new_size);
+        if (rows == NULL) {
+            return false;
+        }
+        table->rows = rows;
+        table->max_size = new_size;
+    }
+    int row = idTableAdd(table->index, player_slot);
+    if (row == ID_TABLE_NOT_FOUND) {
+        return false;
+    }
+    assert(row == table->size);
+    TotalsRow totals = {player_slot, 0, 0, 0, 0};
+    table->rows[table->size++] = totals;
+    return true;
+}
+
+void totalsTableUpdate(TotalsTable table, int player_slot, int wins, int losses, int draws, int time_played)
+{
+    assert(table != NULL);
+    int row = idTableFind(table->index, player_slot);
+    assert(row != ID_TABLE_NOT_FOUND);
+    TotalsRow *totals = &table->rows[row];
+    totals->wins += wins;
+    totals->losses += losses;
+    totals->draws += draws;
+    totals->time_played += time_played;
+}
+
+int totalsTableGetSize(TotalsTable table)
+{
+    assert(table != NULL);
+    return table->size;
+}
+
+const TotalsRow* totalsTableGetRows(TotalsTable table)
+{
+    assert(table != NULL);
+    return table->rows;
+}
@@ -0,0 +1,43 @@
+#ifndef _TOTALS_TABLE_H
+#define _TOTALS_TABLE_H
+
+/**
+* Totals of the players over the tournaments of one shard.
+*
+* Every player that has stats in one of the tournaments gets a row, which keeps the sum of the player's stats
+* over them. The rows of all the shards add up to the totals in the player directory, so the totals can be
+* copied one shard at a time, each under the lock of its own shard. A row stays once it is added, also when
+* its totals are back to zero, so only adding a row allocates. The table is not thread safe.
+*
+* The following functions are available:
+*   totalsTableCreate	- Creates a new empty table, using the given allocator
+*   totalsTableDestroy	- Deletes an existing table and frees all resources
+*   totalsTableAdd		- Gives a player a row, if it does not have one yet
+*   totalsTableUpdate	- Adds to the totals of a player that has a row
+*   totalsTableGetSize	- Returns the number of rows
+*   totalsTableGetRows	- Returns the rows, in the order they were added
+*/
+
+#include <stdbool.h>
+#include "allocator.h"
+
+/** Type for defining the totals table */
+typedef struct TotalsTable_t *TotalsTable;
+
+/** The totals of a player over the tournaments of a shard */
+typedef struct TotalsRow {
+    int player_slot;
+    int wins;
+    int losses;
+    int draws;
+    int time_played;
+} TotalsRow;
+
+TotalsTable totalsTableCreate(const ChessAllocator* allocator);
+void totalsTableDestroy(TotalsTable table);
+bool totalsTableAdd(TotalsTable table, int player_slot);
+void totalsTableUpdate(TotalsTable table, int player_slot, int wins, int losses, int draws, int time_played);
+int totalsTableGetSize(TotalsTable table);
+const TotalsRow* totalsTableGetRows(TotalsTable table);
+
+#endif //_TOTALS_TABLE_H
@@ -10,92 +10,132 @@
 #define SMALL_A 'a'
 #define SMALL_Z 'z'
 #define SPACE ' '
-#define PARAMETERS 5
-#define UNDEFINED -1
+#define INIT_PLAYERS 4
+#define INIT_GAMES 4
+#define EXPAND_FACTOR 2
+#define GAME_SNAPSHOT_SIZE (4 * SNAPSHOT_INT_SIZE)
+#define STATS_SNAPSHOT_SIZE (5 * SNAPSHOT_INT_SIZE)
+#define PAIR_INDEX_PLAYERS 65536 //The pairs of stats indexes below it are packed into an int
+#define PAIR_NOT_PACKED -1
 
 
 
-int *statsArrCopy(int );
-static MapKeyElement copyStatistics(MapKeyElement statistics);
-static void destroyStatistics(MapKeyElement statistics);
-static int computeMaxScore(Map players_stats, int *winner);
-static int computeMinLosses(Map players_stats, int *winner, int maxScore);
-static int computeMaxWins(Map players_stats, int *winner, int maxScore, int minLosses);
-static void computeMinId(Map players_stats, int *winner,int maxScore,int minLosses,int maxWins);
-static Tournament* tournamentCopyData(Map games, Map players_stats,const char *location, int winner,
-                                    int max_games_per_player,int next_game_id);
-static void resetStats(Map player_stats,int player_id);
-static MapResult addPlayerStats(Map players_stats, int player_id);
+static LeaderboardKey statsToKey(const PlayerStats* statistics);
+static Tournament* tournamentCopyData(const Tournament* source);
+static void resetStats(Tournament* tournament,int player);
+static MapResult addPlayerStats(Tournament* tournament, int player, int* index);
+static bool reservePlayers(Tournament* tournament, int count);
+static void addToTotals(Tournament* tournament, int player, int wins, int losses, int draws, int time_played);
+static MapResult updateWinnerStats(Tournament* tournament, const Game* game);
+static bool loadGames(Tournament* tournament, SnapshotReader* reader);
+static bool loadPlayersStats(Tournament* tournament, SnapshotReader* reader);
+static int compareStatsIndexes(const void* first, const void* second);
+static int packPair(const Tournament* tournament, int player1, int player2);
+static void addPair(Tournament* tournament, int game_index);
+static bool addAllPairs(Tournament* tournament);
 
 
-Tournament* tournamentCreate(copyMapKeyElements copyMapKeyElements,freeMapKeyElements freeMapKeyElements, 
-                             compareMapKeyElements compareMapKeyElements, const char *location,int max_games_per_player)
+Tournament* tournamentCreate(Location location,int max_games_per_player, PlayerDirectory players,
+                             TotalsTable totals, const ChessAllocator* allocator)
 {
     assert(location != NULL);
-    Tournament* tournament = malloc(sizeof(*tournament));
+    Tournament* tournament = allocatorAllocate(allocator, sizeof(*tournament));
     if (tournament == NULL) {
         return NULL;
     }
-    tournament->games = mapCreate(gameCopy,copyMapKeyElements,
-                                gameDestroy, freeMapKeyElements,
-                                compareMapKeyElements);
-    if (tournament->games == NULL) {
-        free(tournament);
+    tournament->allocator = allocator;
+    tournament->arena = arenaCreate(allocator);
+    if (tournament->arena == NULL) {
+        allocatorFree(allocator, tournament, sizeof(*tournament));
         return NULL;
     }
-    tournament->players_stats = mapCreate(copyStatistics,copyMapKeyElements,
-                                destroyStatistics, freeMapKeyElements,
-                                compareMapKeyElements);
-     if (tournament->players_stats == NULL) {
-        mapDestroy(tournament->games);
-        free(tournament);
+    tournament->games = arenaAllocate(tournament->arena, sizeof(Game) * INIT_GAMES);
+    tournament->players_stats = arenaAllocate(tournament->arena, sizeof(PlayerStats) * INIT_PLAYERS);
+    tournament->players_index = idTableCreate(tournament->arena);
+    tournament->pairs_index = idTableCreate(tournament->arena);
+    tournament->pairs_games = arenaAllocate(tournament->arena, sizeof(int) * INIT_GAMES);
+    tournament->leaderboard = leaderboardCreate(tournament->arena);
+    if (tournament->games == NULL || tournament->players_stats == NULL || tournament->players_index == NULL ||
+        tournament->pairs_index == NULL || tournament->pairs_games == NULL || tournament->leaderboard == NULL) {
+        arenaDestroy(tournament->arena);
+        allocatorFree(allocator, tournament, sizeof(*tournament));
         return NULL;
     }
-    tournament->location = malloc(sizeof(char) * strlen(location) + 1);
-    if (tournament->location == NULL) {
-        mapDestroy(tournament->games);
-        mapDestroy(tournament->players_stats);
-        free(tournament);
-        return NULL;
-    }
-    strcpy(tournament->location, location);
+    tournament->location = locationAcquire(location);
     tournament->winner = TOURNAMENT_NOT_ENDED;
     tournament->max_games_per_player=max_games_per_player;
-    tournament->next_game_id = 0;
+    tournament->games_count = 0;
+    tournament->games_max_size = INIT_GAMES;
+    tournament->pairs_max_size = INIT_GAMES;
+    tournament->longest_game = 0;
+    tournament->total_game_time = 0;
+    tournament->players_count = 0;
+    tournament->players_max_size = INIT_PLAYERS;
+    tournament->leaders = NULL;
+    tournament->stats_by_slot = NULL;
+    tournament->archive = NULL;
+    tournament->archive_size = 0;
+    tournament->frozen = false;
+    tournament->spilled = false;
+    tournament->spill_offset = -1;
+    tournament->lru_previous = NULL;
+    tournament->lru_next = NULL;
+    tournament->lru_bytes = 0;
+    tournament->players = players;
+    tournament->totals = totals;
     return tournament;
 }
-static Tournament* tournamentCopyData(Map games, Map players_stats, const char *location, int winner,
-                                    int max_games_per_player,int next_game_id)
+static Tournament* tournamentCopyData(const Tournament* source)
 {   
-    assert(games != NULL);
-    assert(location != NULL);
+    assert(source != NULL && !source->spilled);
 
-    Tournament* tournament = malloc(sizeof(*tournament));
+    Tournament* tournament = allocatorAllocate(source->allocator, sizeof(*tournament));
     if (tournament == NULL) {
         return NULL;
     }
-    tournament->games = mapCopy(games);
-    if (tournament->games == NULL) {
-        free(tournament);
+    *tournament = *source;
+    tournament->arena = arenaCreate(source->allocator);
+    if (tournament->arena == NULL) {
+        allocatorFree(source->allocator, tournament, sizeof(*tournament));
         return NULL;
     }
-    tournament->players_stats = mapCopy(players_stats);
-    if (tournament->players_stats == NULL) {
-        mapDestroy(tournament->games);
-        free(tournament);
-        return NULL;
+    tournament->players_stats = arenaAllocate(tournament->arena, sizeof(PlayerStats) * source->players_max_size);
+    bool copied = tournament->players_stats != NULL;
+    if (source->frozen) {
+        tournament->archive = arenaAllocate(tournament->arena, source->archive_size);
+        tournament->leaders = arenaAllocate(tournament->arena, sizeof(int) * source->players_count);
+        tournament->stats_by_slot = arenaAllocate(tournament->arena, sizeof(StatsIndex) * source->players_count);
+        copied = copied && tournament->archive != NULL && tournament->leaders != NULL &&
+                 tournament->stats_by_slot != NULL;
+    }
+    else {
+        tournament->games = arenaAllocate(tournament->arena, sizeof(Game) * source->games_max_size);
+        tournament->players_index = idTableCopy(source->players_index, tournament->arena);
+        tournament->pairs_index = idTableCopy(source->pairs_index, tournament->arena);
+        tournament->pairs_games = arenaAllocate(tournament->arena, sizeof(int) * source->pairs_max_size);
+        tournament->leaderboard = leaderboardCopy(source->leaderboard, tournament->arena);
+        copied = copied && tournament->games != NULL && tournament->players_index != NULL &&
+                 tournament->pairs_index != NULL && tournament->pairs_games != NULL && tournament->leaderboard != NULL;
     }
-    tournament->location = malloc(sizeof(char) * strlen(location) + 1);
-    if (tournament->location == NULL) {
-        mapDestroy(tournament->games);
-        mapDestroy(tournament->players_stats);
-        free(tournament);
+    if (!copied) {
+        arenaDestroy(tournament->arena);
+        allocatorFree(source->allocator, tournament, sizeof(*tournament));
         return NULL;
     }
-    strcpy(tournament->location, location);
-    tournament->winner = winner;
-    tournament->next_game_id = next_game_id;
-    tournament->max_games_per_player = max_games_per_player;
+    memcpy(tournament->players_stats, source->players_stats, sizeof(PlayerStats) * source->players_count);
+    if (source->frozen) {
+        memcpy(tournament->archive, source->archive, source->archive_size);
+        memcpy(tournament->leaders, source->leaders, sizeof(int) * source->players_count);
+        memcpy(tournament->stats_by_slot, source->stats_by_slot, sizeof(StatsIndex) * source->players_count);
+    }
+    else {
+        memcpy(tournament->games, source->games, sizeof(Game) * source->games_count);
+        memcpy(tournament->pairs_games, source->pairs_games, sizeof(int) * idTableGetSize(source->pairs_index));
+    }
+    tournament->lru_previous = NULL;
+    tournament->lru_next = NULL;
+    tournament->lru_bytes = 0;
+    tournament->location = locationAcquire(source->location);
     return tournament;
 }
 
@@ -104,60 +144,95 @@ MapDataElement tournamentCopy(MapDataElement tournament)
     if (tournament == NULL) {
         return NULL;
     }
-    Tournament *tour = (Tournament*)tournament;
-    Tournament* tournament_copy = tournamentCopyData(tour->games,
-                                                    tour->players_stats,
-                                                    tour->location,
-                                                    tour->winner,
-                                                    tour->max_games_per_player,
-                                                    tour->next_game_id);
-   
-    return (void*)tournament_copy;
+    return (MapDataElement)tournamentCopyData((Tournament*)tournament);
 }
 
+/*
+ * A pair keeps its last game, which is checked to still be between the two players, since a player that is
+ * removed from the tournament leaves its games and may be added back with the same slot. Only a tournament with
+ * more players than can be packed goes over its games.
+ */
 bool checkAlreadyPlayed(const Tournament* tournament, int player1, int player2)
 {
-    assert(tournament != NULL);
-    MAP_FOREACH(int *, iter, tournament->games) {
-        Game* game = (Game*)mapGet(tournament->games, iter);
-        if (game->players_id[0] == player1 && game->players_id[1] == player2) {
-            free(iter);
+    assert(tournament != NULL && !tournament->frozen);
+    int key = packPair(tournament, player1, player2);
+    if (key != PAIR_NOT_PACKED) {
+        int pair = idTableFind(tournament->pairs_index, key);
+        if (pair == ID_TABLE_NOT_FOUND) {
+            return false;
+        }
+        const Game *game = &tournament->games[tournament->pairs_games[pair]];
+        return (game->players_slot[0] == player1 && game->players_slot[1] == player2) ||
+               (game->players_slot[0] == player2 && game->players_slot[1] == player1);
+    }
+    for (int i = 0; i < tournament->games_count; i++) {
+        const Game* game = &tournament->games[i];
+        if (game->players_slot[0] == player1 && game->players_slot[1] == player2) {
             return true;
         }
-        if (game->players_id[0] == player2 && game->players_id[1] == player1) {
-            free(iter);
+        if (game->players_slot[0] == player2 && game->players_slot[1] == player1) {
             return true;
         }
-        free(iter);
     }
     return false;
 }
 
+//Every game of a player counts once in its wins, losses or draws, and a removed player has none left.
 bool checkExceededGames(const Tournament* tournament, int player)
 {
     assert(tournament != NULL);
-    int count_games = 0;
-    MAP_FOREACH(int *, iter, tournament->games) {
-         Game* game = (Game*)mapGet(tournament->games, iter);
-         if (game->players_id[0] == player || game->players_id[1] == player) {
-             count_games++;
-         }
-         free(iter);
+    PlayerStats *statistics = tournamentGetPlayerStats(tournament, player);
+    if (statistics == NULL) {
+        return false;
     }
-    return count_games >= tournament->max_games_per_player;
+    return statistics->wins + statistics->losses + statistics->draws >= tournament->max_games_per_player;
 }
 
 void tournamentDestroy(MapDataElement tournament)
 {
     if (tournament != NULL) {
         Tournament *tournament_to_destroy= (Tournament*)tournament;
-        free(tournament_to_destroy->location);
-        mapDestroy(tournament_to_destroy->games);
-        mapDestroy(tournament_to_destroy->players_stats);
-        free(tournament_to_destroy);
+        locationRelease(tournament_to_destroy->location);
+        arenaDestroy(tournament_to_destroy->arena); //The games, the stats and their indexes
+        allocatorFree(tournament_to_destroy->allocator, tournament_to_destroy, sizeof(*tournament_to_destroy));
     }    
 }
 
+/*
+ * Takes the arena with the games, stats and indexes of a tournament out of it. The arena can be destroyed
+ * without touching the location table, and destroying the emptied tournament only releases its location.
+ */
+Arena tournamentDetach(Tournament* tournament)
+{
+    assert(tournament != NULL);
+    Arena arena = tournament->arena;
+    tournament->arena = NULL;
+    tournament->games = NULL;
+    tournament->games_count = 0;
+    tournament->games_max_size = 0;
+    tournament->players_stats = NULL;
+    tournament->players_count = 0;
+    tournament->players_max_size = 0;
+    tournament->players_index = NULL;
+    tournament->pairs_index = NULL;
+    tournament->pairs_games = NULL;
+    tournament->pairs_max_size = 0;
+    tournament->leaderboard = NULL;
+    tournament->leaders = NULL;
+    tournament->stats_by_slot = NULL;
+    tournament->archive = NULL;
+    tournament->archive_size = 0;
+    return arena;
+}
+
+//The tournament itself is not in its arena, so it can be emptied by tournamentDetach
+void tournamentGetMemoryUsage(const Tournament* tournament, size_t* bytes, size_t* objects)
+{
+    assert(tournament != NULL && bytes != NULL && objects != NULL);
+    *bytes = sizeof(*tournament) + arenaGetFootprint(tournament->arena);
+    *objects = 1 + arenaGetAllocations(tournament->arena);
+}
+
 bool checkLocation(const char* tournament_location)
 {
     if (tournament_location == NULL || strlen(tournament_location) == 0) {
@@ -178,214 +253,574 @@ bool checkLocation(const char* tournament_location)
     }
     return true;
 }
-bool tournamentRemovePlayer(Tournament* tournament,int player_id)
+bool tournamentRemovePlayer(Tournament* tournament,int player)
 {
-    assert(tournament != NULL);
+    assert(tournament != NULL && !tournament->frozen);
     bool exists_in_tournament = false;
-    MAP_FOREACH(int *, iter, tournament->games) {
-        Game* game = (Game*)mapGet(tournament->games, iter);
+    for (int i = 0; i < tournament->games_count; i++) {
+        Game* game = &tournament->games[i];
         Winner curr_winner = game->result;
-        if (game->players_id[0] == player_id){
+        if (game->players_slot[0] == player){
             game->result= SECOND_PLAYER;
-            game->players_id[0]= TOURNAMENT_DELETED_PLAYER;
+            game->players_slot[0]= TOURNAMENT_DELETED_PLAYER;
             exists_in_tournament = true;
-            if (game->players_id[1] != TOURNAMENT_DELETED_PLAYER) {
+            if (game->players_slot[1] != TOURNAMENT_DELETED_PLAYER) {
                 if (curr_winner == DRAW) {
-                    updateStats(tournament->players_stats, game->players_id[1], 1, 0, -1, 0);
+                    updateStats(tournament, game->players_slot[1], 1, 0, -1, 0);
                 }
                 else if (curr_winner == FIRST_PLAYER) {
-                    updateStats(tournament->players_stats, game->players_id[1], 1, -1, 0, 0);
+                    updateStats(tournament, game->players_slot[1], 1, -1, 0, 0);
                 }
             }
         }      
-        if (game->players_id[1] == player_id){
+        if (game->players_slot[1] == player){
             game->result= FIRST_PLAYER;
-            game->players_id[1]= TOURNAMENT_DELETED_PLAYER;
+            game->players_slot[1]= TOURNAMENT_DELETED_PLAYER;
             exists_in_tournament = true;
-            if (game->players_id[0] != TOURNAMENT_DELETED_PLAYER) {
+            if (game->players_slot[0] != TOURNAMENT_DELETED_PLAYER) {
                 if (curr_winner == DRAW) {
-                    updateStats(tournament->players_stats, game->players_id[0], 1, 0, -1, 0);
+                    updateStats(tournament, game->players_slot[0], 1, 0, -1, 0);
                 }
                 else if (curr_winner == SECOND_PLAYER) {
-                    updateStats(tournament->players_stats, game->players_id[0], 1, -1, 0, 0);
+                    updateStats(tournament, game->players_slot[0], 1, -1, 0, 0);
                 }
             }
         }
-        free(iter);
     }
     if (exists_in_tournament) {
-        resetStats(tournament->players_stats, player_id);
+        resetStats(tournament, player);
     }
     return exists_in_tournament;
 }
 
-static void resetStats(Map player_stats,int player_id)
+static void resetStats(Tournament* tournament,int player)
 {
-    assert(player_stats != NULL);
-    int *statistics = mapGet(player_stats, &player_id);
-    statistics[WINS] = 0;
-    statistics[LOSSES] = 0;
-    statistics[DRAWS] = 0;
-    statistics[TIME_PLAYED] = 0;
-    statistics[SCORE] = 0;
+    assert(tournament != NULL);
+    PlayerStats *statistics = tournamentGetPlayerStats(tournament, player);
+    assert(statistics != NULL);
+    LeaderboardKey old_key = statsToKey(statistics);
+    addToTotals(tournament, player, -statistics->wins, -statistics->losses, -statistics->draws,
+                -statistics->time_played);
+    statistics->wins = 0;
+    statistics->losses = 0;
+    statistics->draws = 0;
+    statistics->time_played = 0;
+    statistics->score = 0;
+    LeaderboardKey new_key = statsToKey(statistics);
+    leaderboardUpdate(tournament->leaderboard, &old_key, &new_key);
 }
 
-static MapKeyElement copyStatistics(MapKeyElement statistics)
+MapResult updateStats(Tournament* tournament, int player, int wins, int losses, int draws, int time_played)
 {
-    int *copy = malloc(sizeof(int) * PARAMETERS);
-    if (copy == NULL) {
-        return NULL;
+    assert(tournament != NULL);
+    int index = idTableFind(tournament->players_index, player);
+    if (index == ID_TABLE_NOT_FOUND) {
+        MapResult result = addPlayerStats(tournament, player, &index);
+        if (result != MAP_SUCCESS) {
+            return result;
+        }
     }
-    for (int i = 0; i < PARAMETERS; i++) {
-        copy[i] = ((int *)statistics)[i];
+    PlayerStats *statistics = &tournament->players_stats[index];
+    LeaderboardKey old_key = statsToKey(statistics);
+    statistics->wins += wins;
+    statistics->losses += losses;
+    statistics->draws += draws;
+    statistics->time_played += time_played;
+    statistics->score += 2 * wins +  draws;
+    addToTotals(tournament, player, wins, losses, draws, time_played);
+    LeaderboardKey new_key = statsToKey(statistics);
+    leaderboardUpdate(tournament->leaderboard, &old_key, &new_key);
+    return MAP_SUCCESS;
+}
+
+//A game adds at most one pair, so the pairs get as much room as the games
+bool tournamentReserveGames(Tournament* tournament, int count)
+{
+    assert(tournament != NULL && count >= 0);
+    int size = tournament->games_count + count;
+    if (size > tournament->games_max_size) {
+        int new_size = tournament->games_max_size;
+        while (new_size < size) {
+            new_size *= EXPAND_FACTOR;
+        }
+        Game *games = arenaReallocate(tournament->arena, tournament->games,
+                                      sizeof(Game) * tournament->games_max_size, sizeof(Game) * new_size);
+        if (games == NULL) {
+            return false;
+        }
+        tournament->games = games;
+        tournament->games_max_size = new_size;
+    }
+    if (size > tournament->pairs_max_size) {
+        int *pairs_games = arenaReallocate(tournament->arena, tournament->pairs_games,
+                                           sizeof(int) * tournament->pairs_max_size,
+                                           sizeof(int) * tournament->games_max_size);
+        if (pairs_games == NULL) {
+            return false;
+        }
+        tournament->pairs_games = pairs_games;
+        tournament->pairs_max_size = tournament->games_max_size;
+    }
+    return idTableReserve(tournament->pairs_index, size);
+}
+
+MapResult tournamentAddGame(Tournament* tournament, int first_player, int second_player, Winner winner,
+                            int play_time)
+{
+    assert(tournament != NULL);
+    //Everything the game needs is reserved first, so a failure leaves the tournament as it was
+    int new_players = (idTableFind(tournament->players_index, first_player) == ID_TABLE_NOT_FOUND) +
+                      (idTableFind(tournament->players_index, second_player) == ID_TABLE_NOT_FOUND);
+    if (!tournamentReserveGames(tournament, 1) || !reservePlayers(tournament, new_players) ||
+        !totalsTableAdd(tournament->totals, first_player) || !totalsTableAdd(tournament->totals, second_player)) {
+        return MAP_OUT_OF_MEMORY;
     }
-    return (MapKeyElement)copy;
+    Game *game = &tournament->games[tournament->games_count++];
+    game->players_slot[0] = first_player;
+    game->players_slot[1] = second_player;
+    game->result = winner;
+    game->duration = play_time;
+    tournament->longest_game = play_time > tournament->longest_game ? play_time : tournament->longest_game;
+    tournament->total_game_time += play_time;
+    MapResult result = updateWinnerStats(tournament, game);
+    addPair(tournament, tournament->games_count - 1); //The players have stats once they were updated
+    return result;
 }
 
-static void destroyStatistics(MapKeyElement statistics)
+//Returns the key of two players in pairs_index, or PAIR_NOT_PACKED if one of them has no stats or too big an index
+static int packPair(const Tournament* tournament, int player1, int player2)
 {
-    free((int *)statistics);
+    int first = idTableFind(tournament->players_index, player1);
+    int second = idTableFind(tournament->players_index, player2);
+    if (first == ID_TABLE_NOT_FOUND || second == ID_TABLE_NOT_FOUND || first >= PAIR_INDEX_PLAYERS ||
+        second >= PAIR_INDEX_PLAYERS) {
+        return PAIR_NOT_PACKED;
+    }
+    int low = first < second ? first : second, high = first < second ? second : first;
+    //The pairs below high come before it, so every pair gets its own key
+    return (int)((long long)high * (high - 1) / 2) + low;
 }
 
-MapResult updateStats(Map players_stats, int player_id, int wins, int losses, int draws, int time_played)
+//The room for the pair was reserved with the game, so adding it can not fail
+static void addPair(Tournament* tournament, int game_index)
 {
-    if (mapContains(players_stats, &player_id) == false) {
-        MapResult result = addPlayerStats(players_stats, player_id);
-        if (result != MAP_SUCCESS) {
-            return result;
-        }
+    const Game *game = &tournament->games[game_index];
+    int key = packPair(tournament, game->players_slot[0], game->players_slot[1]);
+    if (key != PAIR_NOT_PACKED) {
+        int pair = idTableAdd(tournament->pairs_index, key);
+        assert(pair != ID_TABLE_NOT_FOUND);
+        tournament->pairs_games[pair] = game_index;
     }
-    int *player = (int*)mapGet(players_stats, &player_id);
-    player[WINS] += wins;
-    player[LOSSES] += losses;
-    player[DRAWS] += draws;
-    player[TIME_PLAYED] += time_played;
-    player[SCORE] += 2 * wins +  draws;
-    return MAP_SUCCESS;
 }
 
-static MapResult addPlayerStats(Map players_stats, int player_id)
+//Indexes the pairs of the games that were loaded, once their players have stats
+static bool addAllPairs(Tournament* tournament)
 {
-    int *stats = calloc(PARAMETERS, sizeof(int));
-    if (stats == NULL) {
-        return MAP_OUT_OF_MEMORY;
+    if (!idTableReserve(tournament->pairs_index, tournament->games_count)) {
+        return false;
     }
-    if (mapPut(players_stats, &player_id, stats) != MAP_SUCCESS) {
-        return MAP_OUT_OF_MEMORY; //Already checked NULL arguments, so its has to be memory failure.
+    for (int i = 0; i < tournament->games_count; i++) {
+        addPair(tournament, i);
     }
-    destroyStatistics(stats);
-    return MAP_SUCCESS;
+    return true;
 }
 
-void tournamentEnd(Tournament* tournament)
+static MapResult updateWinnerStats(Tournament* tournament, const Game* game)
 {
-    assert(tournament != NULL);
-    int winner = UNDEFINED;
-    int max_score = computeMaxScore(tournament->players_stats, &winner);
-    if (winner != UNDEFINED) {
-        tournament->winner = winner;
-        return;
-    }
-    int min_losses = computeMinLosses(tournament->players_stats, &winner, max_score);
-    if (winner != UNDEFINED) {
-        tournament->winner = winner;
-        return;
-    }
-    int max_wins = computeMaxWins(tournament->players_stats, &winner, max_score, min_losses);
-    if (winner != UNDEFINED) {
-        tournament->winner = winner;
-        return;
-    }
-    computeMinId(tournament->players_stats, &winner, max_score, min_losses, max_wins);
-    assert(winner != UNDEFINED);
-    tournament->winner = winner;
-}
-
-static int computeMaxScore(Map players_stats, int *winner)
-{
-    int maxScore=0;
-    int count=0;
-    MAP_FOREACH(int *, iter, players_stats) {
-        int* player = (int*)mapGet(players_stats, iter);
-        if(player[SCORE] > maxScore){
-            maxScore=player[SCORE];
-            *winner=*iter;
-            count=0;
+    int first_wins = game->result == FIRST_PLAYER, second_wins = game->result == SECOND_PLAYER;
+    int draws = game->result != FIRST_PLAYER && game->result != SECOND_PLAYER;
+    MapResult result = updateStats(tournament, game->players_slot[0], first_wins, second_wins, draws,
+                                   game->duration);
+    if (result != MAP_SUCCESS) {
+        return result;
+    }
+    return updateStats(tournament, game->players_slot[1], second_wins, first_wins, draws, game->duration);
+}
+
+//The score of a player, and the indexes of the stats, are not saved and are rebuilt when loading.
+void tournamentSave(const Tournament* tournament, SnapshotWriter* writer)
+{
+    assert(tournament != NULL && writer != NULL);
+    snapshotWriteInt(writer, tournament->winner);
+    snapshotWriteInt(writer, tournament->games_count);
+    GameArchiveIterator iterator;
+    gameArchiveIteratorInit(&iterator, tournament->archive, tournament->frozen ? tournament->games_count : 0, 0);
+    Game game;
+    for (int i = 0; i < tournament->games_count; i++) {
+        if (!tournament->frozen) {
+            game = tournament->games[i];
         }
-        if(player[SCORE] == maxScore){
-            count++;
+        else {
+            gameArchiveIteratorNext(&iterator, &game);
         }
-        free(iter);
+        snapshotWriteInt(writer, game.players_slot[0]);
+        snapshotWriteInt(writer, game.players_slot[1]);
+        snapshotWriteInt(writer, game.result);
+        snapshotWriteInt(writer, game.duration);
     }
-    if(count > 1){
-        *winner=UNDEFINED;
+    snapshotWriteInt(writer, tournament->players_count);
+    for (int i = 0; i < tournament->players_count; i++) {
+        const PlayerStats *statistics = &tournament->players_stats[i];
+        snapshotWriteInt(writer, statistics->player_slot);
+        snapshotWriteInt(writer, statistics->wins);
+        snapshotWriteInt(writer, statistics->losses);
+        snapshotWriteInt(writer, statistics->draws);
+        snapshotWriteInt(writer, statistics->time_played);
     }
-    return maxScore;
-    
 }
-static int computeMinLosses(Map players_stats, int *winner, int maxScore)
+
+/*
+ * Fills a new tournament with what tournamentSave wrote, and adds its stats to the player directory.
+ * The directory must already have the slots of all the players. If loading fails, the tournament and the
+ * directory are left half loaded, and should be destroyed.
+ */
+bool tournamentLoad(Tournament* tournament, SnapshotReader* reader)
 {
-    int minLosses=-1;
-    int count=0;
-    MAP_FOREACH(int *, iter, players_stats) {
-        int* player = (int*)mapGet(players_stats, iter);
-        if(maxScore != player[SCORE]){
-            free(iter);
-            continue;
+    assert(tournament != NULL && reader != NULL);
+    assert(tournament->games_count == 0 && tournament->players_count == 0);
+    tournament->winner = snapshotReadInt(reader);
+    return loadGames(tournament, reader) && loadPlayersStats(tournament, reader) && addAllPairs(tournament);
+}
+
+static bool loadGames(Tournament* tournament, SnapshotReader* reader)
+{
+    int players_count = playerDirectoryGetSize(tournament->players);
+    int games_count = snapshotReadCount(reader, GAME_SNAPSHOT_SIZE);
+    const unsigned char *record = snapshotReadBytes(reader, games_count * GAME_SNAPSHOT_SIZE);
+    if (record == NULL || !tournamentReserveGames(tournament, games_count)) {
+        return false;
+    }
+    for (int i = 0; i < games_count; i++, record += GAME_SNAPSHOT_SIZE) {
+        Game *game = &tournament->games[i];
+        for (int player = 0; player < NUM_OF_PLAYRES_PER_GAME; player++) {
+            game->players_slot[player] = snapshotDecodeInt(record + player * SNAPSHOT_INT_SIZE);
+            if (game->players_slot[player] < TOURNAMENT_DELETED_PLAYER ||
+                game->players_slot[player] >= players_count) {
+                return false;
+            }
         }
-        if(minLosses == -1){
-            minLosses = player[LOSSES];
+        int result = snapshotDecodeInt(record + 2 * SNAPSHOT_INT_SIZE);
+        if (result != FIRST_PLAYER && result != SECOND_PLAYER && result != DRAW) {
+            return false;
         }
-        if(player[LOSSES] < minLosses){
-            minLosses=player[LOSSES];
-            *winner=*iter;
-            count=0;
+        game->result = (Winner)result;
+        game->duration = snapshotDecodeInt(record + 3 * SNAPSHOT_INT_SIZE);
+        if (game->duration > tournament->longest_game) {
+            tournament->longest_game = game->duration;
         }
-        if(player[SCORE] == minLosses){
-            count++;
+        tournament->total_game_time += game->duration;
+    }
+    tournament->games_count = games_count;
+    return true;
+}
+
+static bool loadPlayersStats(Tournament* tournament, SnapshotReader* reader)
+{
+    int players_count = playerDirectoryGetSize(tournament->players);
+    int stats_count = snapshotReadCount(reader, STATS_SNAPSHOT_SIZE);
+    const unsigned char *record = snapshotReadBytes(reader, stats_count * STATS_SNAPSHOT_SIZE);
+    if (record == NULL || !idTableReserve(tournament->players_index, stats_count)) {
+        return false;
+    }
+    if (stats_count > tournament->players_max_size) {
+        PlayerStats *players_stats = arenaReallocate(tournament->arena, tournament->players_stats,
+                                                     sizeof(PlayerStats) * tournament->players_max_size,
+                                                     sizeof(PlayerStats) * stats_count);
+        if (players_stats == NULL) {
+            return false;
         }
-        free(iter);
+        tournament->players_stats = players_stats;
+        tournament->players_max_size = stats_count;
     }
-    if(count > 1){
-        *winner=UNDEFINED;
+    for (int i = 0; i < stats_count; i++, record += STATS_SNAPSHOT_SIZE) {
+        PlayerStats *statistics = &tournament->players_stats[i];
+        statistics->player_slot = snapshotDecodeInt(record);
+        if (statistics->player_slot < 0 || statistics->player_slot >= players_count ||
+            idTableAdd(tournament->players_index, statistics->player_slot) != i) {
+            return false; //A player that is not in the directory, appears twice, or no memory for the index
+        }
+        statistics->player_id = playerDirectoryGet(tournament->players, statistics->player_slot)->player_id;
+        statistics->wins = snapshotDecodeInt(record + SNAPSHOT_INT_SIZE);
+        statistics->losses = snapshotDecodeInt(record + 2 * SNAPSHOT_INT_SIZE);
+        statistics->draws = snapshotDecodeInt(record + 3 * SNAPSHOT_INT_SIZE);
+        statistics->time_played = snapshotDecodeInt(record + 4 * SNAPSHOT_INT_SIZE);
+        statistics->score = 2 * statistics->wins + statistics->draws;
+        tournament->players_count++;
+        if (!playerDirectoryAddTournament(tournament->players, statistics->player_slot, tournament) ||
+            !totalsTableAdd(tournament->totals, statistics->player_slot)) {
+            return false;
+        }
+        addToTotals(tournament, statistics->player_slot, statistics->wins, statistics->losses, statistics->draws,
+                    statistics->time_played);
     }
-    return minLosses;
+    size_t keys_size = sizeof(LeaderboardKey) * (stats_count > 0 ? stats_count : 1);
+    LeaderboardKey *keys = allocatorAllocate(tournament->allocator, keys_size);
+    if (keys == NULL) {
+        return false;
+    }
+    for (int i = 0; i < stats_count; i++) {
+        keys[i] = statsToKey(&tournament->players_stats[i]);
+    }
+    LeaderboardResult result = leaderboardBuild(tournament->leaderboard, keys, stats_count);
+    allocatorFree(tournament->allocator, keys, keys_size);
+    return result == LEADERBOARD_SUCCESS;
 }
-static int computeMaxWins(Map players_stats, int *winner, int maxScore, int minLosses)
+
+PlayerStats* tournamentGetPlayerStats(const Tournament* tournament, int player)
 {
-    int maxWins=0;
-    int count=0;
-    MAP_FOREACH(int *, iter, players_stats) {
-        int* player = (int*)mapGet(players_stats, iter);
-        if(maxScore != player[SCORE] || minLosses != player[LOSSES]){
-            free(iter);
-            continue;
+    assert(tournament != NULL);
+    if (tournament->frozen) {
+        int low = 0, high = tournament->players_count - 1;
+        while (low <= high) {
+            int middle = low + (high - low) / 2;
+            const StatsIndex *entry = &tournament->stats_by_slot[middle];
+            if (entry->player_slot == player) {
+                return &tournament->players_stats[entry->index];
+            }
+            if (entry->player_slot < player) {
+                low = middle + 1;
+            }
+            else {
+                high = middle - 1;
+            }
         }
-        if(player[WINS] > maxWins){
-            maxWins=player[WINS];
-            *winner=*iter;
-            count=0;
+        return NULL;
+    }
+    int index = idTableFind(tournament->players_index, player);
+    return index == ID_TABLE_NOT_FOUND ? NULL : &tournament->players_stats[index];
+}
+
+static LeaderboardKey statsToKey(const PlayerStats* statistics)
+{
+    LeaderboardKey key = {statistics->score, statistics->losses, statistics->wins, statistics->player_id};
+    return key;
+}
+
+//Everything that can fail is done before the player becomes visible, so a failure leaves no trace.
+static MapResult addPlayerStats(Tournament* tournament, int player, int* index)
+{
+    if (!reservePlayers(tournament, 1)) {
+        return MAP_OUT_OF_MEMORY;
+    }
+    *index = idTableAdd(tournament->players_index, player);
+    if (*index == ID_TABLE_NOT_FOUND) {
+        return MAP_OUT_OF_MEMORY;
+    }
+    assert(*index == tournament->players_count);
+    PlayerStats *statistics = &tournament->players_stats[tournament->players_count++];
+    memset(statistics, 0, sizeof(*statistics));
+    statistics->player_slot = player;
+    statistics->player_id = playerDirectoryGet(tournament->players, player)->player_id;
+    LeaderboardKey key = statsToKey(statistics);
+    leaderboardInsert(tournament->leaderboard, &key);
+    return MAP_SUCCESS;
+}
+
+//Makes room for the stats, index entries and leaderboard nodes of count more players
+static bool reservePlayers(Tournament* tournament, int count)
+{
+    int size = tournament->players_count + count;
+    if (size > tournament->players_max_size) {
+        int new_size = tournament->players_max_size;
+        while (new_size < size) {
+            new_size *= EXPAND_FACTOR;
         }
-        if(player[WINS] == maxWins){
-            count++;
+        PlayerStats *players_stats = arenaReallocate(tournament->arena, tournament->players_stats,
+                                                     sizeof(PlayerStats) * tournament->players_max_size,
+                                                     sizeof(PlayerStats) * new_size);
+        if (players_stats == NULL) {
+            return false;
         }
-        free(iter);
+        tournament->players_stats = players_stats;
+        tournament->players_max_size = new_size;
     }
-    if(count > 1){
-        *winner=UNDEFINED;
+    return leaderboardReserve(tournament->leaderboard, size) == LEADERBOARD_SUCCESS &&
+           idTableReserve(tournament->players_index, size);
+}
+
+//The player has a row in the totals of the shard from when it was first added to the tournament
+static void addToTotals(Tournament* tournament, int player, int wins, int losses, int draws, int time_played)
+{
+    playerDirectoryUpdateStats(tournament->players, player, wins, losses, draws, time_played);
+    totalsTableUpdate(tournament->totals, player, wins, losses, draws, time_played);
+}
+
+void tournamentEnd(Tournament* tournament)
+{
+    assert(tournament != NULL);
+    leaderboardGetTop(tournament->leaderboard, 1, &tournament->winner);
+    assert(tournament->winner != TOURNAMENT_NOT_ENDED);
+}
+
+/*
+ * Moves an ended tournament into a new arena that fits it exactly: the games encoded into an archive, the stats
+ * without room to grow, the players by rank in place of their leaderboard, and the stats sorted by slot in place of
+ * their hash index, which only a tournament that can still change needs. The tournament stays where it is, so the
+ * player directory still points at it.
+ * Returns false, leaving the tournament as it was, if an allocation failed.
+ */
+bool tournamentFreeze(Tournament* tournament)
+{
+    assert(tournament != NULL && tournament->winner != TOURNAMENT_NOT_ENDED);
+    if (tournament->frozen) {
+        return true;
+    }
+    Arena arena = arenaCreate(tournament->allocator);
+    if (arena == NULL) {
+        return false;
+    }
+    size_t archive_size = gameArchiveGetSize(tournament->games, tournament->games_count);
+    unsigned char *archive = arenaAllocate(arena, archive_size);
+    PlayerStats *players_stats = arenaAllocate(arena, sizeof(PlayerStats) * tournament->players_count);
+    int *leaders = arenaAllocate(arena, sizeof(int) * tournament->players_count);
+    StatsIndex *stats_by_slot = arenaAllocate(arena, sizeof(StatsIndex) * tournament->players_count);
+    if (archive == NULL || players_stats == NULL || leaders == NULL || stats_by_slot == NULL) {
+        arenaDestroy(arena);
+        return false;
     }
-    return maxWins;
+    gameArchiveWrite(tournament->games, tournament->games_count, archive);
+    memcpy(players_stats, tournament->players_stats, sizeof(PlayerStats) * tournament->players_count);
+    leaderboardGetTop(tournament->leaderboard, tournament->players_count, leaders); //Every player has a rank
+    //The stats keep their order, in which they are saved, and are found by slot through their own sorted index
+    for (int i = 0; i < tournament->players_count; i++) {
+        stats_by_slot[i].player_slot = players_stats[i].player_slot;
+        stats_by_slot[i].index = i;
+    }
+    qsort(stats_by_slot, tournament->players_count, sizeof(StatsIndex), compareStatsIndexes);
+    arenaDestroy(tournament->arena);
+    tournament->arena = arena;
+    tournament->games = NULL;
+    tournament->games_max_size = 0;
+    tournament->archive = archive;
+    tournament->archive_size = archive_size;
+    tournament->players_stats = players_stats;
+    tournament->players_max_size = tournament->players_count;
+    tournament->players_index = NULL;
+    tournament->pairs_index = NULL;
+    tournament->pairs_games = NULL;
+    tournament->pairs_max_size = 0;
+    tournament->leaderboard = NULL;
+    tournament->leaders = leaders;
+    tournament->stats_by_slot = stats_by_slot;
+    tournament->frozen = true;
+    return true;
 }
-static void computeMinId(Map players_stats, int *winner,int maxScore,int minLosses,int maxWins)
+
+static int compareStatsIndexes(const void* first, const void* second)
 {
-    MAP_FOREACH(int *, iter, players_stats) {
-        int* player = (int*)mapGet(players_stats, iter);
-        if(maxScore == player[SCORE] && minLosses == player[LOSSES] && maxWins == player[WINS]){
-            *winner=*iter;
-            free(iter);
-            return;//Map keys are sorted from min to max, so when we find the first its the minimum.
-        }
-        free(iter);
+    int first_slot = ((const StatsIndex*)first)->player_slot;
+    int second_slot = ((const StatsIndex*)second)->player_slot;
+    return (first_slot > second_slot) - (first_slot < second_slot);
+}
+
+//The stats, the leaders, the index of the stats and then the archive, which are all that a frozen tournament keeps
+//in its arena
+size_t tournamentGetSpillSize(const Tournament* tournament)
+{
+    assert(tournament != NULL && tournament->frozen);
+    return (sizeof(PlayerStats) + sizeof(int) + sizeof(StatsIndex)) * tournament->players_count +
+           tournament->archive_size;
+}
+
+void tournamentWriteSpill(const Tournament* tournament, unsigned char* data)
+{
+    assert(tournament != NULL && tournament->frozen && !tournament->spilled && data != NULL);
+    memcpy(data, tournament->players_stats, sizeof(PlayerStats) * tournament->players_count);
+    data += sizeof(PlayerStats) * tournament->players_count;
+    memcpy(data, tournament->leaders, sizeof(int) * tournament->players_count);
+    data += sizeof(int) * tournament->players_count;
+    memcpy(data, tournament->stats_by_slot, sizeof(StatsIndex) * tournament->players_count);
+    data += sizeof(StatsIndex) * tournament->players_count;
+    memcpy(data, tournament->archive, tournament->archive_size);
+}
+
+/*
+ * Takes the arena out of a frozen tournament whose data was written to the spill file at offset. What is left is
+ * what the exports read: the winner, the counts, the aggregates of the games and the location.
+ */
+Arena tournamentSpill(Tournament* tournament, long long offset)
+{
+    assert(tournament != NULL && tournament->frozen && !tournament->spilled && offset >= 0);
+    Arena arena = tournament->arena;
+    tournament->arena = NULL;
+    tournament->players_stats = NULL;
+    tournament->leaders = NULL;
+    tournament->stats_by_slot = NULL;
+    tournament->archive = NULL;
+    tournament->spill_offset = offset;
+    tournament->spilled = true;
+    return arena;
+}
+
+//Reads back what tournamentWriteSpill wrote. Returns false, leaving the tournament spilled, if allocating failed.
+bool tournamentReload(Tournament* tournament, const unsigned char* data)
+{
+    assert(tournament != NULL && tournament->spilled && data != NULL);
+    Arena arena = arenaCreate(tournament->allocator);
+    if (arena == NULL) {
+        return false;
+    }
+    PlayerStats *players_stats = arenaAllocate(arena, sizeof(PlayerStats) * tournament->players_count);
+    int *leaders = arenaAllocate(arena, sizeof(int) * tournament->players_count);
+    StatsIndex *stats_by_slot = arenaAllocate(arena, sizeof(StatsIndex) * tournament->players_count);
+    unsigned char *archive = arenaAllocate(arena, tournament->archive_size);
+    if (players_stats == NULL || leaders == NULL || stats_by_slot == NULL || archive == NULL) {
+        arenaDestroy(arena);
+        return false;
     }
-    assert(*winner != UNDEFINED);//We should'nt get here.
-}
\ No newline at end of file
+    memcpy(players_stats, data, sizeof(PlayerStats) * tournament->players_count);
+    data += sizeof(PlayerStats) * tournament->players_count;
+    memcpy(leaders, data, sizeof(int) * tournament->players_count);
+    data += sizeof(int) * tournament->players_count;
+    memcpy(stats_by_slot, data, sizeof(StatsIndex) * tournament->players_count);
+    data += sizeof(StatsIndex) * tournament->players_count;
+    memcpy(archive, data, tournament->archive_size);
+    tournament->arena = arena;
+    tournament->players_stats = players_stats;
+    tournament->players_max_size = tournament->players_count;
+    tournament->leaders = leaders;
+    tournament->stats_by_slot = stats_by_slot;
+    tournament->archive = archive;
+    tournament->spilled = false;
+    return true;
+}
+
+//Reads the stats of one player from what tournamentWriteSpill wrote, which does not have to be aligned
+void tournamentReadSpilledStats(const Tournament* tournament, const unsigned char* data, int index,
+                                PlayerStats* stats)
+{
+    assert(tournament != NULL && tournament->spilled && data != NULL);
+    assert(index >= 0 && index < tournament->players_count);
+    memcpy(stats, data + sizeof(PlayerStats) * index, sizeof(PlayerStats));
+}
+
+size_t tournamentGetArchiveSize(const Tournament* tournament)
+{
+    assert(tournament != NULL);
+    return tournament->frozen ? tournament->archive_size : gameArchiveGetSize(tournament->games,
+                                                                              tournament->games_count);
+}
+
+//Writes the archive of the games, as a frozen tournament keeps it, to memory of tournamentGetArchiveSize bytes
+void tournamentWriteArchive(const Tournament* tournament, unsigned char* archive)
+{
+    assert(tournament != NULL && archive != NULL);
+    if (tournament->frozen) {
+        memcpy(archive, tournament->archive, tournament->archive_size);
+    }
+    else {
+        gameArchiveWrite(tournament->games, tournament->games_count, archive);
+    }
+}
+
+int tournamentGetLeaders(const Tournament* tournament, int k, int* leaders)
+{
+    assert(tournament != NULL);
+    if (tournament->frozen) {
+        int count = k < tournament->players_count ? k : tournament->players_count;
+        count = count > 0 ? count : 0;
+        memcpy(leaders, tournament->leaders, sizeof(int) * count);
+        return count;
+    }
+    return leaderboardGetTop(tournament->leaderboard, k, leaders);
+}
@@ -2,34 +2,96 @@
 #define _TOURNAMENT_H
 
 #include "map.h"
+#include "game.h"
+#include "leaderboard.h"
+#include "locationTable.h"
+#include "idTable.h"
+#include "playerDirectory.h"
+#include "snapshot.h"
+#include "arena.h"
+#include "gameArchive.h"
+#include "totalsTable.h"
 
 #define TOURNAMENT_DELETED_PLAYER -1
 #define TOURNAMENT_NOT_ENDED -1
-#define WINS 0
-#define LOSSES 1
-#define DRAWS 2
-#define TIME_PLAYED 3
-#define SCORE 4
+
+typedef struct PlayerStats {
+    int player_slot;
+    int player_id;
+    int wins;
+    int losses;
+    int draws;
+    int time_played;
+    int score;
+} PlayerStats;
+
+//Where the stats of a player are in a frozen tournament
+typedef struct StatsIndex {
+    int player_slot;
+    int index;
+} StatsIndex;
 
 typedef struct Tournament {
-    Map games;
-    char *location;
+    const ChessAllocator *allocator; //Of the tournament itself and its arena
+    Arena arena; //Holds the games, the stats and their indexes
+    Game *games; //In the order they were added. NULL once frozen.
+    int games_count;
+    int games_max_size;
+    int longest_game;
+    int total_game_time; //Kept with the games, so the statistics do not go over them
+    Location location;
     int winner;
     int max_games_per_player;
-    int next_game_id;
-    Map players_stats;
+    PlayerStats *players_stats; //Dense, players_index maps a player slot to its index
+    int players_count;
+    int players_max_size;
+    IdTable players_index; //NULL once frozen
+    IdTable pairs_index; //The pairs of players that played, by the packed indexes of their stats. NULL once frozen.
+    int *pairs_games; //The last game of each pair in pairs_index
+    int pairs_max_size;
+    Leaderboard leaderboard; //NULL once frozen
+    int *leaders; //Once frozen, the ids of all the players by rank
+    StatsIndex *stats_by_slot; //Once frozen, in place of players_index, sorted by slot
+    unsigned char *archive; //Once frozen, the games encoded by gameArchiveWrite
+    size_t archive_size;
+    bool frozen;
+    bool spilled; //The stats, leaders, their index and archive of a frozen tournament are only in the spill file
+    long long spill_offset; //Of the data in the spill file, -1 if it was never spilled
+    struct Tournament *lru_previous; //Kept by the chess system for the frozen tournaments in memory
+    struct Tournament *lru_next;
+    size_t lru_bytes; //The footprint of the arena, counted by the shard while the tournament is in the lru
+    PlayerDirectory players;
+    TotalsTable totals; //Of the tournament's shard, updated along with the totals in the player directory
 } Tournament;
 
-Tournament* tournamentCreate(copyMapKeyElements copyMapKeyElements, freeMapKeyElements freeMapKeyElements, 
-                             compareMapKeyElements compareMapKeyElements,const char *location,int max_games_per_player);  
+Tournament* tournamentCreate(Location location,int max_games_per_player, PlayerDirectory players,
+                             TotalsTable totals, const ChessAllocator* allocator);
 MapDataElement tournamentCopy(MapDataElement tournament);
 bool checkAlreadyPlayed(const Tournament* tournament, int player1, int player2);
 bool checkExceededGames(const Tournament* tournament, int player);
 void tournamentDestroy(MapDataElement tournament);
+Arena tournamentDetach(Tournament* tournament);
+void tournamentGetMemoryUsage(const Tournament* tournament, size_t* bytes, size_t* objects);
 bool checkLocation(const char* tournament_location);
-MapResult updateStats(Map players_stats, int player_id, int wins, int losses, int draws, int time_played);
+bool tournamentReserveGames(Tournament* tournament, int count);
+MapResult tournamentAddGame(Tournament* tournament, int first_player, int second_player, Winner winner,
+                            int play_time);
+void tournamentSave(const Tournament* tournament, SnapshotWriter* writer);
+bool tournamentLoad(Tournament* tournament, SnapshotReader* reader);
+MapResult updateStats(Tournament* tournament, int player, int wins, int losses, int draws, int time_played);
 void tournamentEnd(Tournament* tournament);
-bool tournamentRemovePlayer(Tournament* tournament,int player_id);
+bool tournamentFreeze(Tournament* tournament);
+size_t tournamentGetSpillSize(const Tournament* tournament);
+void tournamentWriteSpill(const Tournament* tournament, unsigned char* data);
+Arena tournamentSpill(Tournament* tournament, long long offset);
+bool tournamentReload(Tournament* tournament, const unsigned char* data);
+void tournamentReadSpilledStats(const Tournament* tournament, const unsigned char* data, int index,
+                                PlayerStats* stats);
+size_t tournamentGetArchiveSize(const Tournament* tournament);
+void tournamentWriteArchive(const Tournament* tournament, unsigned char* archive);
+bool tournamentRemovePlayer(Tournament* tournament,int player);
+int tournamentGetLeaders(const Tournament* tournament, int k, int* leaders);
+PlayerStats* tournamentGetPlayerStats(const Tournament* tournament, int player);
 
 
 